@@ -0,0 +1,283 @@
+#include <hydroc/helper.h>
+#include <hydroc/hydro_forces.h>
+#include <hydroc/hydro_solver.h>
+
+#include <chrono/physics/ChBodyEasy.h>
+#include <chrono/physics/ChLinkMate.h>
+#include <chrono/physics/ChLinkTSDA.h>
+#include <chrono/physics/ChSystemNSC.h>
+#include <chrono/solver/ChDirectSolverLS.h>
+#include <chrono/solver/ChIterativeSolverLS.h>
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>      // std::chrono::high_resolution_clock::now
+#include <filesystem>  // C++17
+#include <iomanip>     // std::setw
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compares Chrono's GMRES (diagonal preconditioner) with ChSolverHydroGMRES (hydro block
+// preconditioner), and Chrono's SPARSE_QR (as in the F3OF demos) with ChSolverHydroSparseQR and
+// the locked pattern (TestHydro::EnableSymbolicReuse), on the RM3 regular wave and F3OF DT1, DT2
+// and DT3 set ups, without visualization.
+//
+// usage: ./demo_solver_benchmark [DATADIR] [num_steps]
+
+using namespace chrono;
+using std::filesystem::path;
+
+enum class BenchmarkSolver { gmres = 0, hydro_gmres = 1, sparse_qr = 2, hydro_sparse_qr = 3 };
+
+static const char* SolverName(BenchmarkSolver solver) {
+    switch (solver) {
+        case BenchmarkSolver::gmres:
+            return "GMRES diagonal";
+        case BenchmarkSolver::hydro_gmres:
+            return "GMRES hydro";
+        case BenchmarkSolver::sparse_qr:
+            return "QR";
+        case BenchmarkSolver::hydro_sparse_qr:
+            return "QR locked";
+    }
+    return "";
+}
+
+struct BenchmarkResult {
+    double mean_iterations = 0.0;
+    int max_iterations     = 0;
+    double seconds         = 0.0;
+};
+
+// same set up as demo_rm3_reg_waves
+void BuildRM3(ChSystem& system,
+              std::vector<std::shared_ptr<ChBody>>& bodies,
+              std::string& h5fname,
+              std::shared_ptr<WaveBase>& waves) {
+    path DATADIR(hydroc::getDataDir());
+    h5fname          = (DATADIR / "rm3" / "hydroData" / "rm3.h5").lexically_normal().generic_string();
+    auto b1Meshfname = (DATADIR / "rm3" / "geometry" / "float_cog.obj").lexically_normal().generic_string();
+    auto b2Meshfname = (DATADIR / "rm3" / "geometry" / "plate_cog.obj").lexically_normal().generic_string();
+
+    auto float_body1 = chrono_types::make_shared<ChBodyEasyMesh>(b1Meshfname, 0, false, false, false);
+    system.Add(float_body1);
+    float_body1->SetNameString("body1");
+    float_body1->SetPos(ChVector<>(0, 0, -0.72));
+    float_body1->SetMass(725834);
+    float_body1->SetInertiaXX(ChVector<>(20907301.0, 21306090.66, 37085481.11));
+
+    auto plate_body2 = chrono_types::make_shared<ChBodyEasyMesh>(b2Meshfname, 0, false, false, false);
+    system.Add(plate_body2);
+    plate_body2->SetNameString("body2");
+    plate_body2->SetPos(ChVector<>(0, 0, -21.29));
+    plate_body2->SetMass(886691);
+    plate_body2->SetInertiaXX(ChVector<>(94419614.57, 94407091.24, 28542224.82));
+
+    auto prismatic = chrono_types::make_shared<ChLinkLockPrismatic>();
+    prismatic->Initialize(float_body1, plate_body2, false, ChCoordsys<>(ChVector<>(0, 0, -0.72)),
+                          ChCoordsys<>(ChVector<>(0, 0, -21.29)));
+    system.AddLink(prismatic);
+
+    auto prismatic_pto = chrono_types::make_shared<ChLinkTSDA>();
+    prismatic_pto->Initialize(float_body1, plate_body2, false, ChVector<>(0, 0, -0.72), ChVector<>(0, 0, -21.29));
+    prismatic_pto->SetDampingCoefficient(0.0);
+    system.AddLink(prismatic_pto);
+
+    auto reg_waves                    = std::make_shared<RegularWave>(2);
+    reg_waves->regular_wave_amplitude = 1.0;
+    reg_waves->regular_wave_omega     = 2.10;
+    waves                             = reg_waves;
+
+    bodies = {float_body1, plate_body2};
+}
+
+// same set ups as demo_F3OF_DT1 (surge decay, flaps locked), demo_F3OF_DT2 (pitch decay, flaps
+// locked) and demo_F3OF_DT3 (flap decay, base fixed), no waves
+void BuildF3OF(ChSystem& system,
+               int decay_test,
+               std::vector<std::shared_ptr<ChBody>>& bodies,
+               std::string& h5fname,
+               std::shared_ptr<WaveBase>& waves) {
+    path DATADIR(hydroc::getDataDir());
+    h5fname            = (DATADIR / "f3of" / "hydroData" / "f3of.h5").lexically_normal().generic_string();
+    auto base_meshfame = (DATADIR / "f3of" / "geometry" / "base.obj").lexically_normal().generic_string();
+    auto flap_meshfame = (DATADIR / "f3of" / "geometry" / "flap.obj").lexically_normal().generic_string();
+
+    auto base = chrono_types::make_shared<ChBodyEasyMesh>(base_meshfame, 0, false, false, false);
+    system.Add(base);
+    base->SetNameString("body1");
+    base->SetMass(1089825.0);
+    base->SetInertiaXX(ChVector<>(100000000.0, 76300000.0, 100000000.0));
+
+    auto flapFore = chrono_types::make_shared<ChBodyEasyMesh>(flap_meshfame, 0, false, false, false);
+    system.Add(flapFore);
+    flapFore->SetNameString("body2");
+    flapFore->SetMass(179250.0);
+    flapFore->SetInertiaXX(ChVector<>(100000000.0, 1300000.0, 100000000.0));
+
+    auto flapAft = chrono_types::make_shared<ChBodyEasyMesh>(flap_meshfame, 0, false, false, false);
+    system.Add(flapAft);
+    flapAft->SetNameString("body3");
+    flapAft->SetMass(179250.0);
+    flapAft->SetInertiaXX(ChVector<>(100000000.0, 1300000.0, 100000000.0));
+
+    auto ground = chrono_types::make_shared<ChBody>();
+    system.AddBody(ground);
+    ground->SetBodyFixed(true);
+    ground->SetCollide(false);
+
+    auto revoluteFore          = chrono_types::make_shared<ChLinkLockRevolute>();
+    auto revoluteAft           = chrono_types::make_shared<ChLinkLockRevolute>();
+    ChQuaternion<> revoluteRot = Q_from_AngX(CH_C_PI / 2.0);
+    if (decay_test == 1) {
+        base->SetPos(ChVector<>(5.0, 0.0, -9.0));
+        flapFore->SetPos(ChVector<>(5.0 + -12.5, 0.0, -9.0 + 3.5));
+        flapAft->SetPos(ChVector<>(5.0 + 12.5, 0.0, -9.0 + 3.5));
+
+        revoluteFore->Initialize(base, flapFore, ChCoordsys<>(ChVector<>(5.0 - 12.5, 0.0, -9.0), revoluteRot));
+        system.AddLink(revoluteFore);
+        revoluteAft->Initialize(base, flapAft, ChCoordsys<>(ChVector<>(5.0 + 12.5, 0.0, -9.0), revoluteRot));
+        system.AddLink(revoluteAft);
+        revoluteFore->Lock(true);
+        revoluteAft->Lock(true);
+
+        ground->SetPos(ChVector<>(0, 0, -9.0));
+        auto prismatic = chrono_types::make_shared<ChLinkLockPrismatic>();
+        prismatic->Initialize(ground, base, ChCoordsys<>(ChVector<>(0.0, 0.0, -9.0), Q_from_AngY(CH_C_PI_2)));
+        system.AddLink(prismatic);
+
+        auto prismatic_pto = chrono_types::make_shared<ChLinkTSDA>();
+        prismatic_pto->Initialize(ground, base, true, ChVector<>(0.0, 0.0, 0.0), ChVector<>(0.0, 0.0, 0.0));
+        prismatic_pto->SetSpringCoefficient(1e5);
+        prismatic_pto->SetRestLength(0.0);
+        system.AddLink(prismatic_pto);
+    } else if (decay_test == 2) {
+        double ang_rad = CH_C_PI / 18.0;
+        base->SetPos(ChVector<>(0.0, 0.0, -9.0));
+        base->SetRot(Q_from_AngAxis(ang_rad, VECT_Y));
+        flapFore->SetRot(Q_from_AngAxis(ang_rad, VECT_Y));
+        flapAft->SetRot(Q_from_AngAxis(ang_rad, VECT_Y));
+        flapFore->SetPos(ChVector<>(-12.5 * std::cos(ang_rad) + 3.5 * std::sin(ang_rad), 0.0,
+                                    -9.0 + 12.5 * std::sin(ang_rad) + 3.5 * std::cos(ang_rad)));
+        flapAft->SetPos(ChVector<>(12.5 * std::cos(ang_rad) + 3.5 * std::sin(ang_rad), 0.0,
+                                   -9.0 - 12.5 * std::sin(ang_rad) + 3.5 * std::cos(ang_rad)));
+
+        revoluteFore->Initialize(
+            base, flapFore,
+            ChCoordsys<>(ChVector<>(-12.5 * std::cos(ang_rad), 0.0, -9.0 + 12.5 * std::sin(ang_rad)), revoluteRot));
+        system.AddLink(revoluteFore);
+        revoluteAft->Initialize(
+            base, flapAft,
+            ChCoordsys<>(ChVector<>(12.5 * std::cos(ang_rad), 0.0, -9.0 - 12.5 * std::sin(ang_rad)), revoluteRot));
+        system.AddLink(revoluteAft);
+        revoluteFore->Lock(true);
+        revoluteAft->Lock(true);
+
+        ground->SetPos(ChVector<>(0, 0, -9.0));
+        auto base_rev = chrono_types::make_shared<ChLinkLockRevolute>();
+        base_rev->Initialize(base, ground, ChCoordsys<>(ChVector<>(0.0, 0.0, -9.0), revoluteRot));
+        system.AddLink(base_rev);
+    } else {
+        base->SetPos(ChVector<>(0.0, 0.0, -9.0));
+        double fore_ang_rad = CH_C_PI / 18.0;
+        flapFore->SetRot(Q_from_AngAxis(fore_ang_rad, VECT_Y));
+        flapFore->SetPos(ChVector<>(-12.5 + 3.5 * std::cos(CH_C_PI / 2.0 - fore_ang_rad), 0.0,
+                                    -9.0 + 3.5 * std::sin(CH_C_PI / 2.0 - fore_ang_rad)));
+        flapAft->SetPos(ChVector<>(12.5, 0.0, -9.0 + 3.5));
+
+        revoluteFore->Initialize(base, flapFore, ChCoordsys<>(ChVector<>(-12.5, 0.0, -9.0), revoluteRot));
+        system.AddLink(revoluteFore);
+        revoluteAft->Initialize(base, flapAft, ChCoordsys<>(ChVector<>(12.5, 0.0, -9.0), revoluteRot));
+        system.AddLink(revoluteAft);
+
+        // base welded to the ground (not SetBodyFixed, it keeps its variables in the system matrix)
+        ground->SetPos(ChVector<>(0, 0, -12.0));
+        auto anchor = chrono_types::make_shared<ChLinkMateGeneric>();
+        anchor->Initialize(base, ground, false, ChFrame<>(base->GetPos()), ChFrame<>(base->GetPos()));
+        system.Add(anchor);
+        anchor->SetConstrainedCoords(true, true, true, true, true, true);
+    }
+
+    waves = std::make_shared<NoWave>(3);
+
+    bodies = {base, flapFore, flapAft};
+}
+
+// model: "rm3", "f3of_dt1", "f3of_dt2" or "f3of_dt3"
+BenchmarkResult Run(const std::string& model, BenchmarkSolver solver_type, int num_steps) {
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+    double timestep = model == "rm3" ? 0.01 : 0.02;
+    system.SetTimestepperType(ChTimestepper::Type::HHT);
+    system.SetStep(timestep);
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    std::string h5fname;
+    std::shared_ptr<WaveBase> waves;
+    if (model == "rm3") {
+        BuildRM3(system, bodies, h5fname, waves);
+    } else {
+        BuildF3OF(system, model.back() - '0', bodies, h5fname, waves);
+    }
+    TestHydro hydro_forces(bodies, h5fname, waves);
+
+    std::shared_ptr<ChSolver> solver;
+    if (solver_type == BenchmarkSolver::gmres || solver_type == BenchmarkSolver::hydro_gmres) {
+        std::shared_ptr<ChIterativeSolverLS> iterative_solver;
+        if (solver_type == BenchmarkSolver::hydro_gmres) {
+            iterative_solver = chrono_types::make_shared<ChSolverHydroGMRES>(bodies);
+        } else {
+            iterative_solver = chrono_types::make_shared<ChSolverGMRES>();
+        }
+        iterative_solver->SetMaxIterations(300);
+        solver = iterative_solver;
+        system.SetSolver(solver);
+    } else if (solver_type == BenchmarkSolver::sparse_qr) {
+        // plain Chrono solver, pattern rebuilt and fully refactorized every step
+        system.SetSolverType(ChSolver::Type::SPARSE_QR);
+        solver = system.GetSolver();
+    } else {
+        // no contacts in these set ups: lock the pattern, the symbolic factorization is done once
+        solver = chrono_types::make_shared<ChSolverHydroSparseQR>();
+        system.SetSolver(solver);
+        hydro_forces.EnableSymbolicReuse();
+    }
+
+    BenchmarkResult result;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < num_steps; step++) {
+        system.DoStepDynamics(timestep);
+        int iterations = solver->GetIterations();
+        result.mean_iterations += iterations;
+        result.max_iterations = std::max(result.max_iterations, iterations);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    result.mean_iterations /= num_steps;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    GetLog() << "Chrono version: " << CHRONO_VERSION << "\n\n";
+
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+    int num_steps = argc > 2 ? std::stoi(argv[2]) : 2000;
+
+    std::cout << std::setw(10) << "model" << std::setw(16) << "solver" << std::setw(12) << "mean iter"
+              << std::setw(12) << "max iter" << std::setw(12) << "time [s]" << std::endl;
+    for (const std::string model : {"rm3", "f3of_dt1", "f3of_dt2", "f3of_dt3"}) {
+        for (BenchmarkSolver solver : {BenchmarkSolver::gmres, BenchmarkSolver::hydro_gmres, BenchmarkSolver::sparse_qr,
+                                       BenchmarkSolver::hydro_sparse_qr}) {
+            BenchmarkResult result = Run(model, solver, num_steps);
+            std::cout << std::setw(10) << model << std::setw(16) << SolverName(solver) << std::setw(12)
+                      << result.mean_iterations << std::setw(12) << result.max_iterations << std::setw(12)
+                      << result.seconds << std::endl;
+        }
+    }
+    return 0;
+}
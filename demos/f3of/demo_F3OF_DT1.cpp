@@ -1,6 +1,7 @@
 #include <hydroc/gui/guihelper.h>
 #include <hydroc/helper.h>
 #include <hydroc/hydro_forces.h>
+#include <hydroc/hydro_solver.h>
 
 #include <chrono/core/ChRealtimeStep.h>
 #include <chrono/physics/ChLinkMate.h>
@@ -44,7 +45,8 @@ int main(int argc, char* argv[]) {
 
     system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
     double timestep = 0.02;
-    system.SetSolverType(ChSolver::Type::SPARSE_QR);
+    // sparse QR keeping its symbolic factorization, see EnableSymbolicReuse below
+    system.SetSolver(chrono_types::make_shared<ChSolverHydroSparseQR>());
     system.SetSolverMaxIterations(300);  // the higher, the easier to keep the constraints satisfied.
     system.SetStep(timestep);
     ChRealtimeStepTimer realtime_timer;
@@ -167,6 +169,8 @@ int main(int argc, char* argv[]) {
     bodies.push_back(flapFore);
     bodies.push_back(flapAft);
     TestHydro hydroforces(bodies, h5fname, default_dont_add_waves);
+    // no contacts and no links added from here on: the system matrix keeps its pattern
+    hydroforces.EnableSymbolicReuse();
 
     // for profiling
     auto start = std::chrono::high_resolution_clock::now();
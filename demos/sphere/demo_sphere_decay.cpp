@@ -1,6 +1,7 @@
 #include <hydroc/gui/guihelper.h>
 #include <hydroc/helper.h>
 #include <hydroc/hydro_forces.h>
+#include <hydroc/natural_modes.h>
 
 #include <chrono/core/ChRealtimeStep.h>
 
@@ -100,6 +101,13 @@ int main(int argc, char* argv[]) {
     TestHydro hydro_forces(bodies, h5fname);
     hydro_forces.AddWaves(default_dont_add_waves);
 
+    // what the decay test should show, from the linear model
+    for (const NaturalMode& mode : hydro_forces.ComputeNaturalModes()) {
+        if (mode.dof == 2) {
+            std::cout << "linear heave natural period " << mode.period << " s, damping ratio " << mode.damping_ratio
+                      << std::endl;
+        }
+    }
 
     // for profilingvisualizationOn = false;
     auto start = std::chrono::high_resolution_clock::now();
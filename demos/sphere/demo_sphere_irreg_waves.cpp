@@ -107,14 +107,17 @@ int main(int argc, char* argv[]) {
     system.AddLink(spring_1);
 
     auto my_hydro_inputs = std::make_shared<IrregularWave>();
-    my_hydro_inputs->wave_height         = 2.0;
-    my_hydro_inputs->wave_period         = 12.0;
-    my_hydro_inputs->simulation_duration = simulationDuration;
-    my_hydro_inputs->simulation_dt       = timestep;
-    my_hydro_inputs->ramp_duration       = 60.0;
+    my_hydro_inputs->wave_height          = 2.0;
+    my_hydro_inputs->wave_period          = 12.0;
+    my_hydro_inputs->simulation_duration  = simulationDuration;
+    my_hydro_inputs->simulation_dt        = timestep;
+    my_hydro_inputs->ramp_duration        = 60.0;
+    my_hydro_inputs->spectrum_output_file = "spectral_densities.txt";
+    my_hydro_inputs->eta_output_file      = "eta.txt";
     // my_hydro_inputs->ramp_duration = 0.0;
     // my_hydro_inputs->SetSpectrumFrequencies(0.001, 1.0, 1000);
-    // TODO add option for PiersonMoskowitzSpectrumHz or other spectrum, have a default, do PM for now
+    // Pierson-Moskowitz from wave_height and wave_period by default, other sea states (wave_spectrum.h):
+    // my_hydro_inputs->spectrum = std::make_shared<JonswapSpectrum>(2.0, 12.0, 3.3);
 
     std::vector<std::shared_ptr<ChBody>> bodies;
     bodies.push_back(sphereBody);
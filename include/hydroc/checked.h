@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+/**@brief Index checking policy for the hydro force accessors
+ *
+ * The velocity history, RIRF and force accessors sit in the innermost loops of the
+ * force computations. In regular builds HYDROC_CHECK_INDEX compiles to nothing and
+ * the accessors reduce to plain indexed loads.
+ *
+ * Configure with HYDROCHRONO_ENABLE_CHECKED=ON (defines HYDROCHRONO_CHECKED) to
+ * validate every index; an invalid one throws std::out_of_range naming the accessor
+ * and the failed condition instead of silently returning 0.
+ */
+#ifdef HYDROCHRONO_CHECKED
+    #define HYDROC_CHECK_INDEX(cond, where)                                                      \
+        do {                                                                                     \
+            if (!(cond)) {                                                                       \
+                throw std::out_of_range(std::string(where) + ": index check failed (" #cond ")"); \
+            }                                                                                    \
+        } while (0)
+#else
+    #define HYDROC_CHECK_INDEX(cond, where) ((void)0)
+#endif
@@ -12,6 +12,11 @@ using namespace chrono;
 //using namespace chrono::fea;
 
 // =============================================================================
+// ChLoadAddedMass adds the infinite frequency added mass of the hydro bodies as a
+// 6N x 6N block. Chrono scatters the block into the system matrix at the bodies'
+// variable offsets, so its cost does not depend on the rest of the system.
+// The block, its pattern and (for a fixed step size) its values are constant, see
+// HasFixedSparsityPattern.
 class ChLoadAddedMass : public chrono::ChLoadCustomMultiple {
 public:
     /// <summary>
@@ -45,6 +50,21 @@ public:
 		ChMatrixRef mM          ///< result -dQ/da
 	) override;
 
+	/// The added mass is constant: create and compute the jacobians on the first update only, then keep them.
+	/// ComputeQ is empty, so the state gathering of the default Update is skipped as well.
+	virtual void Update(double time) override;
+
+	/// K and R are zero, KRM = Mfactor * M. Only rewritten when Mfactor changes (it is constant for a fixed
+	/// step size), so the assembled values stay identical between steps for solvers that reuse factorizations.
+	virtual void KRMmatricesLoad(double Kfactor, double Rfactor, double Mfactor) override;
+
+	/// The contribution to the system matrix is the same 6N x 6N block at the same offsets every step.
+	bool HasFixedSparsityPattern() const { return true; }
+
+	/// Zero the added mass rows and columns of the inactive dofs (6N, see TestHydro::SetActiveDofs). The pattern
+	/// of the block does not change, the jacobians are recomputed on the next update.
+	void SetActiveDofs(const std::vector<char>& dof_active);
+
 	/// Just for efficiency, override the default LoadIntLoadResidual_Mv, because we can do this in a simplified way.
 	virtual void LoadIntLoadResidual_Mv(ChVectorDynamic<>& R,           ///< result: the R residual, R += c*M*w
 		const ChVectorDynamic<>& w,     ///< the w vector
@@ -52,7 +72,15 @@ public:
 
 private:
 	ChSystem* system;
-	ChMatrixDynamic<double> infinite_added_mass;       ///< added mass at infinite frequency in global coordinates
-	ChMatrixDynamic<double> infinite_added_mass_system;      ///< added mass at infinite frequency in global coordinates (system matrix)
+	ChMatrixDynamic<double> infinite_added_mass;       ///< added mass at infinite frequency in global coordinates (6N x 6N)
+	std::vector<char> active;                          ///< 6N mask of the active dofs, the others get no added mass
+	ChVectorDynamic<double> grouped_w;                 ///< w gathered from the hydro bodies' blocks (6N)
+	ChVectorDynamic<double> grouped_Mw;                ///< c * M * grouped_w, scattered back into R (6N)
+	bool body_blocks;                                  ///< every loadable is one 6 dof block (rigid bodies): per body 6x6 kernels
+	std::vector<char> nonzero_block;                   ///< N x N mask of the body pairs with a nonzero 6x6 added mass block
+	bool jacobian_computed = false;                    ///< jacobians hold the (constant) added mass
+	bool krm_loaded        = false;                    ///< KRM holds krm_mfactor * M
+	double krm_mfactor     = 0.0;
+	void GroupedResidual_Mv(ChVectorDynamic<>& R, const ChVectorDynamic<>& w, const double c);
 	virtual bool IsStiff() override { return true; } // this to force the use of the inertial M, R and K matrices
 };
\ No newline at end of file
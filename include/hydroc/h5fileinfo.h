@@ -46,6 +46,11 @@ class HydroData {
         Eigen::VectorXd freq_list;
         Eigen::Tensor<double, 3> excitation_mag_matrix;
         Eigen::Tensor<double, 3> excitation_phase_matrix;
+        // scattering (diffraction) part of the excitation, empty if the h5 file has none
+        Eigen::Tensor<double, 3> scattering_mag_matrix;
+        Eigen::Tensor<double, 3> scattering_phase_matrix;
+        // mean drift force per wave amplitude squared (heading 0), 6 x freq_list size, empty if the h5 file has none
+        Eigen::MatrixXd mean_drift_matrix;
     };
     struct IrregularWaveInfo {
         // Eigen::Tensor<double,3> excitation_re_matrix;
@@ -80,7 +85,7 @@ class HydroData {
     // argument first, body_num is always 0 indexed, one line return types can be defined here and not in cpp
     Eigen::MatrixXd GetInfAddedMassMatrix(int b) const;
     double GetHydrostaticStiffnessVal(int b, int i, int j) const;
-    Eigen::MatrixXd GetLinMatrix(int b) const;
+    const Eigen::MatrixXd& GetLinMatrix(int b) const;
     double GetRIRFVal(int b, int i, int n, int m) const;
     double GetDispVolVal(int b) const { return body_data[b].disp_vol; }
     Eigen::VectorXd GetCGVector(int b) const { return body_data[b].cg; }
@@ -119,6 +124,7 @@ class H5FileInfo {
 
     ~H5FileInfo();
 
+    // thread safe, HDF5 access is serialized internally
     HydroData readH5Data();  // TODO: eventually pass user input struct here
 
   private:
@@ -126,7 +132,7 @@ class H5FileInfo {
     int num_bodies;
 
     //void InitScalar(H5::H5File& file, std::string data_name, double& var);
-    void H5FileInfo::InitScalar(H5::H5File& file, std::string data_name, double& var);
+    void InitScalar(H5::H5File& file, std::string data_name, double& var);
     void Init1D(H5::H5File& file, std::string data_name, Eigen::VectorXd& var);
     void Init2D(H5::H5File& file, std::string data_name, Eigen::MatrixXd& var);
     void Init3D(H5::H5File& file, std::string data_name, Eigen::Tensor<double, 3>& var /*, std::vector<int>& dims*/);
@@ -14,6 +14,8 @@ namespace hydroc {
  * 
  * Set the main data directory ..
  * 
+ * Thread safe, but meant to be called once from main before simulations are started.
+ * 
  * @param argc number of argument (same as for main function)
  * @param argv arguments of main function 
  * @return 1 on error 0 else
@@ -21,10 +23,34 @@ namespace hydroc {
 int setInitialEnvironment(int argc, char* argv[]) noexcept;
 
 /**@brief Get base name of data directory
+ * 
+ * Thread safe.
  * 
  * @return the string containing the path in standard format
 */
 std::string getDataDir() noexcept;
 
+/**@brief Marks HydroChrono per step code on the calling thread
+ * 
+ * Held by the entry points Chrono calls during a time step (TestHydro::coordinateFunc,
+ * ChLoadAddedMass) and by the wave chunk workers, so that allocation checks can attribute
+ * heap allocations to the library (see inStepScope). Scopes nest.
+*/
+class StepScope {
+  public:
+    StepScope() noexcept;
+    ~StepScope();
+    StepScope(const StepScope&) = delete;
+    StepScope& operator=(const StepScope&) = delete;
+};
+
+/**@brief Is a StepScope alive on the calling thread
+ * 
+ * Thread safe, allocation free (can be called from an allocator hook).
+ * 
+ * @return true inside HydroChrono per step code
+*/
+bool inStepScope() noexcept;
+
 
 } // end namespace hydroc
\ No newline at end of file
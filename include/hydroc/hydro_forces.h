@@ -1,3 +1,6 @@
+#pragma once
+
+#include <array>
 #include <cstdio>
 #include <filesystem>
 
@@ -89,7 +92,69 @@ class ForceFunc6d {
 };
 
 class ChLoadAddedMass;
+class HydroPressureMesh;
+class HydrostaticTable;
+class MooringBase;
+struct NaturalMode;
+class ViscousDrag;
+
+// =============================================================================
+// HydroBodyStates holds the kinematic state of all hydro bodies in contiguous
+// structure-of-arrays form, gathered once per time step by TestHydro and shared
+// by every force computation
+struct HydroBodyStates {
+    void resize(int num_bodies);
+    Eigen::VectorXd position;      // 3N: [x, y, z] of each body in the world frame
+    Eigen::VectorXd rotation;      // 3N: Euler123 angles of each body
+    Eigen::VectorXd velocity;      // 6N: [vx, vy, vz, wx, wy, wz] of each body, same layout as the force vectors
+    Eigen::VectorXd acceleration;  // 6N: linear and angular acceleration of each body, as left by the last step
+    std::vector<Eigen::Matrix3d> orientation;  // N: rotation matrix (body to world) of each body
+};
+
+// HydroComponent names the independently updated parts of the hydro force
+enum class HydroComponent { hydrostatics = 0, radiation = 1, waves = 2, drag = 3, mooring = 4, drift = 5 };
+
+// =============================================================================
+// HydroComponentRate controls how often one hydro force component is recomputed
+// (every k time steps or every hydro dt seconds, default: every step). In between
+// updates the last computed value is held, or linearly extrapolated from the last two.
+class HydroComponentRate {
+  public:
+    void Resize(int total_dofs);
+    void SetEverySteps(int steps, bool extrapolate);
+    void SetInterval(double hydro_dt, bool extrapolate);
+    // call once per new time step: true if the component must be recomputed at time t
+    bool IsDue(double t);
+    // record a freshly computed value at time t
+    void Store(double t, const Eigen::Ref<const Eigen::VectorXd>& force);
+    // write the held / extrapolated value at time t (only valid after a Store)
+    void Predict(double t, Eigen::Ref<Eigen::VectorXd> force) const;
+
+  private:
+    int every_steps    = 1;
+    double interval    = 0.0;
+    bool extrapolate   = false;
+    int steps_since    = 0;
+    int num_stored     = 0;
+    double time_last   = 0.0;
+    double time_before = 0.0;
+    Eigen::VectorXd force_last;
+    Eigen::VectorXd force_before;
+};
 
+// TestHydro computes and applies the hydrodynamic forces (hydrostatics, radiation
+// damping, wave excitation) and the infinite frequency added mass load of a set of bodies.
+// Optional parts (nonlinear hydrostatics, drag, moorings, drift, ...) are documented at
+// the methods that enable them.
+//
+// Allocation guarantee: every buffer used by the force computations is sized in the
+// constructor / AddWaves() / the set up methods. Once the first time step has been taken, a
+// DoStepDynamics call makes no heap allocation inside HydroChrono code. This is checked by
+// the noalloc_01 test, keep it that way.
+//
+// Thread safety: independent instances (each with its own ChSystem and WaveBase object) can
+// be stepped concurrently; a single instance must not be used from several threads at once.
+// Checked by the concurrency_01 test.
 class TestHydro {
   public:
     bool printed = false;
@@ -99,13 +164,98 @@ class TestHydro {
               std::shared_ptr<WaveBase> waves);
     TestHydro(std::vector<std::shared_ptr<ChBody>> user_bodies, std::string h5_file_name)
         : TestHydro(user_bodies, h5_file_name, std::static_pointer_cast<WaveBase>(std::make_shared<NoWave>())) {}
+    ~TestHydro();
     TestHydro(const TestHydro& old) = delete;
     TestHydro operator=(const TestHydro& rhs) = delete;
     void AddWaves(std::shared_ptr<WaveBase> waves);
     void WaveSetUp();
-    std::vector<double> ComputeForceHydrostatics();
-    std::vector<double> ComputeForceRadiationDampingConv();
-    Eigen::VectorXd ComputeForceWaves();
+
+    // Multi-rate: recompute a HydroComponent every steps time steps / every hydro_dt seconds only, holding
+    // (or with extrapolate, linearly extrapolating) the last value in between. The radiation velocity history
+    // is still recorded at every step, only the convolution is skipped.
+    void SetUpdateEverySteps(HydroComponent component, int steps, bool extrapolate = false);
+    void SetUpdateInterval(HydroComponent component, double hydro_dt, bool extrapolate = false);
+
+    // Added mass is applied as a ChLoadAddedMass (stiff load, exact coupling) by default. For nearly decoupled
+    // models this folds the translational (as one scalar: the mean of the diagonal) and rotational 3x3 blocks
+    // of each body's infinite frequency added mass into its mass and inertia tensor and removes the added mass
+    // load from the system. What is left (anisotropy, translation-rotation and body-body coupling) is applied
+    // explicitly with the previous step's accelerations. Call once, before simulating.
+    // Coupling ratio: per dof, the row sum of |left over added mass| over the augmented diagonal
+    // mass. Warns above max_coupling_ratio, throws std::runtime_error above 1 (explicit part unstable).
+    void EnableAddedMassInertiaAugmentation(double max_coupling_ratio = 0.1);
+
+    // Nonlinear hydrostatics / Froude-Krylov (HydroPressureMesh) instead of lin_matrix. One OBJ file per body,
+    // in the body frame (the *_cog.obj meshes of the demos), "" keeps the linear hydrostatics for that body.
+    // The hydrostatic pressure is integrated over the part of the mesh below the still water level; with
+    // incident_pressure (regular waves or no waves) the part below the wave elevation, adding the incident
+    // wave pressure, and the excitation keeps only its scattering part.
+    // Counted as the hydrostatics HydroComponent (update rates).
+    void EnableNonlinearFroudeKrylov(const std::vector<std::string>& mesh_files, bool incident_pressure = true);
+    // Tabulated nonlinear hydrostatics (HydrostaticTable), one table per body, nullptr keeps lin_matrix.
+    // Bodies with a pressure mesh (EnableNonlinearFroudeKrylov) use the mesh.
+    void SetHydrostaticTables(const std::vector<std::shared_ptr<HydrostaticTable>>& tables);
+    // Preprocessing for SetHydrostaticTables: per body, reads table_files[b] if it exists, otherwise integrates
+    // mesh_files[b] (as in EnableNonlinearFroudeKrylov) on the grid of heave offsets from the h5 center of
+    // gravity, roll and pitch angles [rad], and saves the table to table_files[b]. "" mesh: lin_matrix.
+    void BuildHydrostaticTables(const std::vector<std::string>& mesh_files,
+                                const std::vector<std::string>& table_files,
+                                const Eigen::VectorXd& heave_offsets,
+                                const Eigen::VectorXd& roll_angles,
+                                const Eigen::VectorXd& pitch_angles);
+
+    // Viscous drag (ViscousDrag, viscous_drag.h), the drag HydroComponent: see ViscousDrag::SetQuadraticDrag
+    // and ViscousDrag::AddMorisonElement. Body indices are 0 indexed.
+    void SetQuadraticDrag(int b, const Eigen::Matrix<double, 6, 6>& body_drag);
+    void AddMorisonElement(int b,
+                           const Eigen::Vector3d& position,
+                           const Eigen::Vector3d& axis,
+                           double drag_coefficient,
+                           double area);
+
+    // Add a mooring (CatenaryMooring, LumpedMassMooring, mooring.h) acting on these bodies, initialized with the
+    // current body states. All moorings are evaluated together as the mooring HydroComponent.
+    void AddMooring(std::shared_ptr<MooringBase> mooring);
+
+    // Second order slow drift force (Newman's approximation, NewmanDriftForce), the drift HydroComponent, from
+    // the mean drift coefficients of the h5 file (bodyN/hydro_coeffs/mean_drift, heading 0). Throws
+    // std::runtime_error if no body has them.
+    void EnableMeanDrift();
+    // Mean drift coefficients of body b (0 indexed) instead of the h5 ones: drift is 6 x omegas.size(), force per
+    // wave amplitude squared [N/m^2, N/m] at the increasing frequencies omegas [rad/s]. Enables the drift force.
+    void SetMeanDriftCoefficients(int b, const Eigen::VectorXd& omegas, const Eigen::MatrixXd& drift);
+
+    // Hydro dofs [x, y, z, rx, ry, rz] of body b (0 indexed) that are free to move, default all. Only the active
+    // dofs are convolved, stored in the velocity history and get added mass, excitation, hydrostatic and radiation
+    // forces: the joints must hold the others (that load goes nowhere). Drag, moorings and drift act on all dofs.
+    // Set before simulating, resets the history.
+    void SetActiveDofs(int b, const std::array<bool, 6>& active);
+    // Sets the active dofs of every body held by ChLinkLockPrismatic (translation along the joint axis) or
+    // ChLinkLockRevolute (rotation about the joint axis, and translation normal to it unless the axis passes
+    // through the center of gravity) joints to a fixed body. Fixed bodies and bodies welded to one (fully
+    // constrained ChLinkMateGeneric) have none. Add the joints first; other bodies keep their active dofs.
+    void DetectActiveDofs();
+    std::array<bool, 6> GetActiveDofs(int b) const;
+
+    // Natural periods and damping ratios a decay test would show, from the linear model of these bodies over
+    // their active dofs (NaturalModeAnalysis, natural_modes.h): body masses and inertias (without the added mass
+    // folded in by EnableAddedMassInertiaAugmentation), h5 restoring stiffness and radiation. No simulation needed.
+    std::vector<NaturalMode> ComputeNaturalModes(double tolerance = 1e-6, int max_iterations = 50) const;
+
+    // Direct solvers: hydrostatics, radiation and waves are applied as forces (right hand side only) and the
+    // added mass block is constant. true: the hydro contributions to the system matrix keep their pattern
+    bool HasFixedSparsityPattern() const;
+    // Locks the sparsity pattern of the system's direct solver (set it first, e.g. ChSolverHydroSparseLU / QR,
+    // which then also keeps the symbolic factorization). Only when nothing else changes the pattern: no
+    // contacts, no links added later. Throws std::runtime_error if the solver is not a ChDirectSolverLS.
+    void EnableSymbolicReuse();
+
+    const std::vector<double>& ComputeForceHydrostatics();
+    const std::vector<double>& ComputeForceRadiationDampingConv();
+    const Eigen::VectorXd& ComputeForceWaves();
+    const Eigen::VectorXd& ComputeForceDrag();
+    const Eigen::VectorXd& ComputeForceMooring();
+    const Eigen::VectorXd& ComputeForceDrift();
     // std::vector<double> ComputeForceExcitationRegularFreq();
     // double ExcitationConvolution(int body,
     //                             int dof,
@@ -117,6 +267,7 @@ class TestHydro {
     // std::vector<double> ComputeForceExcitation();
     double GetRIRFval(int row, int col, int st);
     double coordinateFunc(int b, int i);
+    const HydroBodyStates& GetBodyStates() const { return body_states; }
     bool convTrapz;
     Eigen::VectorXd t_irf;
 
@@ -125,24 +276,61 @@ class TestHydro {
     int num_bodies;
     HydroData file_info;
     std::vector<ForceFunc6d> force_per_body;
+    HydroBodyStates body_states;
     double sumVelHistoryAndRIRF;
     // HydroInputs hydro_inputs;
     std::shared_ptr<WaveBase> user_waves;
     std::vector<double> force_hydrostatic;
     std::vector<double> force_radiation_damping;
     Eigen::VectorXd force_waves;
+    Eigen::VectorXd force_drag;
+    Eigen::VectorXd force_mooring;
+    Eigen::VectorXd force_drift;
     // std::vector<double> force_excitation;
     std::vector<double> total_force;
     std::vector<double> equilibrium;
     std::vector<double> cb_minus_cg;
     double rirf_timestep;
     double getVelHistoryVal(int step, int c) const;
-    double setVelHistory(double val, int step, int b_num, int index);
+    double setVelHistory(double val, int step, int c);
+    void GatherBodyStates();
+    void RecordVelocityHistory();
+    void ConvolveRadiationDamping();
+    void ComputeForceAddedMassCorrection();
+    void ComputeForceNonlinearPressure(int b);
+    void SetUpMeanDrift();
+    void SetUpActiveDofs();
+    // inertia augmentation mode, see EnableAddedMassInertiaAugmentation
+    bool added_mass_in_inertia = false;
+    Eigen::MatrixXd infinite_added_mass;                // 6N x 6N, world frame
+    std::vector<double> folded_added_mass;              // per body, scalar added mass folded into the body mass
+    std::vector<Eigen::Matrix3d> folded_added_inertia;  // per body, rotational block folded in (body frame)
+    Eigen::VectorXd force_added_mass;                   // explicit added mass correction
+    std::array<HydroComponentRate, 6> component_rates;  // indexed by HydroComponent
+    // nonlinear pressure mode, see EnableNonlinearFroudeKrylov
+    std::vector<std::unique_ptr<HydroPressureMesh>> pressure_meshes;  // per body, null: linear hydrostatics
+    bool nonlinear_incident_pressure = false;
+    std::vector<std::shared_ptr<HydrostaticTable>> hydrostatic_tables;  // per body, null: lin_matrix
+    std::unique_ptr<ViscousDrag> drag;
+    std::vector<std::shared_ptr<MooringBase>> moorings;
+    // slow drift, see EnableMeanDrift / SetMeanDriftCoefficients. Per body, empty: no drift force
+    std::vector<Eigen::VectorXd> drift_omegas;
+    std::vector<Eigen::MatrixXd> drift_coefficients;
+    std::unique_ptr<NewmanDriftForce> mean_drift;  // built for the current waves, null without drift
+    // active dofs, see SetActiveDofs. The radiation kernel holds the RIRF between the active dofs only: n x (n size),
+    // step st in columns [st n, st n + n)
+    std::vector<char> dof_active;       // 6N
+    std::vector<char> wave_dof_active;  // 6N, the mask the excitation of user_waves was last zeroed with
+    std::vector<int> active_dofs;       // n indices (6 b + dof) of the active dofs, increasing
+    Eigen::MatrixXd rirf_active;
+    Eigen::VectorXd radiation_integrand;  // n scratch: kernel times velocity history at one step
+    Eigen::VectorXd radiation_integrand_prev;
+    Eigen::VectorXd radiation_sum;
 
     // double freq_index_des;
     // int freq_index_floor;
     // double freq_interp_val;
-    std::vector<double> velocity_history;  // use helper function to access vel_history elements correctly
+    std::vector<double> velocity_history;  // n active dofs per step, use the helper functions to access it
     double prev_time;
     Eigen::VectorXd rirf_time_vector;  // (should be the same for each body?)
     int offset_rirf;
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <hydroc/wave_types.h>
+
+// =============================================================================
+// HydroPressureMesh integrates the hydrostatic and (optionally) incident wave pressure over
+// the instantaneous wetted surface of a body's triangle mesh: the nonlinear Froude-Krylov and
+// hydrostatic force.
+//
+// The mesh is read from an OBJ file in the body (center of gravity) frame, the frame the *_cog.obj
+// meshes are loaded in by ChBodyEasyMesh without mass computation. Faces must be oriented with
+// outward normals. The triangles are sorted into a bounding volume hierarchy (bounding spheres,
+// body frame) at load time. Each call walks it from the root:
+//   - nodes above the highest possible free surface are dry and skipped,
+//   - nodes below the lowest possible free surface, small compared to the shortest wave, see a
+//     pressure that is linear over the node: their force is evaluated in O(1) from moments of the
+//     node's triangles precomputed at load time,
+//   - the remaining nodes are opened down to their triangles, which are clipped against the free
+//     surface (elevation interpolated along the edges) and integrated one by one.
+// So the per call cost grows with the number of triangles near the waterline, not the mesh size.
+class HydroPressureMesh {
+  public:
+    struct Triangle {
+        int v[3];
+        Eigen::Vector3d normal;    // unit, outward, body frame
+        Eigen::Vector3d centroid;  // body frame
+        double area;
+    };
+
+    // aggregate moments of a set of triangles for a pressure p(x) = p0 + grad . x (body frame):
+    //   force  = -(p0 * normal_area + normal_moment * grad)
+    //   torque = -(p0 * torque_area + torque_moment * grad)   (about the body frame origin)
+    struct Moments {
+        Eigen::Vector3d normal_area   = Eigen::Vector3d::Zero();  // sum A n
+        Eigen::Matrix3d normal_moment = Eigen::Matrix3d::Zero();  // sum A n c^T
+        Eigen::Vector3d torque_area   = Eigen::Vector3d::Zero();  // sum A c x n
+        Eigen::Matrix3d torque_moment = Eigen::Matrix3d::Zero();  // sum -[n]x (int x x^T dA)
+    };
+
+    struct Node {
+        Eigen::Vector3d center;  // bounding sphere, body frame
+        double radius;
+        int first;  // first triangle (leaves) or left child (inner nodes)
+        int count;  // number of triangles, 0 for inner nodes (right child is left + 1)
+        Moments moments;
+    };
+
+    HydroPressureMesh(const std::string& obj_file_name, int max_leaf_triangles = 4);
+    HydroPressureMesh(const std::vector<Eigen::Vector3d>& body_vertices,
+                      const std::vector<std::array<int, 3>>& triangles,
+                      int max_leaf_triangles = 4);
+
+    // force and torque (about the body frame origin) in the world frame, for a body at position pos
+    // with rotation matrix rot (body to world). waves == nullptr or incident_pressure false: still
+    // water hydrostatics only. rho g is the hydrostatic pressure gradient (g > 0).
+    void Integrate(const Eigen::Vector3d& pos,
+                   const Eigen::Matrix3d& rot,
+                   double t,
+                   double rho,
+                   double g,
+                   WaveBase* waves,
+                   bool incident_pressure,
+                   Eigen::Ref<Eigen::Matrix<double, 6, 1>> force);
+
+    // node size limit (times the largest wave number) for evaluating submerged nodes with a linearized
+    // wave pressure, larger values trade accuracy for speed
+    double max_linearized_node_kr = 0.2;
+
+    int GetNumTriangles() const { return static_cast<int>(triangles.size()); }
+    int GetNumNodes() const { return static_cast<int>(nodes.size()); }
+    // statistics of the last Integrate call
+    int GetNumClippedTriangles() const { return num_clipped_triangles; }
+    int GetNumAggregatedNodes() const { return num_aggregated_nodes; }
+    // volume enclosed by the mesh (divergence theorem), for checks
+    double GetVolume() const;
+
+  private:
+    std::vector<Eigen::Vector3d> vertices;  // body frame
+    std::vector<Triangle> triangles;        // reordered so that every node owns a contiguous range
+    std::vector<Node> nodes;                // nodes[0] is the root
+    int max_leaf_triangles;
+
+    // per call scratch, sized at construction: vertex world positions and free surface depths,
+    // evaluated on first use in a call (stamp) so waterline vertices shared by triangles are done once
+    std::vector<Eigen::Vector3d> vertex_world;
+    std::vector<double> vertex_depth;  // elevation - z, > 0 wet
+    std::vector<int> vertex_stamp;
+    std::vector<int> node_stack;
+    int stamp                 = 0;
+    int num_clipped_triangles = 0;
+    int num_aggregated_nodes  = 0;
+
+    void Build(const std::vector<std::array<int, 3>>& faces);
+    void BuildNode(int node, int first, int count);
+    void EvaluateVertex(int v, const Eigen::Vector3d& pos, const Eigen::Matrix3d& rot, double t, WaveBase* waves);
+    void IntegrateTriangle(const Triangle& tri,
+                           const Eigen::Vector3d& pos,
+                           const Eigen::Matrix3d& rot,
+                           double t,
+                           double rho_g,
+                           WaveBase* waves,
+                           Eigen::Vector3d& force,
+                           Eigen::Vector3d& torque);
+    static void AddMoments(const Triangle& tri, const std::vector<Eigen::Vector3d>& vertices, Moments& moments);
+};
+
+// =============================================================================
+// HydrostaticTable holds the still water hydrostatic force and torque (about the center of gravity,
+// world frame) of a body on a grid of center of gravity heights, roll and pitch angles, integrated
+// once with a HydroPressureMesh. Evaluating it is a trilinear interpolation: nonlinear restoring
+// at about the cost of lin_matrix.
+// Angles are those of R = Rz(yaw) Ry(pitch) Rx(roll); yaw and the horizontal position do not change
+// still water hydrostatics, the yaw only rotates the tabulated vectors. Outside the grid the nearest
+// grid value is used.
+// File format (text): a header line, the three axis sizes, the axis values, then one line of 6
+// values per grid point, pitch fastest.
+class HydrostaticTable {
+  public:
+    // integrates mesh (in the body frame) at every grid point
+    HydrostaticTable(HydroPressureMesh& mesh,
+                     const Eigen::VectorXd& cg_heights,
+                     const Eigen::VectorXd& roll_angles,
+                     const Eigen::VectorXd& pitch_angles,
+                     double rho,
+                     double g);
+    // reads a table written by Save
+    explicit HydrostaticTable(const std::string& file_name);
+
+    void Save(const std::string& file_name) const;
+
+    // force and torque (world frame) of the body at position pos with rotation rot (body to world)
+    void Interpolate(const Eigen::Vector3d& pos,
+                     const Eigen::Matrix3d& rot,
+                     Eigen::Ref<Eigen::Matrix<double, 6, 1>> force) const;
+
+    const Eigen::VectorXd& GetHeights() const { return heights; }
+    const Eigen::VectorXd& GetRollAngles() const { return rolls; }
+    const Eigen::VectorXd& GetPitchAngles() const { return pitches; }
+
+  private:
+    Eigen::VectorXd heights;
+    Eigen::VectorXd rolls;
+    Eigen::VectorXd pitches;
+    Eigen::Matrix<double, 6, Eigen::Dynamic> values;  // column (height * num_rolls + roll) * num_pitches + pitch
+
+    int Column(int i_height, int i_roll, int i_pitch) const {
+        return (i_height * static_cast<int>(rolls.size()) + i_roll) * static_cast<int>(pitches.size()) + i_pitch;
+    }
+    static int Bracket(const Eigen::VectorXd& axis, double x, double& weight);
+};
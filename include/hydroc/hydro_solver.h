@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/OrderingMethods>
+#include <Eigen/SparseCore>
+#include <Eigen/SparseLU>
+#include <Eigen/SparseQR>
+#include <unsupported/Eigen/IterativeSolvers>
+
+#include <chrono/physics/ChBody.h>
+#include <chrono/solver/ChDirectSolverLS.h>
+#include <chrono/solver/ChIterativeSolverLS.h>
+
+// =============================================================================
+// HydroBlockPreconditioner is an Eigen preconditioner (same interface as
+// Eigen::DiagonalPreconditioner) for the assembled Chrono system matrix. The rows and
+// columns of the hydro bodies (body mass + infinite added mass, strongly coupled) are
+// extracted as one dense 6N x 6N block and solved with a cached LDLT factorization,
+// every other row (other bodies, constraints) is Jacobi preconditioned.
+// The factorization is only recomputed when the block values change, with a fixed step
+// size and the constant added mass jacobian this is once per run.
+class HydroBlockPreconditioner {
+  public:
+    typedef int StorageIndex;
+    enum { ColsAtCompileTime = Eigen::Dynamic, MaxColsAtCompileTime = Eigen::Dynamic };
+
+    HydroBlockPreconditioner() {}
+
+    template <typename MatType>
+    explicit HydroBlockPreconditioner(const MatType& mat) {
+        compute(mat);
+    }
+
+    // rows (= columns) of the system matrix that belong to the hydro bodies, 6 per body
+    void SetBlockIndices(const std::vector<int>& indices) { block_indices = indices; }
+
+    Eigen::Index rows() const { return inv_diag.size(); }
+    Eigen::Index cols() const { return inv_diag.size(); }
+
+    template <typename MatType>
+    HydroBlockPreconditioner& analyzePattern(const MatType&) {
+        return *this;
+    }
+
+    template <typename MatType>
+    HydroBlockPreconditioner& factorize(const MatType& mat);
+
+    template <typename MatType>
+    HydroBlockPreconditioner& compute(const MatType& mat) {
+        return factorize(mat);
+    }
+
+    template <typename Rhs, typename Dest>
+    void _solve_impl(const Rhs& b, Dest& x) const;
+
+    template <typename Rhs>
+    inline const Eigen::Solve<HydroBlockPreconditioner, Rhs> solve(const Eigen::MatrixBase<Rhs>& b) const {
+        return Eigen::Solve<HydroBlockPreconditioner, Rhs>(*this, b.derived());
+    }
+
+    Eigen::ComputationInfo info() { return Eigen::Success; }
+
+    // number of LDLT factorizations of the hydro block so far (for benchmarks / tests)
+    int GetNumFactorizations() const { return num_factorizations; }
+
+  private:
+    std::vector<int> block_indices;
+    std::vector<int> block_position;  // system row -> row in block, -1 if not a hydro row
+    Eigen::VectorXd inv_diag;
+    Eigen::MatrixXd block;
+    Eigen::MatrixXd factorized_block;
+    Eigen::LDLT<Eigen::MatrixXd> block_ldlt;
+    bool block_ok          = false;
+    int num_factorizations = 0;
+    mutable Eigen::VectorXd block_rhs;
+    mutable Eigen::VectorXd block_sol;
+};
+
+template <typename MatType>
+HydroBlockPreconditioner& HydroBlockPreconditioner::factorize(const MatType& mat) {
+    const Eigen::Index n = mat.cols();
+    const int nb         = static_cast<int>(block_indices.size());
+
+    block_position.assign(n, -1);
+    for (int i = 0; i < nb; i++) {
+        if (block_indices[i] >= 0 && block_indices[i] < n) {
+            block_position[block_indices[i]] = i;
+        }
+    }
+
+    // one pass over the nonzeros: diagonal for Jacobi, hydro rows x hydro cols for the block
+    inv_diag.setZero(n);
+    block.setZero(nb, nb);
+    for (Eigen::Index k = 0; k < mat.outerSize(); ++k) {
+        for (typename MatType::InnerIterator it(mat, k); it; ++it) {
+            if (it.row() == it.col()) {
+                inv_diag[it.row()] = it.value();
+            }
+            int r = block_position[it.row()];
+            int c = block_position[it.col()];
+            if (r >= 0 && c >= 0) {
+                block(r, c) = it.value();
+            }
+        }
+    }
+    for (Eigen::Index j = 0; j < n; j++) {
+        inv_diag[j] = inv_diag[j] != 0.0 ? 1.0 / inv_diag[j] : 1.0;
+    }
+
+    // refactorize only if the block changed since the last factorization
+    bool unchanged = block_ok && factorized_block.rows() == nb && (factorized_block.array() == block.array()).all();
+    if (nb > 0 && !unchanged) {
+        block_ldlt.compute(block);
+        block_ok         = block_ldlt.info() == Eigen::Success;
+        factorized_block = block;
+        num_factorizations++;
+        block_rhs.resize(nb);
+        block_sol.resize(nb);
+    }
+    if (nb == 0) {
+        block_ok = false;
+    }
+    return *this;
+}
+
+template <typename Rhs, typename Dest>
+void HydroBlockPreconditioner::_solve_impl(const Rhs& b, Dest& x) const {
+    x = inv_diag.array() * b.array();
+    if (!block_ok) {
+        return;  // Jacobi only
+    }
+    const int nb = static_cast<int>(block_indices.size());
+    for (int i = 0; i < nb; i++) {
+        block_rhs[i] = b[block_indices[i]];
+    }
+    block_sol = block_ldlt.solve(block_rhs);
+    for (int i = 0; i < nb; i++) {
+        x[block_indices[i]] = block_sol[i];
+    }
+}
+
+// =============================================================================
+// ChSolverHydroGMRES is Chrono's GMRES linear solver (as ChSolver::Type::GMRES) with the
+// HydroBlockPreconditioner in place of the diagonal one. Use it instead of
+// system.SetSolverType(ChSolver::Type::GMRES):
+//     auto solver = chrono_types::make_shared<ChSolverHydroGMRES>(hydro_bodies);
+//     solver->SetMaxIterations(300);
+//     system.SetSolver(solver);
+class ChSolverHydroGMRES : public chrono::ChIterativeSolverLS {
+  public:
+    ChSolverHydroGMRES(std::vector<std::shared_ptr<chrono::ChBody>> hydro_bodies);
+    // Eigen solvers are not copyable, the clone gets a fresh engine with the same settings
+    virtual ChSolverHydroGMRES* Clone() const override;
+
+    virtual int GetIterations() const override { return static_cast<int>(m_engine->iterations()); }
+    virtual double GetError() const override { return m_engine->error(); }
+
+    // Krylov subspace dimension before a restart (Eigen default 30)
+    void SetRestart(int restart);
+
+    const HydroBlockPreconditioner& GetPreconditioner() const { return m_engine->preconditioner(); }
+
+  private:
+    virtual bool SetupProblem() override;
+    virtual bool SolveProblem() override;
+
+    std::vector<std::shared_ptr<chrono::ChBody>> bodies;
+    std::vector<int> block_indices;
+    int restart = 30;
+    std::unique_ptr<Eigen::GMRES<chrono::ChSparseMatrix, HydroBlockPreconditioner>> m_engine;
+};
+
+// =============================================================================
+// ChSolverHydroSparse is Chrono's sparse direct solver (ChSolverSparseLU / ChSolverSparseQR)
+// with the symbolic factorization (fill reducing ordering, elimination tree) kept between
+// calls: it is only redone when the nonzero pattern of the assembled matrix changes, otherwise
+// just the numeric factorization is. With the sparsity pattern locked (see
+// TestHydro::EnableSymbolicReuse) the pattern of a hydro model without contacts is the same
+// every step, so the analysis is done once per run:
+//     system.SetSolver(chrono_types::make_shared<ChSolverHydroSparseQR>());
+//     hydro_forces.EnableSymbolicReuse();
+template <typename Engine>
+class ChSolverHydroSparse : public chrono::ChDirectSolverLS {
+  public:
+    ChSolverHydroSparse() : m_engine(std::make_unique<Engine>()) {}
+    // Eigen solvers are not copyable, the clone gets a fresh engine with the same settings
+    virtual ChSolverHydroSparse* Clone() const override {
+        auto clone = new ChSolverHydroSparse();
+        clone->LockSparsityPattern(m_lock);
+        clone->UseSparsityPatternLearner(m_use_learner);
+        clone->verbose = verbose;
+        return clone;
+    }
+
+    // number of symbolic analyses so far (for benchmarks / tests)
+    int GetNumAnalyzePattern() const { return num_analyze_pattern; }
+
+  private:
+    virtual bool FactorizeMatrix() override;
+    virtual bool SolveSystem() override;
+    virtual void PrintErrorMessage() override;
+
+    std::unique_ptr<Engine> m_engine;
+    std::vector<int> outer_pattern;  // compressed row starts of the analyzed matrix
+    std::vector<int> inner_pattern;  // column indices of the analyzed matrix
+    int num_analyze_pattern = 0;
+};
+
+using ChSolverHydroSparseLU =
+    ChSolverHydroSparse<Eigen::SparseLU<chrono::ChSparseMatrix, Eigen::COLAMDOrdering<int>>>;
+using ChSolverHydroSparseQR =
+    ChSolverHydroSparse<Eigen::SparseQR<chrono::ChSparseMatrix, Eigen::COLAMDOrdering<int>>>;
+
+template <typename Engine>
+bool ChSolverHydroSparse<Engine>::FactorizeMatrix() {
+    m_mat.makeCompressed();
+    const int* outer = m_mat.outerIndexPtr();
+    const int* inner = m_mat.innerIndexPtr();
+    const size_t num_outer = static_cast<size_t>(m_mat.outerSize()) + 1;
+    const size_t num_inner = static_cast<size_t>(m_mat.nonZeros());
+
+    bool same_pattern = num_analyze_pattern > 0 && outer_pattern.size() == num_outer &&
+                        inner_pattern.size() == num_inner &&
+                        std::equal(outer_pattern.begin(), outer_pattern.end(), outer) &&
+                        std::equal(inner_pattern.begin(), inner_pattern.end(), inner);
+    if (!same_pattern) {
+        m_engine->analyzePattern(m_mat);
+        outer_pattern.assign(outer, outer + num_outer);
+        inner_pattern.assign(inner, inner + num_inner);
+        num_analyze_pattern++;
+    }
+    m_engine->factorize(m_mat);
+    return m_engine->info() == Eigen::Success;
+}
+
+template <typename Engine>
+bool ChSolverHydroSparse<Engine>::SolveSystem() {
+    m_sol = m_engine->solve(m_rhs);
+    return m_engine->info() == Eigen::Success;
+}
+
+template <typename Engine>
+void ChSolverHydroSparse<Engine>::PrintErrorMessage() {
+    // same messages as Chrono's sparse direct solvers
+    switch (m_engine->info()) {
+        case Eigen::Success:
+            std::cerr << "computation was successful" << std::endl;
+            break;
+        case Eigen::NumericalIssue:
+            std::cerr << "provided data did not satisfy the prerequisites" << std::endl;
+            break;
+        case Eigen::NoConvergence:
+            std::cerr << "iterative procedure did not converge" << std::endl;
+            break;
+        case Eigen::InvalidInput:
+            std::cerr << "inputs are invalid, or the algorithm has been improperly called" << std::endl;
+            break;
+    }
+    std::cerr << m_engine->lastErrorMessage() << std::endl;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <hydroc/hydro_forces.h>
+
+// =============================================================================
+// MooringBase is the interface TestHydro calls in its force pass (TestHydro::AddMooring, the
+// mooring HydroComponent). A mooring connects hydro bodies (0 indexed, as in TestHydro's body
+// vector) to the world or to each other.
+class MooringBase {
+  public:
+    virtual ~MooringBase() = default;
+    // called once by TestHydro::AddMooring with the current body states: check body indices, size
+    // every buffer used by AddForce, build tables / initial line shapes
+    virtual void Initialize(const HydroBodyStates& states) = 0;
+    // add the mooring force and torque (about each body's center of gravity, world frame) at time t
+    // to force (6N, same layout as the other hydro forces). Called once per hydro update, with
+    // increasing t. Must not allocate.
+    virtual void AddForce(double t, const HydroBodyStates& states, Eigen::Ref<Eigen::VectorXd> force) = 0;
+};
+
+// one mooring line from a fixed anchor on the seabed to a fairlead on a hydro body
+struct CatenaryLine {
+    int body;                  // hydro body index (0 indexed)
+    Eigen::Vector3d fairlead;  // body frame, from the center of gravity
+    Eigen::Vector3d anchor;    // world frame, on the seabed
+    double length;             // unstretched length [m]
+    double weight;             // submerged weight per unit length [N/m]
+    double stiffness;          // axial stiffness EA [N]
+};
+
+// =============================================================================
+// CatenaryMooring: quasi-static elastic catenary lines with frictionless seabed contact (as MAP++).
+// Solving the catenary equations (Newton) for every line at every step is replaced by a table of the
+// fairlead tension (horizontal H, vertical V) over the horizontal and vertical fairlead-anchor span,
+// solved once in Initialize for the span range the line can reach (initial span +- max_excursion).
+// A step is then one bilinear lookup per line; spans outside the table use its edge values.
+// Lines are stored structure of arrays and evaluated in parallel (OpenMP, when Chrono is built with
+// it) once there are enough of them to pay for the threads.
+class CatenaryMooring : public MooringBase {
+  public:
+    explicit CatenaryMooring(double max_excursion = 20.0, int table_size = 64);
+    // add all lines before TestHydro::AddMooring
+    void AddLine(const CatenaryLine& line);
+
+    void Initialize(const HydroBodyStates& states) override;
+    void AddForce(double t, const HydroBodyStates& states, Eigen::Ref<Eigen::VectorXd> force) override;
+
+    // fairlead tension (H, V) [N] of an (elastic) catenary line spanning horizontal_span and
+    // vertical_span (fairlead above anchor), Newton iteration from guess (a negative H: automatic)
+    static Eigen::Vector2d SolveCatenary(const CatenaryLine& line,
+                                         double horizontal_span,
+                                         double vertical_span,
+                                         Eigen::Vector2d guess = Eigen::Vector2d(-1.0, 0.0));
+    // horizontal and vertical span of a line with fairlead tension (H, V), the catenary equations
+    static Eigen::Vector2d CatenarySpan(const CatenaryLine& line, double horizontal_tension, double vertical_tension);
+    // horizontal and vertical offset from the anchor of the point at unstretched arc length s (from the
+    // anchor) of a line with fairlead tension (H, V): the static line shape
+    static Eigen::Vector2d CatenaryProfile(const CatenaryLine& line,
+                                           double horizontal_tension,
+                                           double vertical_tension,
+                                           double s);
+
+    int GetNumLines() const { return static_cast<int>(lines.size()); }
+    // fairlead tension (H, V) of each line at the last AddForce call, 2 x num_lines
+    const Eigen::Matrix<double, 2, Eigen::Dynamic>& GetFairleadTensions() const { return tensions; }
+    // lines evaluated in parallel (OpenMP builds) from this many on
+    int min_parallel_lines = 64;
+
+  private:
+    double max_excursion;
+    int table_size;
+    std::vector<CatenaryLine> lines;
+
+    // per line, structure of arrays
+    Eigen::VectorXi line_body;
+    Eigen::Matrix3Xd line_fairlead;  // body frame
+    Eigen::Matrix3Xd line_anchor;    // world frame
+    Eigen::Matrix2Xd span_origin;    // table (X, Z) of the first grid point
+    Eigen::Matrix2Xd span_step;      // table grid spacing
+    // all tables, line after line: (H, V) at column line * table_size^2 + i_x * table_size + i_z
+    Eigen::Matrix<double, 2, Eigen::Dynamic> table;
+    Eigen::Matrix<double, 2, Eigen::Dynamic> tensions;
+    Eigen::Matrix<double, 6, Eigen::Dynamic> line_force;  // per line force / torque, summed per body afterwards
+
+    Eigen::Vector2d Lookup(int line, double x, double z) const;
+};
+
+// one lumped mass mooring line from a fixed anchor on the seabed to a fairlead on a hydro body
+struct LumpedMassLine {
+    int body;                      // hydro body index (0 indexed)
+    Eigen::Vector3d fairlead;      // body frame, from the center of gravity
+    Eigen::Vector3d anchor;        // world frame, on the seabed
+    double length;                 // unstretched length [m]
+    double diameter;               // volume equivalent diameter [m], for buoyancy, added mass and drag
+    double mass;                   // mass per unit length in air [kg/m]
+    double stiffness;              // axial stiffness EA [N]
+    double damping         = 0.0;  // axial internal damping BA [N s]
+    int num_segments       = 20;
+    double drag_normal     = 1.2;  // transverse drag coefficient
+    double drag_tangential = 0.008;
+    double added_mass      = 1.0;  // transverse added mass coefficient
+};
+
+// =============================================================================
+// LumpedMassMooring: dynamic mooring lines (as MoorDyn): each line is a chain of point masses
+// joined by axial spring-dampers (no compression), loaded by wet weight, Morison drag in still water
+// and a seabed spring-damper; the fairlead node follows the body. Lines start on their static
+// (catenary) shape.
+// Every AddForce call advances the lines from the previous call's time with their own sub-step (at
+// most max_substep, and half the explicit stability limit of the line), the fairlead moving linearly
+// in between; the body gets the fairlead node's load. Node states of all lines are held structure of
+// arrays (NodeArray, x / y / z rows over all nodes); lines are independent over a call, so they can
+// be integrated in parallel (OpenMP builds, see min_parallel_lines).
+class LumpedMassMooring : public MooringBase {
+  public:
+    // one column per node or segment, coordinates in rows: each row is contiguous, so the per line
+    // kernels run as vector operations along the line
+    using NodeArray = Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor>;
+    using NodeRow   = Eigen::Array<double, 1, Eigen::Dynamic>;
+
+    explicit LumpedMassMooring(double rho = 1025.0, double g = 9.81, double max_substep = 1e-3);
+    // add all lines before TestHydro::AddMooring
+    void AddLine(const LumpedMassLine& line);
+
+    void Initialize(const HydroBodyStates& states) override;
+    void AddForce(double t, const HydroBodyStates& states, Eigen::Ref<Eigen::VectorXd> force) override;
+
+    int GetNumLines() const { return static_cast<int>(lines.size()); }
+    // nodes of line l are columns [GetFirstNode(l), GetFirstNode(l + 1)), anchor first
+    int GetFirstNode(int line) const { return node_first[line]; }
+    const NodeArray& GetNodePositions() const { return node_position; }
+    // force of each line on its fairlead at the last AddForce call, 3 x num_lines, world frame
+    const Eigen::Matrix3Xd& GetFairleadForces() const { return fairlead_force; }
+    // sub-step actually used by line l
+    double GetSubstep(int line) const { return substep[line]; }
+    // seabed stiffness [Pa/m] and damping [Pa s/m] per unit of line diameter and length
+    double seabed_stiffness = 3e6;
+    double seabed_damping   = 3e5;
+    // lines integrated in parallel (OpenMP builds) from this many on. Serial by default: the OpenMP team
+    // competes with Chrono's threads and with other TestHydro instances stepped concurrently, and its worker
+    // threads are outside hydroc::StepScope (the noalloc test does not see them). Lower it for models with
+    // many lines stepped on their own.
+    int min_parallel_lines = 64;
+
+  private:
+    double rho;
+    double g;
+    double max_substep;
+    std::vector<LumpedMassLine> lines;
+    double time_last = 0.0;
+    bool started     = false;
+
+    // per line, structure of arrays; segments of line l are columns node_first[l] - l + [0, num_segments)
+    Eigen::VectorXi line_body;
+    Eigen::VectorXi node_first;         // num_lines + 1
+    Eigen::Matrix3Xd line_fairlead;     // body frame
+    Eigen::Matrix3Xd fairlead_last;     // world frame, at time_last
+    Eigen::Matrix3Xd fairlead_force;    // world frame
+    Eigen::VectorXd segment_length;     // unstretched
+    Eigen::VectorXd node_mass;          // internal node, with added mass
+    Eigen::VectorXd node_weight;        // internal node, wet
+    Eigen::VectorXd substep;
+    // per node / segment
+    NodeArray node_position;
+    NodeArray node_velocity;
+    NodeArray node_force;
+    NodeArray segment_tension;  // segment vector, then force of the segment on its lower node
+    // scratch
+    NodeArray node_tangent;
+    NodeRow node_scalar;
+    NodeRow segment_scalar;
+
+    void Advance(int line, double dt, const Eigen::Vector3d& fairlead_start, const Eigen::Vector3d& fairlead_end);
+    void ComputeNodeForces(int line);
+};
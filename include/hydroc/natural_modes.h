@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <hydroc/h5fileinfo.h>
+
+// one damped mode of the linear hydro model, see NaturalModeAnalysis
+struct NaturalMode {
+    double period;           // damped period 2 pi / omega [s], infinite without restoring or when overdamped
+    double damping_ratio;    // -Re(lambda) / |lambda| of the eigenvalue lambda
+    double omega;            // damped frequency [rad/s], the radiation coefficients are evaluated there
+    int dof;                 // dominant dof (6 b + i, 0 indexed body) of the mode shape
+    Eigen::VectorXcd shape;  // displacements over the analysed dofs, unit norm
+    int iterations;          // frequency updates of the radiation coefficients
+    bool converged;
+};
+
+// =============================================================================
+// NaturalModeAnalysis: natural periods and damping ratios of floating bodies from the linear model
+//   (M + A(w)) x'' + B(w) x' + C x = 0
+// instead of a decay simulation. C is the h5 linear restoring stiffness, the radiation coefficients come from
+// the radiation impulse response function K: B(w) = int K(t) cos(w t) dt, A(w) = A_inf - 1/w int K(t) sin(w t) dt
+// (trapezoidal rule over the h5 RIRF time vector, one matrix vector product per frequency).
+// Each undamped mode (C, M + A_inf) is the starting point of a fixed point iteration: solve the quadratic
+// eigenproblem at w, follow the mode by its shape, evaluate A and B again at its damped frequency, until that
+// frequency settles. A few iterations, about a millisecond for a handful of dofs.
+class NaturalModeAnalysis {
+  public:
+    // mass: 6N x 6N rigid body mass matrix (world frame, about each center of gravity) of the N bodies in data.
+    // dofs: the dofs (6 b + i) analysed, increasing, the others are held fixed; empty: all of them
+    NaturalModeAnalysis(const HydroData& data, const Eigen::MatrixXd& mass, const std::vector<int>& dofs = {});
+
+    // modes by increasing undamped frequency (modes without restoring first). tolerance: relative change of the
+    // damped frequency between iterations. Throws std::runtime_error if M + A_inf is not positive definite.
+    std::vector<NaturalMode> Solve(double tolerance = 1e-6, int max_iterations = 50) const;
+    // frequency domain added mass A(omega) and radiation damping B(omega) over the analysed dofs, omega > 0
+    void GetRadiationCoefficients(double omega, Eigen::MatrixXd& added_mass, Eigen::MatrixXd& damping) const;
+    const std::vector<int>& GetDofs() const { return dofs; }
+
+  private:
+    std::vector<int> dofs;
+    Eigen::MatrixXd mass;                // n x n, analysed dofs
+    Eigen::MatrixXd stiffness;           // n x n
+    Eigen::MatrixXd inf_added_mass;      // n x n
+    Eigen::MatrixXd rirf_kernel;         // n^2 x steps: column major n x n RIRF at each time step
+    Eigen::VectorXd rirf_time;           // steps
+    Eigen::VectorXd quadrature_weights;  // trapezoidal rule over rirf_time
+};
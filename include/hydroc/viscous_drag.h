@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <hydroc/hydro_forces.h>
+
+// =============================================================================
+// ViscousDrag: quadratic drag of the hydro bodies on their velocity relative to the incident wave particle
+// velocity, from per body 6x6 coefficients and Morison drag strips. Elements are stored structure of arrays,
+// grouped by body, and every stage runs over all bodies / elements at once; only the wave velocity lookup is
+// per point. Everything is sized when the drag is set up, ComputeForce allocates nothing.
+class ViscousDrag {
+  public:
+    // rho: water density of the h5 file
+    ViscousDrag(int num_bodies, double rho);
+
+    // Quadratic drag of body b (0 indexed): F = -drag * (|v_r| v_r) per dof, v_r the body velocity (world
+    // frame, at the center of gravity) minus the wave particle velocity at the center of gravity (linear dofs
+    // only). drag is in the world frame, e.g. diag(0.5 rho Cd A) as in WEC-Sim's body quadDrag.
+    void SetQuadraticDrag(int b, const Eigen::Matrix<double, 6, 6>& drag);
+    // Morison drag strip on body b (0 indexed) at position (body frame, from the center of gravity): force
+    // -0.5 rho Cd area |v_n| v_n at that point, v_n the relative velocity normal to axis (body frame; a zero
+    // axis keeps the full relative velocity). Add all elements before simulating.
+    void AddMorisonElement(int b,
+                           const Eigen::Vector3d& position,
+                           const Eigen::Vector3d& axis,
+                           double drag_coefficient,
+                           double area);
+    // drag force and torque about the centers of gravity (6N) at time t, overwrites force
+    void ComputeForce(double t, const HydroBodyStates& states, WaveBase& waves, Eigen::VectorXd& force);
+
+  private:
+    int num_bodies;
+    double rho;
+    bool has_body_drag = false;
+    Eigen::Matrix<double, 6, Eigen::Dynamic> body_drag;  // 6 x 6N, one 6x6 block per body
+    Eigen::VectorXd drag_velocity;                       // 6N scratch: relative velocity, then |v_r| v_r
+    // body b owns Morison columns [morison_first[b], morison_first[b + 1])
+    Eigen::Matrix3Xd morison_position;       // body frame
+    Eigen::Matrix3Xd morison_axis;           // body frame, unit or zero
+    Eigen::RowVectorXd morison_coefficient;  // 0.5 rho Cd area
+    std::vector<int> morison_first;
+    Eigen::Matrix3Xd morison_arm;       // scratch: world frame offset from the center of gravity
+    Eigen::Matrix3Xd morison_normal;    // scratch: world frame axis
+    Eigen::Matrix3Xd morison_velocity;  // scratch: relative normal velocity, then force
+    Eigen::RowVectorXd morison_scratch;
+};
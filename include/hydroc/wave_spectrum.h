@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+// =============================================================================
+// Wave spectra: one sided variance density S(f) [m^2 / Hz] of a sea state, f in Hz, for IrregularWave::spectrum.
+// Evaluate works on the whole frequency vector with array expressions (vectorized exp / log, no std::pow per
+// point), in the order given, and is 0 at f <= 0. Invalid parameters throw std::invalid_argument.
+// =============================================================================
+class WaveSpectrum {
+  public:
+    virtual ~WaveSpectrum() = default;
+    virtual Eigen::VectorXd Evaluate(const Eigen::VectorXd& freqs_hz) const = 0;
+};
+
+// Pierson-Moskowitz shape from the significant wave height and the peak period (two parameter form):
+//     S(f) = 5/16 Hs^2 fp^4 f^-5 exp(-5/4 (fp / f)^4), fp = 1 / Tp
+class PiersonMoskowitzSpectrum : public WaveSpectrum {
+  public:
+    PiersonMoskowitzSpectrum(double significant_wave_height, double peak_period);
+    Eigen::VectorXd Evaluate(const Eigen::VectorXd& freqs_hz) const override;
+
+  private:
+    double hs;
+    double tp;
+};
+
+// Bretschneider: the Pierson-Moskowitz shape from Hs and the mean zero crossing period Tz = sqrt(m0 / m2),
+// Tp = (5 pi / 4)^(1/4) Tz
+class BretschneiderSpectrum : public PiersonMoskowitzSpectrum {
+  public:
+    BretschneiderSpectrum(double significant_wave_height, double zero_crossing_period);
+};
+
+// JONSWAP: the Pierson-Moskowitz shape times the peak enhancement gamma^r, r = exp(-(f - fp)^2 / (2 sigma^2 fp^2)),
+// sigma = sigma_a at f <= fp and sigma_b above. Scaled so that m0 = Hs^2 / 16 (integrated once in the
+// constructor); gamma = 1 is Pierson-Moskowitz.
+class JonswapSpectrum : public WaveSpectrum {
+  public:
+    JonswapSpectrum(double significant_wave_height,
+                    double peak_period,
+                    double gamma   = 3.3,
+                    double sigma_a = 0.07,
+                    double sigma_b = 0.09);
+    Eigen::VectorXd Evaluate(const Eigen::VectorXd& freqs_hz) const override;
+
+  private:
+    double hs;
+    double tp;
+    double gamma;
+    double sigma_a;
+    double sigma_b;
+    double scale;  // on the unscaled enhanced shape, m0 = Hs^2 / 16
+};
+
+// one peak of an OchiHubbleSpectrum
+struct OchiHubblePeak {
+    double significant_wave_height;
+    double peak_period;
+    double shape;  // lambda > 0, 1 is the Pierson-Moskowitz shape, larger is narrower
+};
+
+// Ochi-Hubble: sum of generalized Pierson-Moskowitz peaks, two for a bimodal sea (swell and wind sea), with
+// m0 = sum_j Hs_j^2 / 16. In rad/s, w_j = 2 pi / Tp_j:
+//     S(w) = 1/4 sum_j ((4 l_j + 1) / 4 w_j^4)^l_j / Gamma(l_j) Hs_j^2 w^-(4 l_j + 1) exp(-(4 l_j + 1) / 4 (w_j / w)^4)
+// and S(f) = 2 pi S(w).
+class OchiHubbleSpectrum : public WaveSpectrum {
+  public:
+    explicit OchiHubbleSpectrum(const std::vector<OchiHubblePeak>& peaks);
+    Eigen::VectorXd Evaluate(const Eigen::VectorXd& freqs_hz) const override;
+
+  private:
+    std::vector<OchiHubblePeak> peaks;
+    std::vector<double> log_factors;  // log(2 pi / 4 ((4 l + 1) / 4 w^4)^l / Gamma(l) Hs^2) per peak
+};
+
+// measured spectrum: densities [m^2 / Hz] at increasing frequencies [Hz], linear in between, 0 outside the table
+class TabulatedSpectrum : public WaveSpectrum {
+  public:
+    TabulatedSpectrum(const Eigen::VectorXd& freqs_hz, const Eigen::VectorXd& spectral_densities);
+    Eigen::VectorXd Evaluate(const Eigen::VectorXd& freqs_hz) const override;
+
+  private:
+    Eigen::VectorXd table_freqs;
+    Eigen::VectorXd table_densities;
+};
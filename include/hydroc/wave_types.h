@@ -1,18 +1,40 @@
 #pragma once
 #include <hydroc/h5fileinfo.h>
+#include <hydroc/wave_spectrum.h>
 #include <Eigen/Dense>
 
+#include <cmath>
+#include <memory>
+
 #ifndef M_PI
     #define M_PI 3.14159265358979323846
 #endif
 
-// todo move this helper function somewhere else?
-Eigen::VectorXd PiersonMoskowitzSpectrumHz(Eigen::VectorXd& f, double Hs, double Tp);
+// PiersonMoskowitzSpectrum(Hs, Tp) at the frequencies f [Hz], in their order
+Eigen::VectorXd PiersonMoskowitzSpectrumHz(const Eigen::VectorXd& f, double Hs, double Tp);
+// eta(t) = sum_i a_i cos(2 pi f_i t + phase_i) at x = 0 over time_index, amplitudes from
+// WaveComponentAmplitudes, one phase per frequency (e.g. WaveComponentPhases). Memory O(times + frequencies),
+// a uniform time_index (LinSpaced) is evaluated in chunks with two matrix vector products each.
 Eigen::VectorXd FreeSurfaceElevation(const Eigen::VectorXd& freqs_hz,
                                      const Eigen::VectorXd& spectral_densities,
                                      const Eigen::VectorXd& time_index,
-                                     double water_depth,
-                                     int seed = 1);
+                                     const Eigen::VectorXd& phases);
+// amplitudes sqrt(2 S delta_f) of the components of a one sided spectrum on evenly spaced frequencies,
+// delta_f = (last - first) / (size - 1) (the frequency itself for a single one)
+// (as used by FreeSurfaceElevation)
+Eigen::VectorXd WaveComponentAmplitudes(const Eigen::VectorXd& freqs_hz, const Eigen::VectorXd& spectral_densities);
+// uniform random phases in [0, 2 pi) of num_components wave components, the same draws for the same seed
+Eigen::VectorXd WaveComponentPhases(int num_components, int seed = 1);
+// sin and cos of every entry of x into s and c (sized like x by the caller, not resized): reduction to
+// [-pi/4, pi/4] (three part pi / 2) and the Cephes polynomials, branch free so the compiler can vectorize the
+// loop. Within 1 ulp of std::sin / std::cos for |x| < 1e8, about 3x faster. For the per step wave kernels.
+void SinCos(const Eigen::ArrayXd& x, Eigen::ArrayXd& s, Eigen::ArrayXd& c);
+// linear dispersion relation omega^2 = g k tanh(k h), solved with Newton iterations
+std::vector<double> ComputeWaveNumbers(const std::vector<double>& omegas,
+                                       double water_depth,
+                                       double g           = 9.81,
+                                       double tolerance   = 1e-6,
+                                       int max_iterations = 100);
 
 enum class WaveMode {
     /// @brief No waves
@@ -20,16 +42,50 @@ enum class WaveMode {
     /// @brief Regular waves
     regular = 1,
     /// @brief Irregular waves
-    irregular = 2
+    irregular = 2,
+    /// @brief Sum of regular waves
+    polychromatic = 3
 };
 
 // pure virtual (interface) class for wave modes (regular, irregular, etc)
 // use only Eigen3 types
+// GetForceAtTime writes the 6N excitation force at time t into the caller provided vector f
+// (sized by the caller, at least 6 * num_bodies) and must not allocate: it is called every step
+// The incident wave field (world frame, still water level z = 0) is used by the nonlinear pressure
+// integration (HydroPressureMesh); the defaults describe still water.
 class WaveBase {
   public:
-    virtual void Initialize()                        = 0;
-    virtual Eigen::VectorXd GetForceAtTime(double t) = 0;
-    virtual WaveMode GetWaveMode()                   = 0;
+    virtual void Initialize()                                             = 0;
+    virtual void GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) = 0;
+    virtual WaveMode GetWaveMode()                                        = 0;
+
+    // free surface elevation at (p.x, p.y)
+    virtual double GetElevation(const Eigen::Vector3d& p, double t) { return 0.0; }
+    // incident wave dynamic pressure head p_d / (rho g) at p, and its gradient if requested
+    virtual double GetPressureHead(const Eigen::Vector3d& p, double t, Eigen::Vector3d* gradient = nullptr) {
+        if (gradient) {
+            gradient->setZero();
+        }
+        return 0.0;
+    }
+    // incident wave fluid particle velocity at p
+    virtual Eigen::Vector3d GetParticleVelocity(const Eigen::Vector3d& p, double t) { return Eigen::Vector3d::Zero(); }
+    // bound of |elevation| over space and time
+    virtual double GetElevationBound() { return 0.0; }
+    // largest wave number in the field (0 for still water)
+    virtual double GetMaxWaveNumber() { return 0.0; }
+    // linear components of the elevation at the origin, eta = sum_i amplitudes_i cos(omegas_i t + phases_i),
+    // for the second order forces (NewmanDriftForce); none for still water. Valid after Initialize()
+    virtual void GetWaveComponents(Eigen::VectorXd& omegas, Eigen::VectorXd& amplitudes, Eigen::VectorXd& phases) {
+        omegas.resize(0);
+        amplitudes.resize(0);
+        phases.resize(0);
+    }
+    // factor on the wave amplitudes at time t while the waves are ramped up (1 without ramp)
+    virtual double GetRampFactor(double t) { return 1.0; }
+    // zeroes the excitation of the dofs with dof_active[i] == 0 (6N flags) in the data Initialize() computed,
+    // without recomputing anything (TestHydro::SetActiveDofs). A masked dof stays zero until Initialize()
+    virtual void MaskExcitationDofs(const std::vector<char>& dof_active) {}
 };
 
 // class to intstantiate WaveBase for no waves
@@ -38,7 +94,7 @@ class NoWave : public WaveBase {
     NoWave() { num_bodies = 1; }
     NoWave(unsigned int num_b) { num_bodies = num_b; }
     void Initialize() override {}
-    Eigen::VectorXd GetForceAtTime(double t) override;
+    void GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) override;
     WaveMode GetWaveMode() override { return mode; }
 
   private:
@@ -47,56 +103,161 @@ class NoWave : public WaveBase {
 };
 
 // class to instantiate WaveBase for regular waves
+// The excitation of each dof is kept as the two parts of its phasor (magnitude times amplitude, times cos and
+// sin of the phase), so GetForceAtTime is one cos / sin pair for all dofs and a vector update.
 class RegularWave : public WaveBase {
   public:
     RegularWave();
     RegularWave(unsigned int num_b);
     void Initialize() override;
-    Eigen::VectorXd GetForceAtTime(double t) override;
+    void GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) override;
     WaveMode GetWaveMode() override { return mode; }
+    // Airy wave travelling along +x, eta = A cos(omega t - k x), pressure head and particle velocity
+    // extrapolated above z = 0 with their still water level values
+    double GetElevation(const Eigen::Vector3d& p, double t) override;
+    double GetPressureHead(const Eigen::Vector3d& p, double t, Eigen::Vector3d* gradient = nullptr) override;
+    Eigen::Vector3d GetParticleVelocity(const Eigen::Vector3d& p, double t) override;
+    double GetElevationBound() override { return std::abs(regular_wave_amplitude); }
+    double GetMaxWaveNumber() override { return wave_number; }
+    void GetWaveComponents(Eigen::VectorXd& omegas, Eigen::VectorXd& amplitudes, Eigen::VectorXd& phases) override;
+    void MaskExcitationDofs(const std::vector<char>& dof_active) override;
 
-    // user input variables
+    // user input variables, set before Initialize() (the excitation phasors are built there)
     double regular_wave_amplitude;
     double regular_wave_omega;
+    // excitation from the scattering (diffraction) coefficients only, for when the Froude-Krylov part is
+    // integrated over the body mesh (TestHydro::EnableNonlinearFroudeKrylov), set before Initialize()
+    bool scattering_excitation_only = false;
     // double freq_index_des;
     // double wave_omega_delta;
     // Eigen::VectorXd excitation_force_mag;
     // Eigen::VectorXd excitation_force_phase;
 
-    void AddH5Data(std::vector<HydroData::RegularWaveInfo>& reg_h5_data);
+    void AddH5Data(std::vector<HydroData::RegularWaveInfo>& reg_h5_data, HydroData::SimulationParameters& sim_data);
 
   private:
     unsigned int num_bodies;  // TODO is this needed?
     const WaveMode mode = WaveMode::regular;
     std::vector<HydroData::RegularWaveInfo> wave_info;
+    HydroData::SimulationParameters sim_data;
     Eigen::VectorXd excitation_force_mag;
     Eigen::VectorXd excitation_force_phase;
-    Eigen::VectorXd force;
+    Eigen::VectorXd excitation_force_cos;  // mag A cos(phase), 6N
+    Eigen::VectorXd excitation_force_sin;  // mag A sin(phase), 6N
+    double wave_number = 0.0;
+    double depth_decay = 0.0;  // exp(-2 k h), 0 in deep water
     double GetOmegaDelta() const;
-    double GetExcitationMagInterp(int b, int i, int j, double freq_index_des) const;
-    double GetExcitationPhaseInterp(int b, int i, int j, double freq_index_des) const;
+    double GetExcitationMagInterp(const Eigen::Tensor<double, 3>& mag, int i, int j, double freq_index_des) const;
+    double GetExcitationPhaseInterp(const Eigen::Tensor<double, 3>& phase, int i, int j, double freq_index_des) const;
 };
 
+// one regular wave component, eta = amplitude cos(omega t - k x + phase)
+struct WaveComponent {
+    double amplitude;
+    double omega;        // [rad/s]
+    double phase = 0.0;  // [rad]
+};
+
+// class to instantiate WaveBase for a sum of regular waves (bichromatic, multi-tone tests): the h5 excitation
+// coefficients are interpolated once per component in Initialize() and kept as phasor parts, 6N x components.
+// GetForceAtTime evaluates the cos / sin of all component phases in one vectorized kernel (SinCos) and the
+// force as two matrix vector products. The incident wave field is the sum of the Airy waves of the components.
+class PolychromaticWave : public WaveBase {
+  public:
+    PolychromaticWave();
+    PolychromaticWave(unsigned int num_b);
+    // add all components before Initialize(), omega inside the h5 frequency range
+    void AddComponent(double amplitude, double omega, double phase = 0.0);
+    const std::vector<WaveComponent>& GetComponents() const { return components; }
+    void Initialize() override;
+    void GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) override;
+    WaveMode GetWaveMode() override { return mode; }
+    // as RegularWave, summed over the components
+    double GetElevation(const Eigen::Vector3d& p, double t) override;
+    double GetPressureHead(const Eigen::Vector3d& p, double t, Eigen::Vector3d* gradient = nullptr) override;
+    Eigen::Vector3d GetParticleVelocity(const Eigen::Vector3d& p, double t) override;
+    double GetElevationBound() override { return amplitudes.cwiseAbs().sum(); }
+    double GetMaxWaveNumber() override { return wave_numbers.size() > 0 ? wave_numbers.maxCoeff() : 0.0; }
+    void GetWaveComponents(Eigen::VectorXd& omegas, Eigen::VectorXd& amplitudes, Eigen::VectorXd& phases) override;
+    void MaskExcitationDofs(const std::vector<char>& dof_active) override;
+
+    // excitation from the scattering (diffraction) coefficients only, see RegularWave
+    bool scattering_excitation_only = false;
+
+    void AddH5Data(std::vector<HydroData::RegularWaveInfo>& reg_h5_data, HydroData::SimulationParameters& sim_data);
+
+  private:
+    unsigned int num_bodies;
+    const WaveMode mode = WaveMode::polychromatic;
+    std::vector<WaveComponent> components;
+    std::vector<HydroData::RegularWaveInfo> wave_info;
+    HydroData::SimulationParameters sim_data;
+    // per component
+    Eigen::VectorXd omegas;
+    Eigen::VectorXd amplitudes;
+    Eigen::VectorXd phases;
+    Eigen::VectorXd wave_numbers;
+    Eigen::VectorXd depth_decays;    // exp(-2 k h), 0 in deep water
+    Eigen::MatrixXd excitation_cos;  // 6N x components: mag A cos(excitation phase + phase)
+    Eigen::MatrixXd excitation_sin;  // 6N x components: mag A sin(excitation phase + phase)
+    // scratch
+    Eigen::ArrayXd theta;
+    Eigen::ArrayXd cos_theta;
+    Eigen::ArrayXd sin_theta;
+};
+
+// streaming excitation of IrregularWave (defined in wave_types.cpp)
+class IrregularExcitationStream;
+
 // class to instantiate WaveBase for irregular waves
+// The excitation force (convolution of eta with the excitation IRF) of the whole simulation is computed in
+// Initialize() with FFTs, GetForceAtTime interpolates it linearly (clamped to [0, simulation_duration]), or
+// chunk by chunk in streaming mode.
+// Initialize() writes the spectrum and the free surface elevation to spectrum_output_file and
+// eta_output_file when they are set (relative to the working directory, off by default so that
+// concurrent instances write nothing shared; give each instance its own names).
 class IrregularWave : public WaveBase {
   public:
     IrregularWave();
     IrregularWave(unsigned int num_b);
+    IrregularWave(IrregularWave&&) noexcept;
+    ~IrregularWave();
     void Initialize() override;  // call any set up functions from here
-    Eigen::VectorXd GetForceAtTime(double t) override;
+    void GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) override;
     WaveMode GetWaveMode() override { return mode; }
     Eigen::VectorXd SetSpectrumFrequencies(double start, double end, int num_steps);
     void SetUpWaveMesh(std::string filename = "fse_mesh.obj");
     std::string GetMeshFile();
     Eigen::Vector3<double> GetWaveMeshVelocity();
+    // the spectrum components, with the random phases of eta
+    void GetWaveComponents(Eigen::VectorXd& omegas, Eigen::VectorXd& amplitudes, Eigen::VectorXd& phases) override;
+    // linear ramp over ramp_duration, as applied to eta
+    double GetRampFactor(double t) override;
+    void MaskExcitationDofs(const std::vector<char>& dof_active) override;
     // add more helper functions for calculations here:
 
     double wave_height;
     double wave_period;
+    // sea state spectrum (wave_spectrum.h), Pierson-Moskowitz from wave_height and wave_period when not set
+    std::shared_ptr<WaveSpectrum> spectrum;
+    // spectrum_num_frequencies components evenly spaced over [min, max] [Hz] (or SetSpectrumFrequencies)
+    double spectrum_min_frequency = 0.001;
+    double spectrum_max_frequency = 1.0;
+    int spectrum_num_frequencies  = 1000;
     double simulation_duration;
     double simulation_dt;
     double ramp_duration;
-    Eigen::VectorXd eta;
+    std::string spectrum_output_file;  // empty: no output
+    std::string eta_output_file;       // empty: no output
+    Eigen::VectorXd eta;  // whole run, empty in streaming mode
+    // streaming: elevation and excitation force are generated in chunks of stream_chunk_steps time steps when
+    // GetForceAtTime reaches them, for runs of any length (simulation_duration is not used, no eta output).
+    // A chunk is computed from the elevation over the chunk plus the excitation IRF span around it, memory does
+    // not grow with time and loading a chunk allocates nothing. stream_prefetch computes the next chunk on a
+    // worker thread that lives as long as the wave object (started in Initialize).
+    bool streaming         = false;
+    int stream_chunk_steps = 4096;
+    bool stream_prefetch   = false;
 
     void AddH5Data(std::vector<HydroData::IrregularWaveInfo>& irreg_h5_data, HydroData::SimulationParameters& sim_data);
 
@@ -105,20 +266,71 @@ class IrregularWave : public WaveBase {
     const WaveMode mode = WaveMode::irregular;
     std::vector<HydroData::IrregularWaveInfo> wave_info;
     HydroData::SimulationParameters sim_data;
-    std::vector<Eigen::MatrixXd> ex_irf_resampled;
-    std::vector<Eigen::VectorXd> ex_irf_time_resampled;
+    std::vector<Eigen::MatrixXd> ex_irf_resampled;  // per body 6 x size, at the times (ex_irf_first_step + j) eta_dt
+    std::vector<int> ex_irf_first_step;             // per body, first IRF time in steps of eta_dt
+    double eta_dt = 0.0;                            // time step of eta
+    Eigen::MatrixXd excitation_force;               // 6N x eta size, at the times of eta (not streaming)
     Eigen::VectorXd spectrum_frequencies;
     Eigen::VectorXd spectral_densities;
+    Eigen::VectorXd component_phases;  // random phases of eta and of GetWaveComponents, drawn once in Initialize()
     std::string mesh_file_name;
+    std::unique_ptr<IrregularExcitationStream> stream;  // streaming mode only
 
     Eigen::MatrixXd GetExcitationIRF(int b) const;
     Eigen::VectorXd ResampleTime(const Eigen::VectorXd& t_old, const double dt_new);
     Eigen::MatrixXd ResampleVals(const Eigen::VectorXd& t_old, Eigen::MatrixXd& vals_old, const Eigen::VectorXd& t_new);
-    double ExcitationConvolution(int body, int dof, double time);
+    void PrecomputeExcitationForce();
+    void ConvolveExcitation(const Eigen::VectorXd& eta_segment,
+                            int segment_first_step,
+                            int first_step,
+                            Eigen::MatrixXd& force) const;
 
     void CreateSpectrum();
-    void IrregularWave::CreateFreeSurfaceElevation();
-    friend Eigen::VectorXd PiersonMoskowitzSpectrumHz(Eigen::VectorXd& f, double Hs, double Tp);
+    void CreateFreeSurfaceElevation();
+};
+
+// =============================================================================
+// NewmanDriftForce: second order slow drift force from the mean drift coefficients D(omega) of each body
+// (force per wave amplitude squared, heading 0), with Newman's approximation of the difference frequency
+// QTF, T_ij = sign(D_i) sqrt(|D_i D_j|), for the wave components a_i cos(omega_i t + phase_i):
+//     F(t) = sum_i sum_j a_i a_j T_ij cos(theta_i - theta_j) = Re[P(t) conj(Q(t))], theta_i = omega_i t + phase_i
+//     P(t) = sum_i a_i sign(D_i) sqrt|D_i| exp(i theta_i),   Q(t) = sum_i a_i sqrt|D_i| exp(i theta_i)
+// Its mean is sum_i a_i^2 D_i (a_i^2 D for a regular wave, where it is constant).
+// The amplitude tables of P and Q are built once in the constructor, for the components that carry
+// drift energy; a step is then one sincos per component and two short matrix-vector products instead
+// of the double sum over frequency pairs. Nothing is allocated per step.
+class NewmanDriftForce {
+  public:
+    // omegas, amplitudes, phases: the wave components (WaveBase::GetWaveComponents)
+    // drift_omegas[b], drift[b]: increasing frequencies [rad/s] and 6 x size mean drift coefficients of body b,
+    // interpolated linearly (edge values outside). An empty drift[b] gives no force on body b.
+    // The weakest components are dropped while their share of the mean drift energy sum_i a_i^2 |D_i| of every
+    // dof stays below max_dropped_energy (0 keeps every component with drift energy).
+    NewmanDriftForce(const Eigen::VectorXd& omegas,
+                     const Eigen::VectorXd& amplitudes,
+                     const Eigen::VectorXd& phases,
+                     const std::vector<Eigen::VectorXd>& drift_omegas,
+                     const std::vector<Eigen::MatrixXd>& drift,
+                     double max_dropped_energy = 1e-4);
+    // add the drift force at time t, scaled by ramp^2 (the wave amplitude ramp), to f (6N)
+    void AddForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f, double ramp = 1.0);
+    // 6N, sum_i a_i^2 D_i over the kept components
+    const Eigen::VectorXd& GetMeanForce() const { return mean_force; }
+    int GetNumComponents() const { return static_cast<int>(omegas.size()); }
+
+  private:
+    Eigen::VectorXd omegas;
+    Eigen::VectorXd phases;
+    Eigen::MatrixXd signed_amplitudes;  // 6N x components: a_i sign(D_i) sqrt|D_i|, P
+    Eigen::MatrixXd amplitudes;         // 6N x components: a_i sqrt|D_i|, Q
+    Eigen::VectorXd mean_force;
+    // scratch
+    Eigen::VectorXd cos_theta;
+    Eigen::VectorXd sin_theta;
+    Eigen::VectorXd p_re;
+    Eigen::VectorXd p_im;
+    Eigen::VectorXd q_re;
+    Eigen::VectorXd q_im;
 };
 
 void WriteFreeSurfaceMeshObj(const std::vector<std::array<double, 3>>& points,
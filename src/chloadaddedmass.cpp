@@ -1,4 +1,5 @@
 #include <hydroc/chloadaddedmass.h>
+#include <hydroc/helper.h>
 
 #include <utility>
 
@@ -23,14 +24,53 @@ ChLoadAddedMass::ChLoadAddedMass(const std::vector<HydroData::BodyInfo>& user_h5
         infinite_added_mass.block(i * 6, 0, 6, nBodies * 6) = user_h5_body_data[i].inf_added_mass;
     }
 
-    // initialize added mass matrix for whole system
-    infinite_added_mass_system = infinite_added_mass;
+    // rigid bodies contribute one 6 dof block each, the residual product then works on 6x6 blocks straight
+    // on the R and w segments and skips the body pairs without hydrodynamic coupling
+    body_blocks = true;
+    for (auto& loadable : loadables) {
+        body_blocks = body_blocks && loadable->GetSubBlocks() == 1 && loadable->GetSubBlockSize(0) == 6;
+    }
+    nonzero_block.resize(nBodies * nBodies);
+    for (int i = 0; i < nBodies; i++) {
+        for (int j = 0; j < nBodies; j++) {
+            nonzero_block[i * nBodies + j] = !infinite_added_mass.block<6, 6>(6 * i, 6 * j).isZero(0.0);
+        }
+    }
+
+    // scratch vectors for the general residual product, sized once
+    grouped_w.setZero(6 * nBodies);
+    grouped_Mw.setZero(6 * nBodies);
+    active.assign(6 * nBodies, 1);
+}
+
+/*******************************************************************************
+ * ChLoadAddedMass::SetActiveDofs()
+ * masks the added mass of the inactive dofs, the body pairs left without
+ * coupling are skipped in the residual
+ *******************************************************************************/
+void ChLoadAddedMass::SetActiveDofs(const std::vector<char>& dof_active) {
+    assert(dof_active.size() == active.size());
+    active            = dof_active;
+    jacobian_computed = false;
+    int nBodies       = static_cast<int>(loadables.size());
+    for (int i = 0; i < nBodies; i++) {
+        for (int j = 0; j < nBodies; j++) {
+            bool nonzero = false;
+            for (int r = 0; r < 6; r++) {
+                for (int c = 0; c < 6; c++) {
+                    nonzero = nonzero || (active[6 * i + r] && active[6 * j + c] &&
+                                          infinite_added_mass(6 * i + r, 6 * j + c) != 0.0);
+                }
+            }
+            nonzero_block[i * nBodies + j] = nonzero;
+        }
+    }
 }
 
 /*******************************************************************************
  * ChLoadAddedMass::ComputeJacobian()
  * Computes Jacobian for load, in this case just the mass matrix is initialized
- * as the added mass matrix
+ * as the added mass matrix (constant, Update() only calls this once)
  *******************************************************************************/
 void ChLoadAddedMass::ComputeJacobian(ChState* state_x,       ///< state position to evaluate jacobians
                                       ChStateDelta* state_w,  ///< state speed to evaluate jacobians
@@ -38,21 +78,16 @@ void ChLoadAddedMass::ComputeJacobian(ChState* state_x,       ///< state positio
                                       ChMatrixRef mR,         ///< result dQ/dv
                                       ChMatrixRef mM          ///< result dQ/da
 ) {
-    // The following ensures that the added mass matrix matches the size of the ChSystem mass matrix. It is necessary
-    // for systems that have both hydro and non-hydro bodies when adding a system-wide load.
-    // @todo if possible, remove hack by using initialiazer function called AFTER the ChSystem is assembled.
-
-    // get mass matrix size
-    auto mmrows = system->GetNcoords_w();  // number of rows in system mass matrix
-    // check if ChSystem mass matrix size different from added mass matrix size
-    if (mmrows != infinite_added_mass_system.rows() && mmrows > 0) {
-        // initialize/update system matrix;
-        infinite_added_mass_system.setZero(mmrows, mmrows);
-        auto amrows                                            = infinite_added_mass.rows();
-        infinite_added_mass_system.block(0, 0, amrows, amrows) = infinite_added_mass;
+    hydroc::StepScope step_scope;
+    // set mass matrix here, only the 6N x 6N hydro block: the jacobians (and the KRM block built from them) are
+    // sized by the loadables, Chrono scatters them into the system matrix at each body's variables offset
+    jacobians->M = infinite_added_mass;
+    for (int i = 0; i < static_cast<int>(active.size()); i++) {
+        if (!active[i]) {
+            jacobians->M.row(i).setZero();
+            jacobians->M.col(i).setZero();
+        }
     }
-    // set mass matrix here
-    jacobians->M = infinite_added_mass_system;
 
     // R gyroscopic damping matrix terms (6Nx6N)
     // 0 for added mass
@@ -63,25 +98,100 @@ void ChLoadAddedMass::ComputeJacobian(ChState* state_x,       ///< state positio
     jacobians->K.setZero();
 }
 
+/*******************************************************************************
+ * ChLoadAddedMass::Update()
+ * the infinite frequency added mass does not depend on time or state, so the
+ * jacobians are computed on the first update and reused for the whole run
+ *******************************************************************************/
+void ChLoadAddedMass::Update(double time) {
+    hydroc::StepScope step_scope;
+    if (!jacobians) {
+        CreateJacobianMatrices();
+        jacobian_computed = false;
+    }
+    if (!jacobian_computed) {
+        ComputeJacobian(nullptr, nullptr, jacobians->K, jacobians->R, jacobians->M);
+        jacobian_computed = true;
+        krm_loaded        = false;
+    }
+}
+
+/*******************************************************************************
+ * ChLoadAddedMass::KRMmatricesLoad()
+ * loads Kfactor*K + Rfactor*R + Mfactor*M into the KRM block, K and R are 0
+ * so this is Mfactor*M; skipped when the block already holds it
+ *******************************************************************************/
+void ChLoadAddedMass::KRMmatricesLoad(double Kfactor, double Rfactor, double Mfactor) {
+    hydroc::StepScope step_scope;
+    if (!jacobians) return;
+    if (krm_loaded && Mfactor == krm_mfactor) return;
+
+    jacobians->KRM.Get_K().noalias() = Mfactor * jacobians->M;
+    krm_mfactor                      = Mfactor;
+    krm_loaded                       = true;
+}
+
 /*******************************************************************************
  * ChLoadAddedMass::LoadIntLoadResidual_Mv()
  * Computes LoadIntLoadResidual_Mv for vector w, const c, and vector R
  * Note R here is vector, and is not R gyroscopic damping matrix from ComputeJacobian
  *******************************************************************************/
 void ChLoadAddedMass::LoadIntLoadResidual_Mv(ChVectorDynamic<>& R, const ChVectorDynamic<>& w, const double c) {
+    hydroc::StepScope step_scope;
     if (!this->jacobians) return;
 
-    // if (!loadable->IsSubBlockActive(0))
-    //	return;
-
-    // R+=c*M*a
-    // segment gives the chunk of vector starting at the first argument, and going for as many elements as the second
-    // argument... in this case, segment gets the 3vector starting at the 0th DOF's offset (ie 0)
-    // R.segment(loadable->GetSubBlockOffset(0), 3) += c * (this->mass * (a_x + chrono::Vcross(a_w,
-    // this->c_m))).eigen();
-    // in this case, segment gets the 3vector starting at the 0th DOF's + 3 offset (ie 3)
-    // R.segment(loadable->GetSubBlockOffset(0) + 3, 3) += c * (this->mass * chrono::Vcross(this->c_m, a_x) + this->I *
-    // a_w).eigen();
-    // since R is a vector, we can probably just do R += C*M*a with no need to separate w into a_x and a_w above
-    R += c * jacobians->M * w;
+    if (!body_blocks) {
+        GroupedResidual_Mv(R, w, c);
+        return;
+    }
+
+    // R+=c*M*w one 6x6 block at a time, directly on each body's segment of R and w (at the loadable's sub block
+    // offset in the system vector): the cost scales with the coupled hydro body pairs, not with the system size
+    const auto& M = jacobians->M;
+    int nBodies   = static_cast<int>(loadables.size());
+    for (int i = 0; i < nBodies; i++) {
+        if (!loadables[i]->IsSubBlockActive(0)) continue;
+        auto R_i = R.segment<6>(loadables[i]->GetSubBlockOffset(0));
+        for (int j = 0; j < nBodies; j++) {
+            if (!nonzero_block[i * nBodies + j] || !loadables[j]->IsSubBlockActive(0)) continue;
+            // fixed size 6x6 kernel, the product is evaluated on the stack
+            R_i.noalias() += c * (M.block<6, 6>(6 * i, 6 * j) * w.segment<6>(loadables[j]->GetSubBlockOffset(0)));
+        }
+    }
+}
+
+/*******************************************************************************
+ * ChLoadAddedMass::GroupedResidual_Mv()
+ * general R += c*M*w for loadables that are not single 6 dof blocks: gathers
+ * w from the loadables' sub blocks, multiplies by the 6N x 6N block, scatters
+ *******************************************************************************/
+void ChLoadAddedMass::GroupedResidual_Mv(ChVectorDynamic<>& R, const ChVectorDynamic<>& w, const double c) {
+    // M only couples the hydro bodies so gather their segments of w (at each loadable's sub block
+    // offset in the system vector), multiply by the 6N x 6N block and scatter the result back into R
+    int ndofw = 0;
+    for (auto& loadable : loadables) {
+        for (unsigned int i = 0; i < loadable->GetSubBlocks(); ++i) {
+            int size = loadable->GetSubBlockSize(i);
+            if (loadable->IsSubBlockActive(i)) {
+                grouped_w.segment(ndofw, size) = w.segment(loadable->GetSubBlockOffset(i), size);
+            } else {
+                grouped_w.segment(ndofw, size).setZero();
+            }
+            ndofw += size;
+        }
+    }
+
+    // noalias() writes the product directly into grouped_Mw, without it Eigen allocates a temporary for each call
+    grouped_Mw.noalias() = c * jacobians->M * grouped_w;
+
+    ndofw = 0;
+    for (auto& loadable : loadables) {
+        for (unsigned int i = 0; i < loadable->GetSubBlocks(); ++i) {
+            int size = loadable->GetSubBlockSize(i);
+            if (loadable->IsSubBlockActive(i)) {
+                R.segment(loadable->GetSubBlockOffset(i), size) += grouped_Mw.segment(ndofw, size);
+            }
+            ndofw += size;
+        }
+    }
 }
\ No newline at end of file
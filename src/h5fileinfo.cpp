@@ -2,6 +2,7 @@
 #include <hydroc/h5fileinfo.h>
 
 #include <filesystem>
+#include <mutex>
 
 //#include <unsupported/Eigen/Splines>
 
@@ -24,6 +25,10 @@ void WriteDataToFile(const std::vector<T>& data, const std::string& filename) {
     }
 }
 
+// The HDF5 C++ library is not thread safe (unless built with --enable-threadsafe, which
+// excludes the C++ API), so every access to it from HydroChrono goes through this lock.
+static std::mutex H5_MUTEX;
+
 // =============================================================================
 // H5FileInfo Class Definitions
 // =============================================================================
@@ -50,8 +55,10 @@ H5FileInfo::H5FileInfo(std::string file, int num_bod) {
  * H5FileInfo::readH5Data()
  * private member function called from constructor
  * calls Initialize functions to read h5 file information into  member variables
+ * serialized process wide, see H5_MUTEX
  *******************************************************************************/
 HydroData H5FileInfo::readH5Data() {
+    std::lock_guard<std::mutex> lock(H5_MUTEX);
     // open file with read only access
     H5::H5File userH5File(h5_file_name, H5F_ACC_RDONLY);
     HydroData data_to_init;
@@ -101,6 +108,40 @@ HydroData H5FileInfo::readH5Data() {
         Init3D(userH5File, bodyName + "/hydro_coeffs/excitation/phase",
                data_to_init.reg_wave_data[i]
                    .excitation_phase_matrix);  // TODO does this also need to be scaled by rho * g?
+        // optional, used when the Froude-Krylov force is integrated over the body mesh
+        std::string scattering_name = bodyName + "/hydro_coeffs/excitation/scattering";
+        if (userH5File.nameExists(bodyName + "/hydro_coeffs/excitation") && userH5File.nameExists(scattering_name)) {
+            Init3D(userH5File, scattering_name + "/mag", data_to_init.reg_wave_data[i].scattering_mag_matrix);
+            data_to_init.reg_wave_data[i].scattering_mag_matrix =
+                data_to_init.reg_wave_data[i].scattering_mag_matrix *
+                data_to_init.reg_wave_data[i].scattering_mag_matrix.constant(rho * g);
+            Init3D(userH5File, scattering_name + "/phase", data_to_init.reg_wave_data[i].scattering_phase_matrix);
+            // bemio fills coefficients the BEM run did not compute with NaN, treat them as absent
+            const auto& mag = data_to_init.reg_wave_data[i].scattering_mag_matrix;
+            if (!Eigen::Map<const Eigen::VectorXd>(mag.data(), mag.size()).allFinite()) {
+                data_to_init.reg_wave_data[i].scattering_mag_matrix   = Eigen::Tensor<double, 3>();
+                data_to_init.reg_wave_data[i].scattering_phase_matrix = Eigen::Tensor<double, 3>();
+            }
+        }
+
+        // optional, second order mean drift (control surface or momentum conservation), heading 0
+        std::string drift_name = bodyName + "/hydro_coeffs/mean_drift";
+        if (userH5File.nameExists(bodyName + "/hydro_coeffs") && userH5File.nameExists(drift_name)) {
+            std::string method = drift_name + "/control_surface";
+            if (!userH5File.nameExists(method)) {
+                method = drift_name + "/momentum_conservation";
+            }
+            if (userH5File.nameExists(method)) {
+                Eigen::Tensor<double, 3> drift;
+                Init3D(userH5File, method + "/val", drift);
+                Eigen::MatrixXd& drift_matrix = data_to_init.reg_wave_data[i].mean_drift_matrix;
+                drift_matrix                  = squeeze_mid(drift) * (rho * g);
+                if (!drift_matrix.allFinite() ||
+                    drift_matrix.cols() != data_to_init.reg_wave_data[i].freq_list.size()) {
+                    drift_matrix.resize(0, 0);
+                }
+            }
+        }
 
         // irreg wave
         // Init3D(userH5File, bodyName + "/hydro_coeffs/excitation/re", excitation_re_matrix, re_dims);
@@ -323,9 +364,9 @@ double HydroData::GetHydrostaticStiffnessVal(int b, int i, int j) const {
 
 /*******************************************************************************
  * HydroData::GetLinMatrix()
- * returns the linear restoring stiffness matrix for body b
+ * returns the linear restoring stiffness matrix for body b (by reference, no copy)
  *******************************************************************************/
-Eigen::MatrixXd HydroData::GetLinMatrix(int b) const {
+const Eigen::MatrixXd& HydroData::GetLinMatrix(int b) const {
     return body_data[b].lin_matrix;
 }
 
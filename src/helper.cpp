@@ -4,13 +4,17 @@
 #include <filesystem>  // C++17
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 using std::filesystem::path;
 
+// process wide, guarded so simulations running on several threads can query it
 static path DATADIR{};
+static std::mutex DATADIR_MUTEX;
 
 int hydroc::setInitialEnvironment(int argc, char* argv[]) noexcept {
+    std::lock_guard<std::mutex> lock(DATADIR_MUTEX);
     const char* env_p = std::getenv("HYDROCHRONO_DATA_DIR");
 
     if (env_p == nullptr) {
@@ -19,7 +23,8 @@ int hydroc::setInitialEnvironment(int argc, char* argv[]) noexcept {
                       << std::endl;
 
             DATADIR = absolute(path("..") / ".." / "demos");
-            std::cerr << "Set default demos path to'" << getDataDir() << "'" << std::endl;
+            std::cerr << "Set default demos path to'" << DATADIR.lexically_normal().generic_string() << "'"
+                      << std::endl;
             return 0;
         } else {
             DATADIR = absolute(path(argv[1]));
@@ -31,5 +36,21 @@ int hydroc::setInitialEnvironment(int argc, char* argv[]) noexcept {
 }
 
 std::string hydroc::getDataDir() noexcept {
+    std::lock_guard<std::mutex> lock(DATADIR_MUTEX);
     return DATADIR.lexically_normal().generic_string();
-}
\ No newline at end of file
+}
+
+// per thread nesting depth of StepScope
+static thread_local int STEP_SCOPE_DEPTH = 0;
+
+hydroc::StepScope::StepScope() noexcept {
+    STEP_SCOPE_DEPTH++;
+}
+
+hydroc::StepScope::~StepScope() {
+    STEP_SCOPE_DEPTH--;
+}
+
+bool hydroc::inStepScope() noexcept {
+    return STEP_SCOPE_DEPTH > 0;
+}
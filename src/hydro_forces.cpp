@@ -1,8 +1,17 @@
 #include "hydroc/hydro_forces.h"
+#include <hydroc/checked.h>
 #include <hydroc/chloadaddedmass.h>
 #include <hydroc/h5fileinfo.h>
+#include <hydroc/helper.h>
+#include <hydroc/hydro_pressure.h>
+#include <hydroc/hydro_solver.h>
+#include <hydroc/mooring.h>
+#include <hydroc/natural_modes.h>
+#include <hydroc/viscous_drag.h>
 #include <hydroc/wave_types.h>
 
+#include <chrono/physics/ChLinkLock.h>
+#include <chrono/physics/ChLinkMate.h>
 #include <chrono/physics/ChLoad.h>
 #include <unsupported/Eigen/Splines>
 
@@ -11,6 +20,7 @@
 #include <memory>
 #include <numeric>  // std::accumulate
 #include <random>
+#include <stdexcept>
 #include <vector>
 
 #ifndef M_PI
@@ -304,14 +314,11 @@ ForceFunc6d::ForceFunc6d(const ForceFunc6d& old)
  * if index is in [0,6] the corresponding vector component of the force vector
  * is returned
  * b_num is 1 indexed!!!!!!!!
- * otherwise a warning is printed and the force is interpreted to be 0
+ * index is only validated in HYDROCHRONO_CHECKED builds (throws std::out_of_range)
  *******************************************************************************/
 double ForceFunc6d::coordinateFunc(int i) {
     // b_num is 1 indexed?
-    if (i >= 6 || i < 0) {
-        std::cout << "wrong index force func 6d" << std::endl;
-        return 0;
-    }
+    HYDROC_CHECK_INDEX(i >= 0 && i < 6, "ForceFunc6d::coordinateFunc");
     return all_hydro_forces->coordinateFunc(b_num, i);
 }
 
@@ -355,6 +362,105 @@ void ForceFunc6d::ApplyForceAndTorqueToBody() {
     body->AddForce(chrono_torque);
 }
 
+// =============================================================================
+// HydroBodyStates Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * HydroBodyStates::resize(num_bodies)
+ * sizes the state arrays for num_bodies bodies and fills them with 0s
+ *******************************************************************************/
+void HydroBodyStates::resize(int num_bodies) {
+    position.setZero(3 * num_bodies);
+    rotation.setZero(3 * num_bodies);
+    velocity.setZero(6 * num_bodies);
+    acceleration.setZero(6 * num_bodies);
+    orientation.assign(num_bodies, Eigen::Matrix3d::Identity());
+}
+
+// =============================================================================
+// HydroComponentRate Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * HydroComponentRate::Resize(total_dofs)
+ * sizes the stored force samples, called once so updates never allocate
+ *******************************************************************************/
+void HydroComponentRate::Resize(int total_dofs) {
+    force_last.setZero(total_dofs);
+    force_before.setZero(total_dofs);
+    num_stored = 0;
+}
+
+/*******************************************************************************
+ * HydroComponentRate::SetEverySteps(steps, extrapolate)
+ * recompute every steps time steps (1 = every step, the default)
+ *******************************************************************************/
+void HydroComponentRate::SetEverySteps(int steps, bool extrapolate) {
+    if (steps < 1) {
+        throw std::invalid_argument("HydroComponentRate: update every " + std::to_string(steps) + " steps");
+    }
+    every_steps       = steps;
+    interval          = 0.0;
+    this->extrapolate = extrapolate;
+}
+
+/*******************************************************************************
+ * HydroComponentRate::SetInterval(hydro_dt, extrapolate)
+ * recompute once at least hydro_dt seconds have passed since the last update
+ *******************************************************************************/
+void HydroComponentRate::SetInterval(double hydro_dt, bool extrapolate) {
+    if (!(hydro_dt > 0.0)) {
+        throw std::invalid_argument("HydroComponentRate: update interval must be positive");
+    }
+    every_steps       = 0;
+    interval          = hydro_dt;
+    this->extrapolate = extrapolate;
+}
+
+/*******************************************************************************
+ * HydroComponentRate::IsDue(t)
+ * counts time steps and decides if the component is recomputed at time t
+ * always due before the first update and if time went backwards
+ *******************************************************************************/
+bool HydroComponentRate::IsDue(double t) {
+    steps_since++;
+    if (num_stored == 0 || t < time_last) {
+        return true;
+    }
+    if (every_steps > 0) {
+        return steps_since >= every_steps;
+    }
+    // small relative tolerance so accumulated round off in t does not delay an update by one step
+    return t - time_last >= interval * (1.0 - 1e-9);
+}
+
+/*******************************************************************************
+ * HydroComponentRate::Store(t, force)
+ * keeps the last two computed values for holding / extrapolation
+ *******************************************************************************/
+void HydroComponentRate::Store(double t, const Eigen::Ref<const Eigen::VectorXd>& force) {
+    force_before.swap(force_last);
+    force_last  = force;
+    time_before = time_last;
+    time_last   = t;
+    num_stored  = std::min(num_stored + 1, 2);
+    steps_since = 0;
+}
+
+/*******************************************************************************
+ * HydroComponentRate::Predict(t, force)
+ * holds the last value, or extrapolates linearly when enabled and two values exist
+ *******************************************************************************/
+void HydroComponentRate::Predict(double t, Eigen::Ref<Eigen::VectorXd> force) const {
+    if (extrapolate && num_stored == 2 && time_last > time_before) {
+        double s = (t - time_last) / (time_last - time_before);
+        force.noalias() = force_last + s * (force_last - force_before);
+    } else {
+        force = force_last;
+    }
+}
+
 // =============================================================================
 // TestHydro Class Definitions
 // =============================================================================
@@ -378,13 +484,24 @@ TestHydro::TestHydro(std::vector<std::shared_ptr<ChBody>> user_bodies,
 
     // simplify 6* num_bodies to be the system's total number of dofs, makes expressions later easier to read
     int total_dofs = 6 * num_bodies;
-    // resize and initialize velocity history vector to all zeros
-    velocity_history.resize(file_info.GetRIRFDims(2) * total_dofs, 0.0);  // resize and fill with 0s
+    // all dofs active: radiation kernel and velocity history (zeroed) of all 6N dofs
+    dof_active.assign(total_dofs, 1);
+    SetUpActiveDofs();
     // resize and initialize all persistent forces to all 0s
     // TODO rephrase for Eigen::VectorXd eventually
     force_hydrostatic.resize(total_dofs, 0.0);
     force_radiation_damping.resize(total_dofs, 0.0);
     total_force.resize(total_dofs, 0.0);
+    force_drag.setZero(total_dofs);
+    force_mooring.setZero(total_dofs);
+    force_drift.setZero(total_dofs);
+    drift_omegas.resize(num_bodies);
+    drift_coefficients.resize(num_bodies);
+    drag = std::make_unique<ViscousDrag>(num_bodies, file_info.GetRhoVal());
+    body_states.resize(num_bodies);
+    for (auto& rate : component_rates) {
+        rate.Resize(total_dofs);
+    }
     // set up equilibrium for entire system (each body has position and rotation equilibria 3 indicies apart)
     equilibrium.resize(total_dofs, 0.0);
     cb_minus_cg.resize(3 * num_bodies, 0.0);  // cb-cg has 3 components for each body
@@ -424,16 +541,509 @@ TestHydro::TestHydro(std::vector<std::shared_ptr<ChBody>> user_bodies,
     AddWaves(user_waves);
 }
 
+// defined here, where HydroPressureMesh is complete
+TestHydro::~TestHydro() = default;
+
 void TestHydro::AddWaves(std::shared_ptr<WaveBase> waves) {
     user_waves = waves;
+    force_waves.setZero(6 * num_bodies);
+    // the excitation coefficients of the inactive dofs are zeroed (SetActiveDofs)
+    std::vector<HydroData::RegularWaveInfo> reg_info     = file_info.GetRegularWaveInfos();
+    std::vector<HydroData::IrregularWaveInfo> irreg_info = file_info.GetIrregularWaveInfos();
+    for (int b = 0; b < num_bodies; b++) {
+        for (int dof = 0; dof < 6; dof++) {
+            if (dof_active[6 * b + dof]) {
+                continue;
+            }
+            for (auto* matrix : {&reg_info[b].excitation_mag_matrix, &reg_info[b].scattering_mag_matrix}) {
+                if (matrix->size() != 0) {
+                    matrix->chip(dof, 0).setZero();
+                }
+            }
+            irreg_info[b].excitation_irf_matrix.row(dof).setZero();
+        }
+    }
     if (user_waves->GetWaveMode() == WaveMode::regular) {
         std::shared_ptr<RegularWave> reg = std::static_pointer_cast<RegularWave>(user_waves);
-        reg->AddH5Data(file_info.GetRegularWaveInfos());
+        reg->AddH5Data(reg_info, file_info.GetSimulationInfo());
+        // the Froude-Krylov part comes from the mesh pressure integration
+        reg->scattering_excitation_only = nonlinear_incident_pressure;
+    } else if (user_waves->GetWaveMode() == WaveMode::polychromatic) {
+        std::shared_ptr<PolychromaticWave> poly = std::static_pointer_cast<PolychromaticWave>(user_waves);
+        poly->AddH5Data(reg_info, file_info.GetSimulationInfo());
+        poly->scattering_excitation_only = nonlinear_incident_pressure;
     } else if (user_waves->GetWaveMode() == WaveMode::irregular) {
+        if (nonlinear_incident_pressure) {
+            throw std::invalid_argument(
+                "TestHydro: the nonlinear incident wave pressure is only available with regular waves");
+        }
         std::shared_ptr<IrregularWave> irreg = std::static_pointer_cast<IrregularWave>(user_waves);
-        irreg->AddH5Data(file_info.GetIrregularWaveInfos(), file_info.GetSimulationInfo());
+        irreg->AddH5Data(irreg_info, file_info.GetSimulationInfo());
     }
     user_waves->Initialize();
+    wave_dof_active = dof_active;
+    SetUpMeanDrift();
+}
+
+/*******************************************************************************
+ * TestHydro::EnableNonlinearFroudeKrylov(mesh_files, incident_pressure)
+ * loads one pressure mesh per body (empty name: the body keeps the linear
+ * hydrostatics) and re-initializes the waves for the excitation split
+ *******************************************************************************/
+void TestHydro::EnableNonlinearFroudeKrylov(const std::vector<std::string>& mesh_files, bool incident_pressure) {
+    if (mesh_files.size() != static_cast<size_t>(num_bodies)) {
+        throw std::invalid_argument("TestHydro::EnableNonlinearFroudeKrylov: expected one mesh file per body");
+    }
+    pressure_meshes.clear();
+    pressure_meshes.resize(num_bodies);
+    for (int b = 0; b < num_bodies; b++) {
+        if (!mesh_files[b].empty()) {
+            pressure_meshes[b] = std::make_unique<HydroPressureMesh>(mesh_files[b]);
+        }
+    }
+    nonlinear_incident_pressure = incident_pressure;
+    AddWaves(user_waves);
+}
+
+/*******************************************************************************
+ * TestHydro::SetHydrostaticTables(tables)
+ *******************************************************************************/
+void TestHydro::SetHydrostaticTables(const std::vector<std::shared_ptr<HydrostaticTable>>& tables) {
+    if (tables.size() != static_cast<size_t>(num_bodies)) {
+        throw std::invalid_argument("TestHydro::SetHydrostaticTables: expected one table per body");
+    }
+    hydrostatic_tables = tables;
+}
+
+/*******************************************************************************
+ * TestHydro::BuildHydrostaticTables(mesh_files, table_files, heave_offsets,
+ *                                   roll_angles, pitch_angles)
+ * tables on disk are reused as they are: delete them after changing the mesh
+ * or the grid
+ *******************************************************************************/
+void TestHydro::BuildHydrostaticTables(const std::vector<std::string>& mesh_files,
+                                       const std::vector<std::string>& table_files,
+                                       const Eigen::VectorXd& heave_offsets,
+                                       const Eigen::VectorXd& roll_angles,
+                                       const Eigen::VectorXd& pitch_angles) {
+    if (mesh_files.size() != static_cast<size_t>(num_bodies) || table_files.size() != mesh_files.size()) {
+        throw std::invalid_argument("TestHydro::BuildHydrostaticTables: expected one mesh and table file per body");
+    }
+    double rho = file_info.GetRhoVal();
+    double gg  = bodies[0]->GetSystem()->Get_G_acc().Length();
+    std::vector<std::shared_ptr<HydrostaticTable>> tables(num_bodies);
+    for (int b = 0; b < num_bodies; b++) {
+        if (mesh_files[b].empty()) {
+            continue;
+        }
+        if (!table_files[b].empty() && std::filesystem::exists(table_files[b])) {
+            tables[b] = std::make_shared<HydrostaticTable>(table_files[b]);
+            continue;
+        }
+        HydroPressureMesh mesh(mesh_files[b]);
+        Eigen::VectorXd heights = heave_offsets.array() + equilibrium[6 * b + 2];
+        tables[b]               = std::make_shared<HydrostaticTable>(mesh, heights, roll_angles, pitch_angles, rho, gg);
+        if (!table_files[b].empty()) {
+            tables[b]->Save(table_files[b]);
+        }
+    }
+    SetHydrostaticTables(tables);
+}
+
+/*******************************************************************************
+ * TestHydro::SetQuadraticDrag(b, body_drag)
+ *******************************************************************************/
+void TestHydro::SetQuadraticDrag(int b, const Eigen::Matrix<double, 6, 6>& body_drag) {
+    drag->SetQuadraticDrag(b, body_drag);
+}
+
+/*******************************************************************************
+ * TestHydro::AddMorisonElement(b, position, axis, drag_coefficient, area)
+ *******************************************************************************/
+void TestHydro::AddMorisonElement(int b,
+                                  const Eigen::Vector3d& position,
+                                  const Eigen::Vector3d& axis,
+                                  double drag_coefficient,
+                                  double area) {
+    drag->AddMorisonElement(b, position, axis, drag_coefficient, area);
+}
+
+/*******************************************************************************
+ * TestHydro::AddMooring(mooring)
+ *******************************************************************************/
+void TestHydro::AddMooring(std::shared_ptr<MooringBase> mooring) {
+    if (!mooring) {
+        throw std::invalid_argument("TestHydro::AddMooring: null mooring");
+    }
+    GatherBodyStates();
+    mooring->Initialize(body_states);
+    moorings.push_back(mooring);
+}
+
+/*******************************************************************************
+ * TestHydro::EnableMeanDrift()
+ *******************************************************************************/
+void TestHydro::EnableMeanDrift() {
+    bool found = false;
+    for (int b = 0; b < num_bodies; b++) {
+        const HydroData::RegularWaveInfo& info = file_info.GetRegularWaveInfos()[b];
+        if (info.mean_drift_matrix.size() != 0) {
+            drift_omegas[b]       = info.freq_list;
+            drift_coefficients[b] = info.mean_drift_matrix;
+            found                 = true;
+        }
+    }
+    if (!found) {
+        throw std::runtime_error("TestHydro::EnableMeanDrift: the h5 file has no mean drift coefficients");
+    }
+    SetUpMeanDrift();
+}
+
+/*******************************************************************************
+ * TestHydro::SetMeanDriftCoefficients(b, omegas, drift)
+ *******************************************************************************/
+void TestHydro::SetMeanDriftCoefficients(int b, const Eigen::VectorXd& omegas, const Eigen::MatrixXd& drift) {
+    if (b < 0 || b >= num_bodies) {
+        throw std::invalid_argument("TestHydro::SetMeanDriftCoefficients: body index out of range");
+    }
+    if (drift.rows() != 6 || drift.cols() != omegas.size()) {
+        throw std::invalid_argument("TestHydro::SetMeanDriftCoefficients: drift must be 6 x omegas.size()");
+    }
+    drift_omegas[b]       = omegas;
+    drift_coefficients[b] = drift;
+    SetUpMeanDrift();
+}
+
+/*******************************************************************************
+ * TestHydro::SetUpMeanDrift()
+ * (re)builds the drift tables for the current waves' components, called when
+ * the waves or the coefficients change
+ *******************************************************************************/
+void TestHydro::SetUpMeanDrift() {
+    mean_drift.reset();
+    bool any = false;
+    for (const auto& drift : drift_coefficients) {
+        any = any || drift.size() != 0;
+    }
+    Eigen::VectorXd omegas, amplitudes, phases;
+    user_waves->GetWaveComponents(omegas, amplitudes, phases);
+    if (any && omegas.size() != 0) {
+        mean_drift = std::make_unique<NewmanDriftForce>(omegas, amplitudes, phases, drift_omegas, drift_coefficients);
+    }
+}
+
+/*******************************************************************************
+ * TestHydro::SetActiveDofs(b, active)
+ *******************************************************************************/
+void TestHydro::SetActiveDofs(int b, const std::array<bool, 6>& active) {
+    if (b < 0 || b >= num_bodies) {
+        throw std::invalid_argument("TestHydro::SetActiveDofs: body index out of range");
+    }
+    for (int dof = 0; dof < 6; dof++) {
+        dof_active[6 * b + dof] = active[dof];
+    }
+    SetUpActiveDofs();
+}
+
+/*******************************************************************************
+ * TestHydro::GetActiveDofs(b)
+ *******************************************************************************/
+std::array<bool, 6> TestHydro::GetActiveDofs(int b) const {
+    if (b < 0 || b >= num_bodies) {
+        throw std::invalid_argument("TestHydro::GetActiveDofs: body index out of range");
+    }
+    std::array<bool, 6> active;
+    for (int dof = 0; dof < 6; dof++) {
+        active[dof] = dof_active[6 * b + dof];
+    }
+    return active;
+}
+
+/*******************************************************************************
+ * TestHydro::DetectActiveDofs()
+ * each joint to a fixed body leaves a superset of the dofs the body can move in,
+ * several joints leave the intersection. A joint axis along a world axis gives
+ * one dof (plus the translations of a revolute away from the center of gravity)
+ *******************************************************************************/
+void TestHydro::DetectActiveDofs() {
+    ChSystem* system = bodies[0]->GetSystem();
+    const double eps = 1e-9;
+
+    auto hydro_index = [this](ChBodyFrame* frame) {
+        for (int b = 0; b < num_bodies; b++) {
+            if (static_cast<ChBodyFrame*>(bodies[b].get()) == frame) {
+                return b;
+            }
+        }
+        return -1;
+    };
+    // fixed bodies, then bodies welded to them (in any order of the link list)
+    std::vector<ChBodyFrame*> fixed;
+    for (const auto& body : system->Get_bodylist()) {
+        if (body->GetBodyFixed()) {
+            fixed.push_back(body.get());
+        }
+    }
+    for (const auto& body : bodies) {
+        if (body->GetBodyFixed()) {
+            fixed.push_back(body.get());
+        }
+    }
+    auto is_fixed = [&fixed](ChBodyFrame* frame) {
+        return frame && std::find(fixed.begin(), fixed.end(), frame) != fixed.end();
+    };
+    bool added = true;
+    while (added) {
+        added = false;
+        for (const auto& link : system->Get_linklist()) {
+            auto weld = std::dynamic_pointer_cast<ChLinkMateGeneric>(link);
+            if (!weld || !(weld->IsConstrainedX() && weld->IsConstrainedY() && weld->IsConstrainedZ() &&
+                           weld->IsConstrainedRx() && weld->IsConstrainedRy() && weld->IsConstrainedRz())) {
+                continue;
+            }
+            if (is_fixed(weld->GetBody1()) != is_fixed(weld->GetBody2())) {
+                fixed.push_back(is_fixed(weld->GetBody1()) ? weld->GetBody2() : weld->GetBody1());
+                added = true;
+            }
+        }
+    }
+
+    std::vector<std::array<bool, 6>> detected(num_bodies);
+    std::vector<char> found(num_bodies, 0);
+    for (int b = 0; b < num_bodies; b++) {
+        detected[b].fill(true);
+        if (is_fixed(bodies[b].get())) {
+            detected[b].fill(false);
+            found[b] = 1;
+        }
+    }
+    for (const auto& link : system->Get_linklist()) {
+        auto prismatic = std::dynamic_pointer_cast<ChLinkLockPrismatic>(link);
+        auto revolute  = std::dynamic_pointer_cast<ChLinkLockRevolute>(link);
+        if (!prismatic && !revolute) {
+            continue;
+        }
+        auto joint = std::static_pointer_cast<ChLinkLock>(link);
+        int b      = -1;
+        if (is_fixed(joint->GetBody2())) {
+            b = hydro_index(joint->GetBody1());
+        } else if (is_fixed(joint->GetBody1())) {
+            b = hydro_index(joint->GetBody2());
+        }
+        if (b < 0 || is_fixed(bodies[b].get())) {
+            continue;
+        }
+        // both joints move along / about the z axis of the link frame
+        ChCoordsys<> frame = joint->GetLinkAbsoluteCoords();
+        ChVector<> axis    = frame.rot.GetZaxis();
+        std::array<bool, 6> free;
+        for (int i = 0; i < 3; i++) {
+            bool along = std::abs(axis[i]) > eps;
+            if (prismatic) {
+                free[i]     = along;
+                free[i + 3] = false;
+            } else {
+                free[i]     = std::abs(axis[i]) < 1.0 - eps;  // the center of gravity moves normal to the axis
+                free[i + 3] = along;
+            }
+        }
+        if (revolute) {
+            ChVector<> arm = bodies[b]->GetPos() - frame.pos;
+            if ((arm - axis * (arm ^ axis)).Length() < eps * std::max(1.0, arm.Length())) {
+                free[0] = free[1] = free[2] = false;
+            }
+        }
+        for (int dof = 0; dof < 6; dof++) {
+            detected[b][dof] = detected[b][dof] && free[dof];
+        }
+        found[b] = 1;
+    }
+
+    for (int b = 0; b < num_bodies; b++) {
+        if (found[b]) {
+            for (int dof = 0; dof < 6; dof++) {
+                dof_active[6 * b + dof] = detected[b][dof];
+            }
+        }
+    }
+    SetUpActiveDofs();
+}
+
+/*******************************************************************************
+ * TestHydro::ComputeNaturalModes(tolerance, max_iterations)
+ * rigid body mass matrix of the bodies at their current orientation (world
+ * frame, about the center of gravity), analysed over the active dofs
+ *******************************************************************************/
+std::vector<NaturalMode> TestHydro::ComputeNaturalModes(double tolerance, int max_iterations) const {
+    Eigen::MatrixXd mass = Eigen::MatrixXd::Zero(6 * num_bodies, 6 * num_bodies);
+    for (int b = 0; b < num_bodies; b++) {
+        double body_mass        = bodies[b]->GetMass();
+        Eigen::Matrix3d inertia = bodies[b]->GetInertia();
+        if (added_mass_in_inertia) {
+            body_mass -= folded_added_mass[b];
+            inertia -= folded_added_inertia[b];
+        }
+        Eigen::Matrix3d R = bodies[b]->GetA();  // body to world rotation
+        mass.block<3, 3>(6 * b, 6 * b).diagonal().setConstant(body_mass);
+        mass.block<3, 3>(6 * b + 3, 6 * b + 3) = R * inertia * R.transpose();
+    }
+    return NaturalModeAnalysis(file_info, mass, active_dofs).Solve(tolerance, max_iterations);
+}
+
+/*******************************************************************************
+ * TestHydro::SetUpActiveDofs()
+ * gathers the RIRF between the active dofs into the radiation kernel, clears the
+ * velocity history and passes the mask to the added mass load and the waves
+ * (in place, the waves are only set up again when a dof is switched back on)
+ *******************************************************************************/
+void TestHydro::SetUpActiveDofs() {
+    active_dofs.clear();
+    for (int i = 0; i < 6 * num_bodies; i++) {
+        if (dof_active[i]) {
+            active_dofs.push_back(i);
+        }
+    }
+    int n    = static_cast<int>(active_dofs.size());
+    int size = file_info.GetRIRFDims(2);
+    rirf_active.resize(n, n * size);
+    for (int st = 0; st < size; st++) {
+        for (int col = 0; col < n; col++) {
+            for (int row = 0; row < n; row++) {
+                rirf_active(row, st * n + col) = GetRIRFval(active_dofs[row], active_dofs[col], st);
+            }
+        }
+    }
+    velocity_history.assign(static_cast<size_t>(n) * size, 0.0);
+    radiation_integrand.setZero(n);
+    radiation_integrand_prev.setZero(n);
+    radiation_sum.setZero(n);
+
+    if (my_loadbodyinertia) {
+        my_loadbodyinertia->SetActiveDofs(dof_active);
+    }
+    if (user_waves) {
+        // a dof switched back on needs its excitation recomputed, masking more dofs only zeroes their rows
+        bool reactivated = false;
+        for (int i = 0; i < 6 * num_bodies; i++) {
+            reactivated = reactivated || (dof_active[i] && !wave_dof_active[i]);
+        }
+        if (reactivated) {
+            AddWaves(user_waves);
+        } else {
+            user_waves->MaskExcitationDofs(dof_active);
+            wave_dof_active = dof_active;
+        }
+    }
+}
+
+/*******************************************************************************
+ * TestHydro::SetUpdateEverySteps(component, steps, extrapolate)
+ * recompute component only every steps time steps, held (or linearly
+ * extrapolated) in between
+ *******************************************************************************/
+void TestHydro::SetUpdateEverySteps(HydroComponent component, int steps, bool extrapolate) {
+    component_rates[static_cast<int>(component)].SetEverySteps(steps, extrapolate);
+}
+
+/*******************************************************************************
+ * TestHydro::SetUpdateInterval(component, hydro_dt, extrapolate)
+ * recompute component at its own time step hydro_dt, held (or linearly
+ * extrapolated) in between
+ *******************************************************************************/
+void TestHydro::SetUpdateInterval(HydroComponent component, double hydro_dt, bool extrapolate) {
+    component_rates[static_cast<int>(component)].SetInterval(hydro_dt, extrapolate);
+}
+
+/*******************************************************************************
+ * TestHydro::EnableAddedMassInertiaAugmentation(max_coupling_ratio)
+ * moves the infinite frequency added mass from the ChLoadAddedMass load into
+ * the bodies' own mass / inertia, the rest becomes an explicit force
+ * (ComputeForceAddedMassCorrection), checks that the rest is small enough
+ *******************************************************************************/
+void TestHydro::EnableAddedMassInertiaAugmentation(double max_coupling_ratio) {
+    if (added_mass_in_inertia) {
+        return;
+    }
+    int total_dofs = 6 * num_bodies;
+    infinite_added_mass.resize(total_dofs, total_dofs);
+    for (int b = 0; b < num_bodies; b++) {
+        infinite_added_mass.middleRows(6 * b, 6) = file_info.GetInfAddedMassMatrix(b);
+    }
+
+    // what the bodies will carry themselves, in the world frame at the current orientation
+    Eigen::MatrixXd folded = Eigen::MatrixXd::Zero(total_dofs, total_dofs);
+    Eigen::VectorXd augmented_diagonal(total_dofs);
+    folded_added_mass.resize(num_bodies);
+    folded_added_inertia.resize(num_bodies);
+    for (int b = 0; b < num_bodies; b++) {
+        auto A_tt = infinite_added_mass.block<3, 3>(6 * b, 6 * b);
+        auto A_rr = infinite_added_mass.block<3, 3>(6 * b + 3, 6 * b + 3);
+        Eigen::Matrix3d R = bodies[b]->GetA();  // body to world rotation
+        folded_added_mass[b]    = A_tt.trace() / 3.0;
+        folded_added_inertia[b] = R.transpose() * A_rr * R;
+
+        folded.block<3, 3>(6 * b, 6 * b).diagonal().setConstant(folded_added_mass[b]);
+        folded.block<3, 3>(6 * b + 3, 6 * b + 3) = A_rr;
+
+        Eigen::Matrix3d inertia = bodies[b]->GetInertia();
+        augmented_diagonal.segment<3>(6 * b).setConstant(bodies[b]->GetMass() + folded_added_mass[b]);
+        augmented_diagonal.segment<3>(6 * b + 3) = (inertia + folded_added_inertia[b]).diagonal();
+    }
+
+    double coupling_ratio = 0.0;
+    for (int i = 0; i < total_dofs; i++) {
+        double row_sum = (infinite_added_mass.row(i) - folded.row(i)).cwiseAbs().sum();
+        coupling_ratio = std::max(coupling_ratio, row_sum / augmented_diagonal[i]);
+    }
+    if (coupling_ratio > 1.0) {
+        throw std::runtime_error("TestHydro::EnableAddedMassInertiaAugmentation: added mass coupling ratio " +
+                                 std::to_string(coupling_ratio) +
+                                 " is too large to be applied explicitly, keep the added mass load");
+    }
+    if (coupling_ratio > max_coupling_ratio) {
+        std::cerr << "Warning: added mass coupling ratio " << coupling_ratio << " exceeds " << max_coupling_ratio
+                  << ", the explicit added mass correction may be inaccurate or unstable" << std::endl;
+    }
+
+    // fold into the bodies and drop the stiff load
+    for (int b = 0; b < num_bodies; b++) {
+        bodies[b]->SetMass(bodies[b]->GetMass() + folded_added_mass[b]);
+        chrono::ChMatrix33<> inertia = bodies[b]->GetInertia();
+        inertia += folded_added_inertia[b];
+        bodies[b]->SetInertia(inertia);
+    }
+    bodies[0]->GetSystem()->RemoveOtherPhysicsItem(my_loadcontainer);
+
+    force_added_mass.setZero(total_dofs);
+    added_mass_in_inertia = true;
+}
+
+/*******************************************************************************
+ * TestHydro::HasFixedSparsityPattern()
+ * the forces only touch the right hand side, the added mass load (if not folded
+ * into the bodies' inertia) is a constant block
+ *******************************************************************************/
+bool TestHydro::HasFixedSparsityPattern() const {
+    return added_mass_in_inertia || my_loadbodyinertia->HasFixedSparsityPattern();
+}
+
+/*******************************************************************************
+ * TestHydro::EnableSymbolicReuse()
+ * locks the sparsity pattern of the system's direct solver, the caller declares
+ * that nothing else in the system (contacts, links added later) changes it. The
+ * solver object and its settings are the user's: the pattern learner still runs
+ * on the first, unlocked, setup. With ChSolverHydroSparseLU / QR the symbolic
+ * factorization is then done once per run
+ *******************************************************************************/
+void TestHydro::EnableSymbolicReuse() {
+    auto direct_solver = std::dynamic_pointer_cast<ChDirectSolverLS>(bodies[0]->GetSystem()->GetSolver());
+    if (!direct_solver) {
+        throw std::runtime_error("EnableSymbolicReuse: the system does not use a sparse direct solver");
+    }
+    if (!HasFixedSparsityPattern()) {
+        throw std::runtime_error("EnableSymbolicReuse: the hydro contributions to the system matrix change pattern");
+    }
+    direct_solver->LockSparsityPattern(true);
 }
 
 // void TestHydro::WaveSetUp() {
@@ -466,77 +1076,105 @@ void TestHydro::AddWaves(std::shared_ptr<WaveBase> waves) {
 
 /*******************************************************************************
  * TestHydro::getVelHistoryVal(int step, int c) const
- * finds and returns the component of velocity history for given step and dof (c - column)
+ * finds and returns the component of velocity history for given step and active dof c
  * step: [0,1,...,1000] (timesteps from h5 file, one velocity per step
- * c: [0,..,num_bodies-1,...,numbodies*6-1] (in order of bodies, iterates over
- *    dof for each body...3 bodies c would be [0,1,...,17])
+ * c: [0,...,n-1] position in active_dofs (all dofs active: c = dof + 6 * b)
  *******************************************************************************/
 double TestHydro::getVelHistoryVal(int step, int c) const {
-    if (step < 0 || step >= file_info.GetRIRFDims(2) || c < 0 || c >= num_bodies * 6) {
-        std::cout << "wrong vel history index " << std::endl;
-        return 0;
-    }
-    int index = c % 6;
-    int b     = c / 6;  // 0 indexed
-    if (index + 6 * b + 6 * num_bodies * step >= num_bodies * 6 * file_info.GetRIRFDims(2) ||
-        index + 6 * b + 6 * num_bodies * step < 0) {
-        std::cout << "bad vel history math" << std::endl;
-        return 0;
-    }
-    return velocity_history[index + (6 * b) + (6 * num_bodies * step)];
+    int n = static_cast<int>(active_dofs.size());
+    HYDROC_CHECK_INDEX(step >= 0 && step < file_info.GetRIRFDims(2), "TestHydro::getVelHistoryVal");
+    HYDROC_CHECK_INDEX(c >= 0 && c < n, "TestHydro::getVelHistoryVal");
+    // velocity_history rows hold the n active dofs of one step
+    return velocity_history[c + (n * step)];
 }
 
 /*******************************************************************************
- * TestHydro::setVelHistoryAllBodies(double val, int step, int b_num, int index)
- * sets velocity history for step, b_num (body number) and index (dof) to the given val
+ * TestHydro::setVelHistory(double val, int step, int c)
+ * sets velocity history for step and active dof c to the given val
  * val: value to set the requested element to
  * step: [0,1,...,1000] (0 indexed, up to the final timestep in h5 file)
- * b_num: [1,2,...,total_bodies] (1 indexed!, use body number in h5 file)
- * index: [0,1,2,3,4,5] (0 indexed, always 0-5 for force+torque vector indexing)
+ * c: [0,...,n-1] position in active_dofs
  *******************************************************************************/
-double TestHydro::setVelHistory(double val, int step, int b_num, int index) {
-    if (step < 0 || step >= file_info.GetRIRFDims(2) || b_num < 1 || b_num > num_bodies || index < 0 || index >= 6) {
-        std::cout << "bad set vel history indexing" << std::endl;
-        return 0;
-    }
-    if (index + 6 * (b_num - 1) + 6 * num_bodies * step < 0 ||
-        index + 6 * (b_num - 1) + 6 * num_bodies * step >= num_bodies * 6 * file_info.GetRIRFDims(2)) {
-        std::cout << "bad set vel history math" << std::endl;
-        return 0;
-    }
-    velocity_history[index + (6 * (b_num - 1)) + (6 * num_bodies * step)] = val;
+double TestHydro::setVelHistory(double val, int step, int c) {
+    int n = static_cast<int>(active_dofs.size());
+    HYDROC_CHECK_INDEX(step >= 0 && step < file_info.GetRIRFDims(2), "TestHydro::setVelHistory");
+    HYDROC_CHECK_INDEX(c >= 0 && c < n, "TestHydro::setVelHistory");
+    velocity_history[c + (n * step)] = val;
     return val;
 }
 
+/*******************************************************************************
+ * TestHydro::GatherBodyStates()
+ * copies position, orientation and velocity of every hydro body into the
+ * contiguous body_states arrays, called once per time step before any force
+ * is computed so the force functions never go back to the ChBody objects
+ *******************************************************************************/
+void TestHydro::GatherBodyStates() {
+    for (int b = 0; b < num_bodies; b++) {
+        const auto& body            = bodies[b];
+        const chrono::ChVector<>& p = body->GetPos();
+        chrono::ChVector<> r        = body->GetRot().Q_to_Euler123();
+        const chrono::ChVector<>& v = body->GetPos_dt();
+        const chrono::ChVector<>& w = body->GetWvel_par();
+        const chrono::ChVector<>& a = body->GetPos_dtdt();
+        const chrono::ChVector<>& o = body->GetWacc_par();
+        for (int i = 0; i < 3; i++) {
+            body_states.position[3 * b + i]         = p[i];
+            body_states.rotation[3 * b + i]         = r[i];
+            body_states.velocity[6 * b + i]         = v[i];
+            body_states.velocity[6 * b + i + 3]     = w[i];
+            body_states.acceleration[6 * b + i]     = a[i];
+            body_states.acceleration[6 * b + i + 3] = o[i];
+        }
+        body_states.orientation[b] = body->GetA();
+    }
+}
+
 /*******************************************************************************
  * TestHydro::ComputeForceHydrostatics()
  * computes the 6N dimensional Hydrostatic stiffness force
  *******************************************************************************/
-std::vector<double> TestHydro::ComputeForceHydrostatics() {
+const std::vector<double>& TestHydro::ComputeForceHydrostatics() {
     assert(num_bodies > 0);
 
+    // system wide constants, the same for each body
+    double rho               = file_info.GetRhoVal();
+    chrono::ChVector<> g_acc = bodies[0]->GetSystem()->Get_G_acc();
+    double gg                = g_acc.Length();
+
     for (int b = 0; b < num_bodies; b++) {
+        if (b < static_cast<int>(pressure_meshes.size()) && pressure_meshes[b]) {
+            ComputeForceNonlinearPressure(b);
+            continue;
+        }
+        if (b < static_cast<int>(hydrostatic_tables.size()) && hydrostatic_tables[b]) {
+            Eigen::Vector3d position(body_states.position[3 * b], body_states.position[3 * b + 1],
+                                     body_states.position[3 * b + 2]);
+            Eigen::Matrix<double, 6, 1> force;
+            hydrostatic_tables[b]->Interpolate(position, body_states.orientation[b], force);
+            for (int dof = 0; dof < 6; dof++) {
+                force_hydrostatic[6 * b + dof] += force[dof];
+            }
+            continue;
+        }
         // initialize variables
-        std::shared_ptr<chrono::ChBody> body = bodies[b];
         // H5FileInfo& body_h5file              = file_info[b];
-        double rho   = file_info.GetRhoVal();
         int b_offset = 6 * b;
+        int p_offset = 3 * b;
         // force_hydrostatic has 6 elements for each body so to skip to the next body we move 6 spaces
         double* body_force_hydrostatic = &force_hydrostatic[b_offset];
         double* body_equilibrium       = &equilibrium[b_offset];
-        double gg                      = body->GetSystem()->Get_G_acc().Length();
 
         // hydrostatic stiffness due to offset from equilibrium
-        chrono::ChVector<> body_position = body->GetPos();
-        chrono::ChVector<> body_rotation = body->GetRot().Q_to_Euler123();
-        // calculate displacement
+        // calculate displacement from the gathered body states
         chrono::ChVectorN<double, 6> body_displacement;
         for (int ii = 0; ii < 3; ii++) {
-            body_displacement[ii]     = body_position[ii] - body_equilibrium[ii];
-            body_displacement[ii + 3] = body_rotation[ii] - body_equilibrium[ii + 3];
+            body_displacement[ii]     = body_states.position[p_offset + ii] - body_equilibrium[ii];
+            body_displacement[ii + 3] = body_states.rotation[p_offset + ii] - body_equilibrium[ii + 3];
         }
         // calculate force
-        chrono::ChVectorN<double, 6> force_offset = -gg * rho * file_info.GetLinMatrix(b) * body_displacement;
+        chrono::ChVectorN<double, 6> force_offset;
+        force_offset.noalias() = (-gg * rho) * file_info.GetLinMatrix(b) * body_displacement;
         // add to force_hydrostatic
         for (int dof = 0; dof < 6; dof++) {
             body_force_hydrostatic[dof] += force_offset[dof];
@@ -545,8 +1183,7 @@ std::vector<double> TestHydro::ComputeForceHydrostatics() {
         // buoyancy at equilibrium
         // TODO: move to prestep (shouldn't be calculated at each time step)
         // translational
-        chrono::ChVector<> buoyancy =
-            rho * (-body->GetSystem()->Get_G_acc()) * file_info.GetDispVolVal(b);  // buoyancy = rho*g*Vdisp
+        chrono::ChVector<> buoyancy = rho * (-g_acc) * file_info.GetDispVolVal(b);  // buoyancy = rho*g*Vdisp
         body_force_hydrostatic[0] += buoyancy[0];
         body_force_hydrostatic[1] += buoyancy[1];
         body_force_hydrostatic[2] += buoyancy[2];
@@ -563,61 +1200,86 @@ std::vector<double> TestHydro::ComputeForceHydrostatics() {
     return force_hydrostatic;
 }
 
+/*******************************************************************************
+ * TestHydro::ComputeForceNonlinearPressure(b)
+ * adds the mesh pressure force of body b (replaces its linear hydrostatics and
+ * buoyancy, and the Froude-Krylov excitation with incident_pressure)
+ *******************************************************************************/
+void TestHydro::ComputeForceNonlinearPressure(int b) {
+    double rho = file_info.GetRhoVal();
+    double gg  = bodies[0]->GetSystem()->Get_G_acc().Length();
+    Eigen::Vector3d position(body_states.position[3 * b], body_states.position[3 * b + 1],
+                             body_states.position[3 * b + 2]);
+    Eigen::Matrix<double, 6, 1> force;
+    pressure_meshes[b]->Integrate(position, body_states.orientation[b], bodies[0]->GetChTime(), rho, gg,
+                                  user_waves.get(), nonlinear_incident_pressure, force);
+    for (int dof = 0; dof < 6; dof++) {
+        force_hydrostatic[6 * b + dof] += force[dof];
+    }
+}
+
 /*******************************************************************************
  * TestHydro::ComputeForceRadiationDampingConv()
  * computes the 6N dimensional Radiation Damping force with convolution history
  *******************************************************************************/
-std::vector<double> TestHydro::ComputeForceRadiationDampingConv() {
+const std::vector<double>& TestHydro::ComputeForceRadiationDampingConv() {
+    RecordVelocityHistory();
+    ConvolveRadiationDamping();
+    return force_radiation_damping;
+}
+
+/*******************************************************************************
+ * TestHydro::RecordVelocityHistory()
+ * shifts the circular velocity history by one step and stores the current
+ * body velocities, done at every time step even when the convolution is not
+ *******************************************************************************/
+void TestHydro::RecordVelocityHistory() {
     int size = file_info.GetRIRFDims(2);
-    int nDoF = 6;
     // "shift" everything left 1
     offset_rirf--;  // starts as 0 before timestep change
     // keep offset close to 0, avoids small chance of -overflow errors in long simulations
     if (offset_rirf < -1 * size) {
         offset_rirf += size;
     }
-    int numRows = nDoF * num_bodies;
-    int numCols = nDoF * num_bodies;
-    assert(numRows * size > 0 && numCols > 0);
-    double* timeseries = new double[numRows * numCols * size];
-    double* tmp_s      = new double[numRows * size];
-    // define shortcuts for accessing 1D arrays as 3D (or 2D) arrays
-    // TIMESERIES is for each row in RIRF, element wise multipy velocity history by RIRF slab
-#define TIMESERIES(row, col, step) timeseries[(row * numCols * size) + (col * size) + (step)]
-    // TMP_S ends up being a sum over the columns of TIMESERIES (total_dofs aka LDOF
-#define TMP_S(row, step) tmp_s[((row)*size) + (step)]
-    // set last entry as velocity
-    for (int i = 0; i < 3; i++) {
-        for (int b = 1; b < num_bodies + 1; b++) {  // body index being 1 indexed here is right
-            int vi = (((size + offset_rirf) % size) + size) % size;
-            setVelHistory(bodies[b - 1]->GetPos_dt()[i], vi, b, i);
-            setVelHistory(bodies[b - 1]->GetWvel_par()[i], vi, b, i + 3);
-        }
+    // set last entry as velocity, straight from the gathered body states
+    int v_last = (((size + offset_rirf) % size) + size) % size;
+    for (int c = 0; c < static_cast<int>(active_dofs.size()); c++) {
+        setVelHistory(body_states.velocity[active_dofs[c]], v_last, c);
+    }
+}
+
+/*******************************************************************************
+ * TestHydro::ConvolveRadiationDamping()
+ * accumulates the radiation damping convolution of the recorded velocity
+ * history into force_radiation_damping
+ *******************************************************************************/
+void TestHydro::ConvolveRadiationDamping() {
+    int size = file_info.GetRIRFDims(2);
+    int n    = static_cast<int>(active_dofs.size());
+    assert(size > 0);
+    if (n == 0) {
+        return;
     }
     int vi;
-    //#pragma omp parallel for
     if (convTrapz == true) {
-        // convolution integral using trapezoidal rule
-        for (int row = 0; row < numRows; row++) {  // row goes to 6N
-            for (int st = 0; st < size; st++) {
-                vi = (((st + offset_rirf) % size) + size) % size;  // vi takes care of circshift function from matLab
-                TMP_S(row, st) = 0;
-                for (int col = 0; col < numCols; col++) {  // numCols goes to 6N
-                    // multiply rirf by velocity history for each step and row (0,...,6N), store product in TIMESERIES
-                    TIMESERIES(row, col, st) = GetRIRFval(row, col, st) * getVelHistoryVal(vi, col);
-                    // for (int i = 0; i < numCols; i++) {
-                    // velOut << getVelHistoryVal(vi, col) << std::endl;
-                    //}
-                    // TMP_S is the sum over col (sum the effects of all radiating dofs (LDOF) for each time and motion
-                    // dof)
-                    TMP_S(row, st) += TIMESERIES(row, col, st);
-                }
-                if (st > 0) {
-                    // integrate TMP_S
-                    force_radiation_damping[row] +=
-                        (TMP_S(row, st - 1) + TMP_S(row, st)) / 2.0 * (rirf_time_vector[st] - rirf_time_vector[st - 1]);
-                }
+        // convolution integral using trapezoidal rule, over the active dofs only
+        // the integrand (rirf times velocity history, summed over all radiating dofs) is only needed at steps st-1
+        // and st, so it is kept in two n vectors instead of a heap allocated n x n x size time series
+        radiation_sum.setZero();
+        for (int st = 0; st < size; st++) {
+            vi = (((st + offset_rirf) % size) + size) % size;  // vi takes care of circshift function from matLab
+            Eigen::Map<const Eigen::VectorXd> velocity(&velocity_history[static_cast<size_t>(n) * vi], n);
+            // multiply rirf by velocity history for each step and sum the effects of all radiating dofs
+            radiation_integrand.noalias() = rirf_active.middleCols(st * n, n) * velocity;
+            if (st > 0) {
+                // integrate
+                radiation_sum += (0.5 * (rirf_time_vector[st] - rirf_time_vector[st - 1])) *
+                                 (radiation_integrand_prev + radiation_integrand);
             }
+            radiation_integrand_prev.swap(radiation_integrand);
+        }
+        for (int c = 0; c < n; c++) {
+            force_radiation_damping[active_dofs[c]] += radiation_sum[c];
         }
     }
     // velOut.close();
@@ -640,13 +1302,6 @@ std::vector<double> TestHydro::ComputeForceRadiationDampingConv() {
     //		force_radiation_damping[row] -= sumVelHistoryAndRIRF * rirf_timestep;
     //	}
     //}
-    // Deallocate memory
-#undef TIMESERIES
-#undef TMP_S
-    delete[] timeseries;
-    delete[] tmp_s;
-
-    return force_radiation_damping;
 }
 
 /*******************************************************************************
@@ -655,17 +1310,14 @@ std::vector<double> TestHydro::ComputeForceRadiationDampingConv() {
  * row: encodes the body number and dof index [0,...,5,...6N-1] for rows of RIRF
  * col: col in RIRF matrix [0,...,5,...6N-1]
  * st: which step in rirf ranges usually [0,...1000]
- * c: gets just the index aka dof from col
- * b: gets body num from col
+ * b: gets body num from row
+ * r: gets just the index aka dof from row
  *******************************************************************************/
 double TestHydro::GetRIRFval(int row, int col, int st) {
-    if (row < 0 || row >= 6 * num_bodies || col < 0 || col >= 6 * num_bodies || st < 0 ||
-        st >= file_info.GetRIRFDims(2)) {
-        std::cout << "rirfval index bad from testhydro" << std::endl;
-        return 0;
-    }
+    HYDROC_CHECK_INDEX(row >= 0 && row < 6 * num_bodies, "TestHydro::GetRIRFval");
+    HYDROC_CHECK_INDEX(col >= 0 && col < 6 * num_bodies, "TestHydro::GetRIRFval");
+    HYDROC_CHECK_INDEX(st >= 0 && st < file_info.GetRIRFDims(2), "TestHydro::GetRIRFval");
     int b = row / 6;  // 0 indexed, which body to get matrix info from
-    int c = col % 6;  // which dof across column, 0,..,11 for 2 bodies, 0,...,6N-1 for N
     int r = row % 6;  // which dof 0,..,5 in individual body RIRF matrix
     return file_info.GetRIRFVal(b, r, col, st);
 }
@@ -691,14 +1343,70 @@ double TestHydro::GetRIRFval(int row, int col, int st) {
 
 
 
+/*******************************************************************************
+ * TestHydro::ComputeForceAddedMassCorrection()
+ * explicit part of the added mass in inertia augmentation mode:
+ * -(A - folded) * a_prev, plus cancelling the weight of the folded mass
+ * (Chrono applies gravity to the augmented body mass)
+ *******************************************************************************/
+void TestHydro::ComputeForceAddedMassCorrection() {
+    chrono::ChVector<> g_acc = bodies[0]->GetSystem()->Get_G_acc();
+    force_added_mass.noalias() = -infinite_added_mass * body_states.acceleration;
+    for (int b = 0; b < num_bodies; b++) {
+        // add back what the augmented body already carries
+        Eigen::Matrix3d R = bodies[b]->GetA();
+        auto a_t          = body_states.acceleration.segment<3>(6 * b);
+        auto a_r          = body_states.acceleration.segment<3>(6 * b + 3);
+        force_added_mass.segment<3>(6 * b) += folded_added_mass[b] * a_t;
+        force_added_mass.segment<3>(6 * b + 3).noalias() += R * (folded_added_inertia[b] * (R.transpose() * a_r));
+        for (int i = 0; i < 3; i++) {
+            force_added_mass[6 * b + i] -= folded_added_mass[b] * g_acc[i];
+        }
+    }
+}
+
 // make force function call look the same as other compute force functions:
-Eigen::VectorXd TestHydro::ComputeForceWaves() {
-    Eigen::VectorXd wf(num_bodies * 6);
-    wf          = user_waves->GetForceAtTime(bodies[0]->GetChTime());
-    force_waves = wf;
+// the wave object writes straight into force_waves (sized in AddWaves), nothing is allocated per step
+const Eigen::VectorXd& TestHydro::ComputeForceWaves() {
+    force_waves.setZero();
+    user_waves->GetForceAtTime(bodies[0]->GetChTime(), force_waves);
     return force_waves;
 }
 
+/*******************************************************************************
+ * TestHydro::ComputeForceDrag()
+ *******************************************************************************/
+const Eigen::VectorXd& TestHydro::ComputeForceDrag() {
+    drag->ComputeForce(bodies[0]->GetChTime(), body_states, *user_waves, force_drag);
+    return force_drag;
+}
+
+/*******************************************************************************
+ * TestHydro::ComputeForceMooring()
+ * sum of all moorings, each adds into force_mooring
+ *******************************************************************************/
+const Eigen::VectorXd& TestHydro::ComputeForceMooring() {
+    force_mooring.setZero();
+    double time = bodies[0]->GetChTime();
+    for (auto& mooring : moorings) {
+        mooring->AddForce(time, body_states, force_mooring);
+    }
+    return force_mooring;
+}
+
+/*******************************************************************************
+ * TestHydro::ComputeForceDrift()
+ * slow drift force of the waves, zero without drift coefficients
+ *******************************************************************************/
+const Eigen::VectorXd& TestHydro::ComputeForceDrift() {
+    force_drift.setZero();
+    if (mean_drift) {
+        double time = bodies[0]->GetChTime();
+        mean_drift->AddForceAtTime(time, force_drift, user_waves->GetRampFactor(time));
+    }
+    return force_drift;
+}
+
 /*******************************************************************************
  * TestHydro::TODO
  * ****IMPORTANT b is 1 indexed here
@@ -709,41 +1417,102 @@ Eigen::VectorXd TestHydro::ComputeForceWaves() {
  * calls computeForce type functions
  *******************************************************************************/
 double TestHydro::coordinateFunc(int b, int i) {
+    hydroc::StepScope step_scope;
     int body_num_offset = 6 * (b - 1);  // b_num from ForceFunc6d is 1 indexed, TODO: make all b_num 0 indexed
     int total_dofs      = 6 * num_bodies;
-    if (i < 0 || i > 5 || b < 1 || b > num_bodies) {
-        std::cout << "wrong index somewhere\nsetting coordinateFunc to 0" << std::endl;
-        return 0;
-    }
-    // check prev_time here and only here
-    // if forces have been computed for this time already, return the computed total force
+    HYDROC_CHECK_INDEX(i >= 0 && i < 6, "TestHydro::coordinateFunc");
+    HYDROC_CHECK_INDEX(b >= 1 && b <= num_bodies, "TestHydro::coordinateFunc");
     if (bodies[0] == NULL) {
         std::cout << "bodies empty" << std::endl;
         return 0;
     }
+    // check prev_time here and only here
+    // if forces have been computed for this time already, return the computed total force
     if (bodies[0]->GetChTime() == prev_time) {
         return total_force[body_num_offset + i];
     }
     // update current time and total_force for this step
-    prev_time = bodies[0]->GetChTime();
+    prev_time   = bodies[0]->GetChTime();
+    double time = prev_time;
 
-    // reset forces to 0
-    // TODO change forces to Eigen::VectorXd types, might need to force evaluation of eigen at some point?
     std::fill(total_force.begin(), total_force.end(), 0.0);
-    std::fill(force_hydrostatic.begin(), force_hydrostatic.end(), 0.0);
-    std::fill(force_radiation_damping.begin(), force_radiation_damping.end(), 0.0);
-    std::fill(force_waves.begin(), force_waves.end(), 0.0);
 
     // call compute forces
     convTrapz = true;  // use trapeziodal rule or assume fixed dt.
 
-    force_hydrostatic       = ComputeForceHydrostatics();
-    force_radiation_damping = ComputeForceRadiationDampingConv(); // TODO non convolution option
-    force_waves             = ComputeForceWaves();
+    // gather body positions, orientations and velocities once for all force computations
+    GatherBodyStates();
+    // the velocity history must see every step, whether or not the convolution runs now
+    RecordVelocityHistory();
+
+    // each component is either recomputed (accumulating into its zeroed persistent member vector)
+    // or held / extrapolated from its previous updates, see SetUpdateEverySteps / SetUpdateInterval
+    Eigen::Map<Eigen::VectorXd> hydrostatic(force_hydrostatic.data(), total_dofs);
+    Eigen::Map<Eigen::VectorXd> radiation(force_radiation_damping.data(), total_dofs);
+    HydroComponentRate& hydrostatic_rate = component_rates[static_cast<int>(HydroComponent::hydrostatics)];
+    HydroComponentRate& radiation_rate   = component_rates[static_cast<int>(HydroComponent::radiation)];
+    HydroComponentRate& waves_rate       = component_rates[static_cast<int>(HydroComponent::waves)];
+    HydroComponentRate& drag_rate        = component_rates[static_cast<int>(HydroComponent::drag)];
+    HydroComponentRate& mooring_rate     = component_rates[static_cast<int>(HydroComponent::mooring)];
+    HydroComponentRate& drift_rate       = component_rates[static_cast<int>(HydroComponent::drift)];
+
+    if (hydrostatic_rate.IsDue(time)) {
+        hydrostatic.setZero();
+        ComputeForceHydrostatics();
+        hydrostatic_rate.Store(time, hydrostatic);
+    } else {
+        hydrostatic_rate.Predict(time, hydrostatic);
+    }
+
+    if (radiation_rate.IsDue(time)) {
+        radiation.setZero();
+        ConvolveRadiationDamping();  // TODO non convolution option
+        radiation_rate.Store(time, radiation);
+    } else {
+        radiation_rate.Predict(time, radiation);
+    }
+
+    if (waves_rate.IsDue(time)) {
+        ComputeForceWaves();  // zeroes force_waves itself
+        waves_rate.Store(time, force_waves);
+    } else {
+        waves_rate.Predict(time, force_waves);
+    }
+
+    if (drag_rate.IsDue(time)) {
+        ComputeForceDrag();  // zeroes force_drag itself
+        drag_rate.Store(time, force_drag);
+    } else {
+        drag_rate.Predict(time, force_drag);
+    }
+
+    if (mooring_rate.IsDue(time)) {
+        ComputeForceMooring();  // zeroes force_mooring itself
+        mooring_rate.Store(time, force_mooring);
+    } else {
+        mooring_rate.Predict(time, force_mooring);
+    }
+
+    if (drift_rate.IsDue(time)) {
+        ComputeForceDrift();  // zeroes force_drift itself
+        drift_rate.Store(time, force_drift);
+    } else {
+        drift_rate.Predict(time, force_drift);
+    }
+
+    if (added_mass_in_inertia) {
+        ComputeForceAddedMassCorrection();
+    }
 
     // TODO once all force components are Eigen, remove this from being a loop
+    // inactive dofs (SetActiveDofs) get no linear hydro force, the joints hold them; drag, moorings and
+    // drift act on the body whatever the joints do
     for (int i = 0; i < total_dofs; i++) {
-        total_force[i] = force_hydrostatic[i] - force_radiation_damping[i] + force_waves[i];
+        double hydro = force_hydrostatic[i] - force_radiation_damping[i] + force_waves[i];
+        if (added_mass_in_inertia) {
+            hydro += force_added_mass[i];
+        }
+        total_force[i] = (dof_active[i] ? hydro : 0.0) + force_drag[i] + force_mooring[i] + force_drift[i];
     }
 
     //std::cout << "force_waves\n";
@@ -751,8 +1520,5 @@ double TestHydro::coordinateFunc(int b, int i) {
     //    std::cout << force_waves[i] << std::endl;
     //}
 
-    if (body_num_offset + i < 0 || body_num_offset >= total_dofs) {
-        std::cout << "total force accessing out of bounds" << std::endl;
-    }
     return total_force[body_num_offset + i];
 }
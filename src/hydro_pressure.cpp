@@ -0,0 +1,500 @@
+#include <hydroc/hydro_pressure.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+Eigen::Matrix3d Skew(const Eigen::Vector3d& v) {
+    Eigen::Matrix3d m;
+    m << 0.0, -v.z(), v.y(), v.z(), 0.0, -v.x(), -v.y(), v.x(), 0.0;
+    return m;
+}
+
+// OBJ "f" index token ("7", "7/1", "7//3", "-1"), converted to a 0 based vertex index
+int ObjVertexIndex(const std::string& token, int num_vertices) {
+    int index = std::stoi(token.substr(0, token.find('/')));
+    return index < 0 ? num_vertices + index : index - 1;
+}
+}  // namespace
+
+// =============================================================================
+// HydroPressureMesh Class Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * HydroPressureMesh constructor (obj_file_name, max_leaf_triangles)
+ * reads vertices and faces of a Wavefront OBJ file (other records are ignored,
+ * polygons are split into triangle fans) and builds the hierarchy
+ *******************************************************************************/
+HydroPressureMesh::HydroPressureMesh(const std::string& obj_file_name, int max_leaf_triangles)
+    : max_leaf_triangles(std::max(1, max_leaf_triangles)) {
+    std::ifstream obj_file(obj_file_name);
+    if (!obj_file.is_open()) {
+        throw std::runtime_error("HydroPressureMesh: unable to open " + obj_file_name);
+    }
+
+    std::vector<std::array<int, 3>> faces;
+    std::string line;
+    while (std::getline(obj_file, line)) {
+        std::istringstream record(line);
+        std::string type;
+        record >> type;
+        if (type == "v") {
+            Eigen::Vector3d v;
+            record >> v.x() >> v.y() >> v.z();
+            vertices.push_back(v);
+        } else if (type == "f") {
+            std::vector<int> polygon;
+            std::string token;
+            while (record >> token) {
+                polygon.push_back(ObjVertexIndex(token, static_cast<int>(vertices.size())));
+            }
+            for (size_t k = 1; k + 1 < polygon.size(); k++) {
+                faces.push_back({polygon[0], polygon[k], polygon[k + 1]});
+            }
+        }
+    }
+    if (faces.empty()) {
+        throw std::runtime_error("HydroPressureMesh: no faces in " + obj_file_name);
+    }
+    Build(faces);
+}
+
+/*******************************************************************************
+ * HydroPressureMesh constructor (body_vertices, triangles, max_leaf_triangles)
+ *******************************************************************************/
+HydroPressureMesh::HydroPressureMesh(const std::vector<Eigen::Vector3d>& body_vertices,
+                                     const std::vector<std::array<int, 3>>& triangles,
+                                     int max_leaf_triangles)
+    : vertices(body_vertices), max_leaf_triangles(std::max(1, max_leaf_triangles)) {
+    Build(triangles);
+}
+
+/*******************************************************************************
+ * HydroPressureMesh::Build(faces)
+ * triangle geometry, then the hierarchy from the root, then the per call scratch
+ *******************************************************************************/
+void HydroPressureMesh::Build(const std::vector<std::array<int, 3>>& faces) {
+    const int num_vertices = static_cast<int>(vertices.size());
+    triangles.clear();
+    triangles.reserve(faces.size());
+    for (const auto& face : faces) {
+        for (int v : face) {
+            if (v < 0 || v >= num_vertices) {
+                throw std::runtime_error("HydroPressureMesh: face vertex index out of range");
+            }
+        }
+        Triangle tri;
+        std::copy(face.begin(), face.end(), tri.v);
+        const Eigen::Vector3d& a = vertices[face[0]];
+        const Eigen::Vector3d& b = vertices[face[1]];
+        const Eigen::Vector3d& c = vertices[face[2]];
+        Eigen::Vector3d cross    = (b - a).cross(c - a);
+        tri.area                 = 0.5 * cross.norm();
+        if (tri.area <= 0.0) {
+            continue;  // degenerate, carries no pressure
+        }
+        tri.normal   = cross / (2.0 * tri.area);
+        tri.centroid = (a + b + c) / 3.0;
+        triangles.push_back(tri);
+    }
+
+    nodes.clear();
+    nodes.reserve(2 * triangles.size() / max_leaf_triangles + 2);
+    nodes.emplace_back();
+    BuildNode(0, 0, static_cast<int>(triangles.size()));
+
+    vertex_world.assign(num_vertices, Eigen::Vector3d::Zero());
+    vertex_depth.assign(num_vertices, 0.0);
+    vertex_stamp.assign(num_vertices, 0);
+    node_stack.resize(nodes.size());
+    stamp = 0;
+}
+
+/*******************************************************************************
+ * HydroPressureMesh::BuildNode(node, first, count)
+ * bounding sphere and moments of triangles [first, first + count), split at the
+ * median centroid along the longest axis until max_leaf_triangles is reached
+ *******************************************************************************/
+void HydroPressureMesh::BuildNode(int node, int first, int count) {
+    Eigen::Vector3d lower          = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+    Eigen::Vector3d upper          = -lower;
+    Eigen::Vector3d centroid_lower = lower;
+    Eigen::Vector3d centroid_upper = upper;
+    Moments moments;
+    for (int i = first; i < first + count; i++) {
+        for (int v : triangles[i].v) {
+            lower = lower.cwiseMin(vertices[v]);
+            upper = upper.cwiseMax(vertices[v]);
+        }
+        centroid_lower = centroid_lower.cwiseMin(triangles[i].centroid);
+        centroid_upper = centroid_upper.cwiseMax(triangles[i].centroid);
+        AddMoments(triangles[i], vertices, moments);
+    }
+    Eigen::Vector3d center = 0.5 * (lower + upper);
+    double radius          = 0.0;
+    for (int i = first; i < first + count; i++) {
+        for (int v : triangles[i].v) {
+            radius = std::max(radius, (vertices[v] - center).norm());
+        }
+    }
+    nodes[node].center  = center;
+    nodes[node].radius  = radius;
+    nodes[node].moments = moments;
+
+    if (count <= max_leaf_triangles) {
+        nodes[node].first = first;
+        nodes[node].count = count;
+        return;
+    }
+
+    int axis;
+    (centroid_upper - centroid_lower).maxCoeff(&axis);
+    int half = count / 2;
+    std::nth_element(triangles.begin() + first, triangles.begin() + first + half, triangles.begin() + first + count,
+                     [axis](const Triangle& a, const Triangle& b) { return a.centroid[axis] < b.centroid[axis]; });
+
+    int left = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[node].first = left;
+    nodes[node].count = 0;
+    BuildNode(left, first, half);
+    BuildNode(left + 1, first + half, count - half);
+}
+
+/*******************************************************************************
+ * HydroPressureMesh::AddMoments(tri, vertices, moments)
+ * int x x^T dA over a triangle = A / 12 (sum v v^T + s s^T), s = sum v
+ *******************************************************************************/
+void HydroPressureMesh::AddMoments(const Triangle& tri,
+                                   const std::vector<Eigen::Vector3d>& vertices,
+                                   Moments& moments) {
+    const Eigen::Vector3d& a = vertices[tri.v[0]];
+    const Eigen::Vector3d& b = vertices[tri.v[1]];
+    const Eigen::Vector3d& c = vertices[tri.v[2]];
+    Eigen::Vector3d s        = a + b + c;
+    Eigen::Matrix3d second =
+        tri.area / 12.0 * (a * a.transpose() + b * b.transpose() + c * c.transpose() + s * s.transpose());
+
+    moments.normal_area += tri.area * tri.normal;
+    moments.normal_moment += tri.area * tri.normal * tri.centroid.transpose();
+    moments.torque_area += tri.area * tri.centroid.cross(tri.normal);
+    moments.torque_moment -= Skew(tri.normal) * second;
+}
+
+/*******************************************************************************
+ * HydroPressureMesh::GetVolume()
+ *******************************************************************************/
+double HydroPressureMesh::GetVolume() const {
+    double volume = 0.0;
+    for (const auto& tri : triangles) {
+        volume += tri.area * tri.normal.z() * tri.centroid.z();
+    }
+    return volume;
+}
+
+/*******************************************************************************
+ * HydroPressureMesh::EvaluateVertex(v, pos, rot, t, waves)
+ * world position and depth below the free surface of vertex v, once per call
+ *******************************************************************************/
+void HydroPressureMesh::EvaluateVertex(int v,
+                                       const Eigen::Vector3d& pos,
+                                       const Eigen::Matrix3d& rot,
+                                       double t,
+                                       WaveBase* waves) {
+    if (vertex_stamp[v] == stamp) {
+        return;
+    }
+    vertex_stamp[v]           = stamp;
+    vertex_world[v].noalias() = pos + rot * vertices[v];
+    double elevation          = waves ? waves->GetElevation(vertex_world[v], t) : 0.0;
+    vertex_depth[v]           = elevation - vertex_world[v].z();
+}
+
+/*******************************************************************************
+ * HydroPressureMesh::IntegrateTriangle(tri, pos, rot, t, rho_g, waves, force, torque)
+ * clips the triangle to its wet part (depth > 0, linear along the edges) and
+ * integrates the pressure over the resulting fan with the edge midpoint rule
+ * (exact for the quadratic torque integrand of a linear pressure)
+ * force and torque (about pos) are accumulated in the world frame
+ *******************************************************************************/
+void HydroPressureMesh::IntegrateTriangle(const Triangle& tri,
+                                          const Eigen::Vector3d& pos,
+                                          const Eigen::Matrix3d& rot,
+                                          double t,
+                                          double rho_g,
+                                          WaveBase* waves,
+                                          Eigen::Vector3d& force,
+                                          Eigen::Vector3d& torque) {
+    int num_wet = 0;
+    for (int k = 0; k < 3; k++) {
+        EvaluateVertex(tri.v[k], pos, rot, t, waves);
+        num_wet += vertex_depth[tri.v[k]] > 0.0 ? 1 : 0;
+    }
+    if (num_wet == 0) {
+        return;
+    }
+    if (num_wet < 3) {
+        num_clipped_triangles++;
+    }
+
+    Eigen::Vector3d polygon[4];
+    int num_points = 0;
+    for (int k = 0; k < 3; k++) {
+        int a      = tri.v[k];
+        int b      = tri.v[(k + 1) % 3];
+        double d_a = vertex_depth[a];
+        double d_b = vertex_depth[b];
+        if (d_a > 0.0) {
+            polygon[num_points++] = vertex_world[a];
+        }
+        if ((d_a > 0.0) != (d_b > 0.0)) {
+            polygon[num_points++] = vertex_world[a] + (d_a / (d_a - d_b)) * (vertex_world[b] - vertex_world[a]);
+        }
+    }
+
+    Eigen::Vector3d normal = rot * tri.normal;
+    for (int k = 1; k + 1 < num_points; k++) {
+        const Eigen::Vector3d& p0 = polygon[0];
+        const Eigen::Vector3d& p1 = polygon[k];
+        const Eigen::Vector3d& p2 = polygon[k + 1];
+        double area               = 0.5 * (p1 - p0).cross(p2 - p0).norm();
+        if (area <= 0.0) {
+            continue;
+        }
+        Eigen::Vector3d midpoints[3] = {0.5 * (p0 + p1), 0.5 * (p1 + p2), 0.5 * (p2 + p0)};
+        for (const auto& m : midpoints) {
+            double head = -m.z();
+            if (waves) {
+                head += waves->GetPressureHead(m, t);
+            }
+            Eigen::Vector3d d_force = (-rho_g * head * area / 3.0) * normal;
+            force += d_force;
+            torque += (m - pos).cross(d_force);
+        }
+    }
+}
+
+/*******************************************************************************
+ * HydroPressureMesh::Integrate(pos, rot, t, rho, g, waves, incident_pressure, force)
+ * pressure head = -z (+ incident wave head), wet below the still water level or,
+ * with incident_pressure, below the wave elevation
+ *******************************************************************************/
+void HydroPressureMesh::Integrate(const Eigen::Vector3d& pos,
+                                  const Eigen::Matrix3d& rot,
+                                  double t,
+                                  double rho,
+                                  double g,
+                                  WaveBase* waves,
+                                  bool incident_pressure,
+                                  Eigen::Ref<Eigen::Matrix<double, 6, 1>> force) {
+    WaveBase* field    = incident_pressure ? waves : nullptr;
+    const double rho_g = rho * g;
+    const double bound = field ? field->GetElevationBound() : 0.0;
+    const double k_max = field ? field->GetMaxWaveNumber() : 0.0;
+    stamp++;
+    num_clipped_triangles = 0;
+    num_aggregated_nodes  = 0;
+
+    // hydrostatic pressure in body coordinates: p0 + grad . x
+    const Eigen::Vector3d up_body          = rot.row(2).transpose();
+    const double hydrostatic_p0            = -rho_g * pos.z();
+    const Eigen::Vector3d hydrostatic_grad = -rho_g * up_body;
+
+    Eigen::Vector3d force_body   = Eigen::Vector3d::Zero();  // aggregated nodes, body frame
+    Eigen::Vector3d torque_body  = Eigen::Vector3d::Zero();
+    Eigen::Vector3d force_world  = Eigen::Vector3d::Zero();  // triangles, world frame
+    Eigen::Vector3d torque_world = Eigen::Vector3d::Zero();
+
+    int top           = 0;
+    node_stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[node_stack[--top]];
+        double z_center  = pos.z() + up_body.dot(node.center);
+        if (z_center - node.radius > bound) {
+            continue;  // dry
+        }
+
+        bool submerged = z_center + node.radius < -bound;
+        if (submerged && k_max * node.radius <= max_linearized_node_kr) {
+            double p0                = hydrostatic_p0;
+            Eigen::Vector3d gradient = hydrostatic_grad;
+            if (field) {
+                // wave pressure linearized about the node center
+                Eigen::Vector3d center_world = pos + rot * node.center;
+                Eigen::Vector3d head_gradient;
+                double head                   = field->GetPressureHead(center_world, t, &head_gradient);
+                Eigen::Vector3d gradient_body = rot.transpose() * head_gradient;
+                p0 += rho_g * (head - gradient_body.dot(node.center));
+                gradient += rho_g * gradient_body;
+            }
+            const Moments& m = node.moments;
+            force_body -= p0 * m.normal_area + m.normal_moment * gradient;
+            torque_body -= p0 * m.torque_area + m.torque_moment * gradient;
+            num_aggregated_nodes++;
+            continue;
+        }
+
+        if (node.count == 0) {
+            node_stack[top++] = node.first;
+            node_stack[top++] = node.first + 1;
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; i++) {
+            IntegrateTriangle(triangles[i], pos, rot, t, rho_g, field, force_world, torque_world);
+        }
+    }
+
+    force.head<3>() = rot * force_body + force_world;
+    force.tail<3>() = rot * torque_body + torque_world;
+}
+
+// =============================================================================
+// HydrostaticTable Class Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * HydrostaticTable constructor (mesh, cg_heights, roll_angles, pitch_angles, rho, g)
+ * still water pressure integration at every grid point, body at x = y = 0
+ *******************************************************************************/
+HydrostaticTable::HydrostaticTable(HydroPressureMesh& mesh,
+                                   const Eigen::VectorXd& cg_heights,
+                                   const Eigen::VectorXd& roll_angles,
+                                   const Eigen::VectorXd& pitch_angles,
+                                   double rho,
+                                   double g)
+    : heights(cg_heights), rolls(roll_angles), pitches(pitch_angles) {
+    if (heights.size() == 0 || rolls.size() == 0 || pitches.size() == 0) {
+        throw std::invalid_argument("HydrostaticTable: empty grid axis");
+    }
+    values.resize(6, heights.size() * rolls.size() * pitches.size());
+    Eigen::Matrix<double, 6, 1> force;
+    for (int h = 0; h < heights.size(); h++) {
+        for (int r = 0; r < rolls.size(); r++) {
+            for (int p = 0; p < pitches.size(); p++) {
+                Eigen::Matrix3d rot = (Eigen::AngleAxisd(pitches[p], Eigen::Vector3d::UnitY()) *
+                                       Eigen::AngleAxisd(rolls[r], Eigen::Vector3d::UnitX()))
+                                          .toRotationMatrix();
+                mesh.Integrate(Eigen::Vector3d(0.0, 0.0, heights[h]), rot, 0.0, rho, g, nullptr, false, force);
+                values.col(Column(h, r, p)) = force;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * HydrostaticTable constructor (file_name)
+ *******************************************************************************/
+HydrostaticTable::HydrostaticTable(const std::string& file_name) {
+    std::ifstream table_file(file_name);
+    if (!table_file.is_open()) {
+        throw std::runtime_error("HydrostaticTable: unable to open " + file_name);
+    }
+    std::string header;
+    std::getline(table_file, header);
+    int num_heights = 0, num_rolls = 0, num_pitches = 0;
+    table_file >> num_heights >> num_rolls >> num_pitches;
+    if (!table_file || num_heights <= 0 || num_rolls <= 0 || num_pitches <= 0) {
+        throw std::runtime_error("HydrostaticTable: bad grid sizes in " + file_name);
+    }
+    heights.resize(num_heights);
+    rolls.resize(num_rolls);
+    pitches.resize(num_pitches);
+    values.resize(6, num_heights * num_rolls * num_pitches);
+    for (auto axis : {&heights, &rolls, &pitches}) {
+        for (int i = 0; i < axis->size(); i++) {
+            table_file >> (*axis)[i];
+        }
+    }
+    for (int c = 0; c < values.cols(); c++) {
+        for (int dof = 0; dof < 6; dof++) {
+            table_file >> values(dof, c);
+        }
+    }
+    if (!table_file) {
+        throw std::runtime_error("HydrostaticTable: truncated table in " + file_name);
+    }
+}
+
+/*******************************************************************************
+ * HydrostaticTable::Save(file_name)
+ *******************************************************************************/
+void HydrostaticTable::Save(const std::string& file_name) const {
+    std::ofstream table_file(file_name);
+    if (!table_file.is_open()) {
+        throw std::runtime_error("HydrostaticTable: unable to open " + file_name + " for writing");
+    }
+    table_file << "# hydrostatic table: cg heights, roll, pitch [rad]; Fx Fy Fz Mx My Mz per grid point\n";
+    table_file << std::setprecision(17);
+    table_file << heights.size() << " " << rolls.size() << " " << pitches.size() << "\n";
+    for (auto axis : {&heights, &rolls, &pitches}) {
+        for (int i = 0; i < axis->size(); i++) {
+            table_file << (*axis)[i] << (i + 1 < axis->size() ? " " : "\n");
+        }
+    }
+    for (int c = 0; c < values.cols(); c++) {
+        for (int dof = 0; dof < 6; dof++) {
+            table_file << values(dof, c) << (dof < 5 ? " " : "\n");
+        }
+    }
+}
+
+/*******************************************************************************
+ * HydrostaticTable::Bracket(axis, x, weight)
+ * lower index of the interval of the (increasing) axis containing x and the
+ * weight of the upper end, clamped to the axis ends
+ *******************************************************************************/
+int HydrostaticTable::Bracket(const Eigen::VectorXd& axis, double x, double& weight) {
+    const int n = static_cast<int>(axis.size());
+    if (n == 1 || x <= axis[0]) {
+        weight = 0.0;
+        return 0;
+    }
+    if (x >= axis[n - 1]) {
+        weight = 1.0;
+        return n - 2;
+    }
+    int i  = static_cast<int>(std::upper_bound(axis.data(), axis.data() + n, x) - axis.data()) - 1;
+    weight = (x - axis[i]) / (axis[i + 1] - axis[i]);
+    return i;
+}
+
+/*******************************************************************************
+ * HydrostaticTable::Interpolate(pos, rot, force)
+ * trilinear in (cg height, roll, pitch), then rotated by the yaw
+ *******************************************************************************/
+void HydrostaticTable::Interpolate(const Eigen::Vector3d& pos,
+                                   const Eigen::Matrix3d& rot,
+                                   Eigen::Ref<Eigen::Matrix<double, 6, 1>> force) const {
+    double yaw   = std::atan2(rot(1, 0), rot(0, 0));
+    double pitch = std::atan2(-rot(2, 0), std::hypot(rot(0, 0), rot(1, 0)));
+    double roll  = std::atan2(rot(2, 1), rot(2, 2));
+
+    double w[3];
+    int i[3] = {Bracket(heights, pos.z(), w[0]), Bracket(rolls, roll, w[1]), Bracket(pitches, pitch, w[2])};
+    int n[3] = {static_cast<int>(heights.size()), static_cast<int>(rolls.size()), static_cast<int>(pitches.size())};
+
+    Eigen::Matrix<double, 6, 1> sum = Eigen::Matrix<double, 6, 1>::Zero();
+    for (int corner = 0; corner < 8; corner++) {
+        double weight = 1.0;
+        int index[3];
+        for (int a = 0; a < 3; a++) {
+            int upper = (corner >> a) & 1;
+            weight *= upper ? w[a] : 1.0 - w[a];
+            index[a] = std::min(i[a] + upper, n[a] - 1);
+        }
+        if (weight != 0.0) {
+            sum += weight * values.col(Column(index[0], index[1], index[2]));
+        }
+    }
+
+    Eigen::Matrix3d yaw_rot = Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+    force.head<3>()         = yaw_rot * sum.head<3>();
+    force.tail<3>()         = yaw_rot * sum.tail<3>();
+}
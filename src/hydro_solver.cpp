@@ -0,0 +1,86 @@
+#include <hydroc/hydro_solver.h>
+
+#include <iostream>
+
+// =============================================================================
+// ChSolverHydroGMRES Class Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * ChSolverHydroGMRES constructor
+ * hydro_bodies: the bodies whose mass + added mass block is preconditioned as
+ * a whole (the bodies given to TestHydro)
+ *******************************************************************************/
+ChSolverHydroGMRES::ChSolverHydroGMRES(std::vector<std::shared_ptr<chrono::ChBody>> hydro_bodies)
+    : bodies(hydro_bodies),
+      m_engine(std::make_unique<Eigen::GMRES<chrono::ChSparseMatrix, HydroBlockPreconditioner>>()) {
+    block_indices.reserve(6 * bodies.size());
+}
+
+/*******************************************************************************
+ * ChSolverHydroGMRES::Clone()
+ *******************************************************************************/
+ChSolverHydroGMRES* ChSolverHydroGMRES::Clone() const {
+    auto clone              = new ChSolverHydroGMRES(bodies);
+    clone->m_max_iterations = m_max_iterations;
+    clone->m_tolerance      = m_tolerance;
+    clone->m_warm_start     = m_warm_start;
+    clone->verbose          = verbose;
+    clone->SetRestart(restart);
+    return clone;
+}
+
+/*******************************************************************************
+ * ChSolverHydroGMRES::SetRestart(restart)
+ *******************************************************************************/
+void ChSolverHydroGMRES::SetRestart(int restart) {
+    this->restart = restart;
+    m_engine->set_restart(restart);
+}
+
+/*******************************************************************************
+ * ChSolverHydroGMRES::SetupProblem()
+ * looks up the hydro bodies' rows in the assembled matrix (their variables
+ * offsets, fixed bodies have none) and sets up the preconditioner
+ *******************************************************************************/
+bool ChSolverHydroGMRES::SetupProblem() {
+    block_indices.clear();
+    for (const auto& body : bodies) {
+        if (!body->Variables().IsActive()) {
+            continue;
+        }
+        int offset = body->Variables().GetOffset();
+        for (int i = 0; i < 6; i++) {
+            block_indices.push_back(offset + i);
+        }
+    }
+    m_engine->preconditioner().SetBlockIndices(block_indices);
+    m_engine->compute(m_mat);
+    return true;
+}
+
+/*******************************************************************************
+ * ChSolverHydroGMRES::SolveProblem()
+ * same as Chrono's ChSolverGMRES, unset (non positive) limits keep Eigen's defaults
+ *******************************************************************************/
+bool ChSolverHydroGMRES::SolveProblem() {
+    if (m_max_iterations > 0) {
+        m_engine->setMaxIterations(m_max_iterations);
+    }
+    if (m_tolerance > 0) {
+        m_engine->setTolerance(m_tolerance);
+    }
+
+    if (m_warm_start) {
+        m_sol = m_engine->solveWithGuess(m_rhs, m_initguess);
+    } else {
+        m_sol = m_engine->solve(m_rhs);
+    }
+
+    if (verbose) {
+        std::cout << "  HydroGMRES iterations: " << m_engine->iterations() << " error: " << m_engine->error()
+                  << std::endl;
+    }
+
+    return m_engine->info() == Eigen::Success;
+}
@@ -0,0 +1,500 @@
+#include <hydroc/mooring.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+// =============================================================================
+// CatenaryMooring Class Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * CatenaryMooring constructor (max_excursion, table_size)
+ * max_excursion: how far [m] the fairlead spans may move from their initial
+ * values and stay inside the tables, table_size: grid points per span axis
+ *******************************************************************************/
+CatenaryMooring::CatenaryMooring(double max_excursion, int table_size)
+    : max_excursion(max_excursion), table_size(std::max(2, table_size)) {
+    if (max_excursion <= 0.0) {
+        throw std::invalid_argument("CatenaryMooring: max_excursion must be positive");
+    }
+}
+
+/*******************************************************************************
+ * CatenaryMooring::AddLine(line)
+ *******************************************************************************/
+void CatenaryMooring::AddLine(const CatenaryLine& line) {
+    if (line.length <= 0.0 || line.weight <= 0.0 || line.stiffness <= 0.0) {
+        throw std::invalid_argument("CatenaryMooring::AddLine: length, weight and stiffness must be positive");
+    }
+    lines.push_back(line);
+}
+
+/*******************************************************************************
+ * CatenaryMooring::CatenarySpan(line, H, V)
+ * elastic catenary with the anchor on a frictionless seabed: while V < w L part
+ * of the line (L - V / w) lies on the seabed with tension H
+ *******************************************************************************/
+Eigen::Vector2d CatenaryMooring::CatenarySpan(const CatenaryLine& line,
+                                              double horizontal_tension,
+                                              double vertical_tension) {
+    const double H  = horizontal_tension;
+    const double V  = vertical_tension;
+    const double w  = line.weight;
+    const double L  = line.length;
+    const double EA = line.stiffness;
+    const double Va = V - w * L;  // vertical tension at the anchor
+    if (Va >= 0.0) {
+        // suspended along its whole length
+        double x = H / w * (std::asinh(V / H) - std::asinh(Va / H)) + H * L / EA;
+        double z = H / w * (std::hypot(1.0, V / H) - std::hypot(1.0, Va / H)) + (V * L - 0.5 * w * L * L) / EA;
+        return Eigen::Vector2d(x, z);
+    }
+    double suspended = V / w;
+    double x         = L - suspended + H / w * std::asinh(V / H) + H * L / EA;
+    double z         = H / w * (std::hypot(1.0, V / H) - 1.0) + V * V / (2.0 * EA * w);
+    return Eigen::Vector2d(x, z);
+}
+
+/*******************************************************************************
+ * CatenaryMooring::CatenaryProfile(line, H, V, s)
+ * the span equations integrated up to arc length s instead of the full length
+ *******************************************************************************/
+Eigen::Vector2d CatenaryMooring::CatenaryProfile(const CatenaryLine& line,
+                                                 double horizontal_tension,
+                                                 double vertical_tension,
+                                                 double s) {
+    const double H  = horizontal_tension;
+    const double w  = line.weight;
+    const double EA = line.stiffness;
+    const double Va = vertical_tension - w * line.length;
+    if (Va >= 0.0) {
+        double Vs = Va + w * s;
+        double z  = (Va * s + 0.5 * w * s * s) / EA;
+        if (H <= 0.0) {
+            return Eigen::Vector2d(0.0, s + z);
+        }
+        return Eigen::Vector2d(H / w * (std::asinh(Vs / H) - std::asinh(Va / H)) + H * s / EA,
+                               H / w * (std::hypot(1.0, Vs / H) - std::hypot(1.0, Va / H)) + z);
+    }
+    double on_seabed = line.length - vertical_tension / w;
+    if (s <= on_seabed) {
+        return Eigen::Vector2d(s + H * s / EA, 0.0);
+    }
+    double Vs = w * (s - on_seabed);
+    double z  = Vs * Vs / (2.0 * EA * w);
+    if (H <= 0.0) {
+        return Eigen::Vector2d(on_seabed, s - on_seabed + z);
+    }
+    return Eigen::Vector2d(on_seabed + H / w * std::asinh(Vs / H) + H * s / EA,
+                           H / w * (std::hypot(1.0, Vs / H) - 1.0) + z);
+}
+
+/*******************************************************************************
+ * CatenaryMooring::SolveCatenary(line, horizontal_span, vertical_span, guess)
+ * Newton iteration on CatenarySpan (finite difference jacobian, H kept
+ * positive), automatic initial guess of Peyrot and Goulois as in MAP++
+ * spans shorter than the slack limit give H = 0
+ *******************************************************************************/
+Eigen::Vector2d CatenaryMooring::SolveCatenary(const CatenaryLine& line,
+                                               double horizontal_span,
+                                               double vertical_span,
+                                               Eigen::Vector2d guess) {
+    const double X = horizontal_span;
+    const double Z = vertical_span;
+    const double w = line.weight;
+    const double L = line.length;
+    // slack limit: the line hangs straight down to the seabed (H = 0, elastic stretch included) and the
+    // rest lies on it; a shorter horizontal span piles line up on the seabed, the tension is the same
+    const double EA        = line.stiffness;
+    double hanging_tension = EA * (std::sqrt(1.0 + 2.0 * w * Z / EA) - 1.0);
+    if (hanging_tension < w * L && X <= L - hanging_tension / w) {
+        return Eigen::Vector2d(0.0, hanging_tension);
+    }
+    if (guess[0] <= 0.0) {
+        double lambda;
+        if (X <= 1e-6 * L) {
+            lambda = 1e6;
+        } else if (L * L <= X * X + Z * Z) {
+            lambda = 0.2;
+        } else {
+            lambda = std::sqrt(3.0 * ((L * L - Z * Z) / (X * X) - 1.0));
+        }
+        guess[0] = std::max(std::abs(0.5 * w * X / lambda), 1e-6 * w * L);
+        guess[1] = 0.5 * w * (Z / std::tanh(lambda) + L);
+    }
+
+    Eigen::Vector2d target(X, Z);
+    Eigen::Vector2d tension  = guess;
+    Eigen::Vector2d residual = CatenarySpan(line, tension[0], tension[1]) - target;
+    const double tolerance   = 1e-10 * L;
+    for (int iteration = 0; iteration < 100 && residual.cwiseAbs().maxCoeff() > tolerance; iteration++) {
+        Eigen::Matrix2d jacobian;
+        for (int j = 0; j < 2; j++) {
+            Eigen::Vector2d perturbed = tension;
+            double step               = 1e-7 * std::max(std::abs(tension[j]), w * L);
+            perturbed[j] += step;
+            jacobian.col(j) = (CatenarySpan(line, perturbed[0], perturbed[1]) - target - residual) / step;
+        }
+        Eigen::Vector2d delta = jacobian.partialPivLu().solve(-residual);
+        // halve the step until H stays positive and the residual does not grow
+        double scale = 1.0;
+        for (int halving = 0; halving < 30; halving++, scale *= 0.5) {
+            Eigen::Vector2d next = tension + scale * delta;
+            if (next[0] <= 0.0) {
+                continue;
+            }
+            Eigen::Vector2d next_residual = CatenarySpan(line, next[0], next[1]) - target;
+            if (next_residual.allFinite() && next_residual.norm() < residual.norm()) {
+                tension  = next;
+                residual = next_residual;
+                break;
+            }
+        }
+        if (scale < 1e-8) {
+            break;
+        }
+    }
+    if (!residual.allFinite() || residual.cwiseAbs().maxCoeff() > 1e-6 * L) {
+        throw std::runtime_error("CatenaryMooring::SolveCatenary: no solution for span (" + std::to_string(X) + ", " +
+                                 std::to_string(Z) + ")");
+    }
+    return tension;
+}
+
+/*******************************************************************************
+ * CatenaryMooring::Initialize(states)
+ * solves every line on its table grid (continuation along the grid, each point
+ * starts from its neighbour's solution) and sizes the per step buffers
+ *******************************************************************************/
+void CatenaryMooring::Initialize(const HydroBodyStates& states) {
+    const int num_bodies = static_cast<int>(states.position.size() / 3);
+    const int num_lines  = GetNumLines();
+    const int grid       = table_size * table_size;
+
+    line_body.resize(num_lines);
+    line_fairlead.resize(3, num_lines);
+    line_anchor.resize(3, num_lines);
+    span_origin.resize(2, num_lines);
+    span_step.resize(2, num_lines);
+    table.resize(2, num_lines * grid);
+    tensions.setZero(2, num_lines);
+    line_force.setZero(6, num_lines);
+
+    for (int l = 0; l < num_lines; l++) {
+        const CatenaryLine& line = lines[l];
+        if (line.body < 0 || line.body >= num_bodies) {
+            throw std::invalid_argument("CatenaryMooring: line " + std::to_string(l) + " body index out of range");
+        }
+        line_body[l]         = line.body;
+        line_fairlead.col(l) = line.fairlead;
+        line_anchor.col(l)   = line.anchor;
+
+        Eigen::Vector3d fairlead =
+            states.position.segment<3>(3 * line.body) + states.orientation[line.body] * line.fairlead;
+        double x0 = (fairlead - line.anchor).head<2>().norm();
+        double z0 = fairlead.z() - line.anchor.z();
+        if (z0 <= 0.0) {
+            throw std::invalid_argument("CatenaryMooring: line " + std::to_string(l) + " fairlead below its anchor");
+        }
+        double min_span = 1e-3 * line.length;
+        double x_min    = std::max(x0 - max_excursion, min_span);
+        double z_min    = std::max(z0 - max_excursion, min_span);
+        span_origin.col(l) << x_min, z_min;
+        span_step.col(l) << (x0 + max_excursion - x_min) / (table_size - 1),
+            (z0 + max_excursion - z_min) / (table_size - 1);
+
+        Eigen::Vector2d row_start(-1.0, 0.0);
+        for (int ix = 0; ix < table_size; ix++) {
+            Eigen::Vector2d guess = row_start;
+            for (int iz = 0; iz < table_size; iz++) {
+                double x = span_origin(0, l) + ix * span_step(0, l);
+                double z = span_origin(1, l) + iz * span_step(1, l);
+                guess    = SolveCatenary(line, x, z, guess);
+                table.col(l * grid + ix * table_size + iz) = guess;
+                if (iz == 0) {
+                    row_start = guess;
+                }
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * CatenaryMooring::Lookup(line, x, z)
+ * bilinear in the line's table, clamped to its edges
+ *******************************************************************************/
+Eigen::Vector2d CatenaryMooring::Lookup(int line, double x, double z) const {
+    double u  = std::clamp((x - span_origin(0, line)) / span_step(0, line), 0.0, table_size - 1.0);
+    double v  = std::clamp((z - span_origin(1, line)) / span_step(1, line), 0.0, table_size - 1.0);
+    int ix    = std::min(static_cast<int>(u), table_size - 2);
+    int iz    = std::min(static_cast<int>(v), table_size - 2);
+    u        -= ix;
+    v        -= iz;
+    int first = line * table_size * table_size + ix * table_size + iz;
+    return (1.0 - u) * ((1.0 - v) * table.col(first) + v * table.col(first + 1)) +
+           u * ((1.0 - v) * table.col(first + table_size) + v * table.col(first + table_size + 1));
+}
+
+/*******************************************************************************
+ * CatenaryMooring::AddForce(t, states, force)
+ * lines are independent: each writes its own line_force column (in parallel
+ * for many lines), the per body sums are done afterwards
+ *******************************************************************************/
+void CatenaryMooring::AddForce(double t, const HydroBodyStates& states, Eigen::Ref<Eigen::VectorXd> force) {
+    const int num_lines = GetNumLines();
+#pragma omp parallel for if (num_lines >= min_parallel_lines)
+    for (int l = 0; l < num_lines; l++) {
+        int b                    = line_body[l];
+        Eigen::Vector3d arm      = states.orientation[b] * line_fairlead.col(l);
+        Eigen::Vector3d fairlead = states.position.segment<3>(3 * b) + arm;
+        Eigen::Vector2d to_anchor(line_anchor(0, l) - fairlead.x(), line_anchor(1, l) - fairlead.y());
+        double x = to_anchor.norm();
+        double z = fairlead.z() - line_anchor(2, l);
+
+        Eigen::Vector2d tension = Lookup(l, x, z);
+        tensions.col(l)         = tension;
+        Eigen::Vector3d pull(0.0, 0.0, -tension[1]);
+        if (x > 0.0) {
+            pull.head<2>() = tension[0] / x * to_anchor;
+        }
+        line_force.col(l).head<3>() = pull;
+        line_force.col(l).tail<3>() = arm.cross(pull);
+    }
+    for (int l = 0; l < num_lines; l++) {
+        force.segment<6>(6 * line_body[l]) += line_force.col(l);
+    }
+}
+
+// =============================================================================
+// LumpedMassMooring Class Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * LumpedMassMooring constructor (rho, g, max_substep)
+ *******************************************************************************/
+LumpedMassMooring::LumpedMassMooring(double rho, double g, double max_substep)
+    : rho(rho), g(g), max_substep(max_substep) {
+    if (max_substep <= 0.0) {
+        throw std::invalid_argument("LumpedMassMooring: max_substep must be positive");
+    }
+}
+
+/*******************************************************************************
+ * LumpedMassMooring::AddLine(line)
+ *******************************************************************************/
+void LumpedMassMooring::AddLine(const LumpedMassLine& line) {
+    if (line.length <= 0.0 || line.diameter <= 0.0 || line.mass <= 0.0 || line.stiffness <= 0.0) {
+        throw std::invalid_argument(
+            "LumpedMassMooring::AddLine: length, diameter, mass and stiffness must be positive");
+    }
+    if (line.num_segments < 2) {
+        throw std::invalid_argument("LumpedMassMooring::AddLine: at least 2 segments per line");
+    }
+    lines.push_back(line);
+}
+
+/*******************************************************************************
+ * LumpedMassMooring::Initialize(states)
+ * sizes the node arrays, places the nodes on the static catenary shape of each
+ * line and picks each line's sub-step
+ *******************************************************************************/
+void LumpedMassMooring::Initialize(const HydroBodyStates& states) {
+    const int num_bodies = static_cast<int>(states.position.size() / 3);
+    const int num_lines  = GetNumLines();
+
+    node_first.resize(num_lines + 1);
+    node_first[0] = 0;
+    for (int l = 0; l < num_lines; l++) {
+        node_first[l + 1] = node_first[l] + lines[l].num_segments + 1;
+    }
+    const int num_nodes = node_first[num_lines];
+    line_body.resize(num_lines);
+    line_fairlead.resize(3, num_lines);
+    fairlead_last.resize(3, num_lines);
+    fairlead_force.setZero(3, num_lines);
+    segment_length.resize(num_lines);
+    node_mass.resize(num_lines);
+    node_weight.resize(num_lines);
+    substep.resize(num_lines);
+    node_position.setZero(3, num_nodes);
+    node_velocity.setZero(3, num_nodes);
+    node_force.setZero(3, num_nodes);
+    node_tangent.setZero(3, num_nodes);
+    node_scalar.setZero(num_nodes);
+    segment_tension.setZero(3, num_nodes - num_lines);
+    segment_scalar.setZero(num_nodes - num_lines);
+
+    for (int l = 0; l < num_lines; l++) {
+        const LumpedMassLine& line = lines[l];
+        if (line.body < 0 || line.body >= num_bodies) {
+            throw std::invalid_argument("LumpedMassMooring: line " + std::to_string(l) + " body index out of range");
+        }
+        const int n          = line.num_segments;
+        const double l0      = line.length / n;
+        double section       = 0.25 * M_PI * line.diameter * line.diameter;
+        double wet           = (line.mass - rho * section) * g;
+        line_body[l]         = line.body;
+        segment_length[l]    = l0;
+        node_mass[l]         = (line.mass + line.added_mass * rho * section) * l0;
+        node_weight[l]       = wet * l0;
+        line_fairlead.col(l) = line.fairlead;
+        if (wet <= 0.0) {
+            throw std::invalid_argument("LumpedMassMooring: line " + std::to_string(l) + " is buoyant");
+        }
+
+        // static shape
+        Eigen::Vector3d fairlead =
+            states.position.segment<3>(3 * line.body) + states.orientation[line.body] * line.fairlead;
+        Eigen::Vector3d horizontal(fairlead.x() - line.anchor.x(), fairlead.y() - line.anchor.y(), 0.0);
+        double x = horizontal.norm();
+        double z = fairlead.z() - line.anchor.z();
+        if (z <= 0.0) {
+            throw std::invalid_argument("LumpedMassMooring: line " + std::to_string(l) + " fairlead below its anchor");
+        }
+        horizontal = x > 0.0 ? Eigen::Vector3d(horizontal / x) : Eigen::Vector3d::UnitX();
+        CatenaryLine catenary{line.body, line.fairlead, line.anchor, line.length, wet, line.stiffness};
+        Eigen::Vector2d tension = CatenaryMooring::SolveCatenary(catenary, x, z);
+        Eigen::Vector2d end     = CatenaryMooring::CatenaryProfile(catenary, tension[0], tension[1], line.length);
+        // exact end points (solver tolerance, line piled up on the seabed when slack)
+        double x_scale = end[0] > 0.0 ? x / end[0] : 0.0;
+        double z_scale = z / end[1];
+        for (int i = 0; i <= n; i++) {
+            Eigen::Vector2d point = CatenaryMooring::CatenaryProfile(catenary, tension[0], tension[1], i * l0);
+            node_position.col(node_first[l] + i) =
+                (line.anchor + x_scale * point[0] * horizontal + Eigen::Vector3d(0.0, 0.0, z_scale * point[1])).array();
+        }
+        fairlead_last.col(l) = fairlead;
+
+        // explicit (symplectic Euler) stability of the stiffest chain mode, 4 EA / l0 over the node mass
+        double stiffness = line.stiffness / l0;
+        double omega     = 2.0 * std::sqrt(stiffness / node_mass[l]);
+        double zeta      = (line.damping / l0) / std::sqrt(stiffness * node_mass[l]);
+        double critical  = 2.0 / omega * (std::sqrt(1.0 + zeta * zeta) - zeta);
+        substep[l]       = std::min(max_substep, 0.5 * critical);
+    }
+    started = false;
+}
+
+/*******************************************************************************
+ * LumpedMassMooring::ComputeNodeForces(line)
+ * segment tensions, then the net force on every free node and the load of the
+ * line on its fairlead (anchor node: none), each as row operations over the
+ * whole line
+ *******************************************************************************/
+void LumpedMassMooring::ComputeNodeForces(int line) {
+    const LumpedMassLine& params = lines[line];
+    const int first              = node_first[line];
+    const int n                  = node_first[line + 1] - 1 - first;  // segments
+    const int segment0           = first - line;
+    const double l0              = segment_length[line];
+    const double drag            = 0.5 * rho * params.diameter * l0;
+    const double seabed          = params.anchor.z();
+
+    auto position = node_position.middleCols(first, n + 1);
+    auto velocity = node_velocity.middleCols(first, n + 1);
+    auto tension  = segment_tension.middleCols(segment0, n);
+    auto length   = segment_scalar.segment(segment0, n);
+
+    // axial spring-damper, no compression
+    tension = position.rightCols(n) - position.leftCols(n);
+    length  = (tension.row(0).square() + tension.row(1).square() + tension.row(2).square()).sqrt();
+    auto relative = velocity.rightCols(n) - velocity.leftCols(n);
+    auto rate     = (tension.row(0) * relative.row(0) + tension.row(1) * relative.row(1) +
+                 tension.row(2) * relative.row(2)) / length;
+    auto axial    = (params.stiffness * (length - l0) + params.damping * rate) / l0;
+    length        = (length > l0).select(axial.max(0.0) / length, 0.0);  // now tension / length
+    tension.rowwise() *= length;
+
+    // free nodes: tensions, wet weight, Morison drag (normal and tangential), seabed
+    const int m   = n - 1;
+    auto force    = node_force.middleCols(first + 1, m);
+    auto tangent  = node_tangent.middleCols(first + 1, m);
+    auto scalar   = node_scalar.segment(first + 1, m);
+    auto v        = velocity.middleCols(1, m);
+    force         = tension.rightCols(m) - tension.leftCols(m);
+    force.row(2) -= node_weight[line];
+
+    tangent = position.rightCols(m) - position.leftCols(m);
+    scalar  = (tangent.row(0).square() + tangent.row(1).square() + tangent.row(2).square()).sqrt();
+    tangent.rowwise() /= scalar;
+    scalar = tangent.row(0) * v.row(0) + tangent.row(1) * v.row(1) + tangent.row(2) * v.row(2);  // v . t
+    tangent.rowwise() *= scalar;                                                                   // v_t
+    force -= (drag * params.drag_tangential * M_PI) * (tangent.rowwise() * scalar.abs());
+    tangent = v - tangent;                                                                         // v_n
+    scalar  = (tangent.row(0).square() + tangent.row(1).square() + tangent.row(2).square()).sqrt();
+    force -= (drag * params.drag_normal) * (tangent.rowwise() * scalar);
+
+    scalar = (seabed - position.row(2).segment(1, m)).max(0.0);  // penetration
+    force.row(2) += (scalar > 0.0).select(seabed_stiffness * scalar - seabed_damping * v.row(2), 0.0) *
+                    (params.diameter * l0);
+
+    node_force.col(first + n) = -tension.col(n - 1);
+    node_force(2, first + n) -= 0.5 * node_weight[line];
+}
+
+/*******************************************************************************
+ * LumpedMassMooring::Advance(line, dt, fairlead_start, fairlead_end)
+ * symplectic Euler sub-steps over dt, the fairlead node moving linearly from
+ * fairlead_start to fairlead_end, ends with the node forces of the new state
+ *******************************************************************************/
+void LumpedMassMooring::Advance(int line,
+                                double dt,
+                                const Eigen::Vector3d& fairlead_start,
+                                const Eigen::Vector3d& fairlead_end) {
+    const int first         = node_first[line];
+    const int last          = node_first[line + 1] - 1;
+    const int num_steps     = std::max(1, static_cast<int>(std::ceil(dt / substep[line] - 1e-9)));
+    const double h          = dt / num_steps;
+    const double inverse    = h / node_mass[line];
+    node_velocity.col(last) = ((fairlead_end - fairlead_start) / dt).array();
+
+    for (int step = 1; step <= num_steps; step++) {
+        ComputeNodeForces(line);
+        auto free_velocity = node_velocity.middleCols(first + 1, last - first - 1);
+        auto free_position = node_position.middleCols(first + 1, last - first - 1);
+        free_velocity += inverse * node_force.middleCols(first + 1, last - first - 1);
+        free_position += h * free_velocity;
+        double fraction         = static_cast<double>(step) / num_steps;
+        node_position.col(last) = (fairlead_start + fraction * (fairlead_end - fairlead_start)).array();
+    }
+    ComputeNodeForces(line);
+}
+
+/*******************************************************************************
+ * LumpedMassMooring::AddForce(t, states, force)
+ * advances every line to t (in parallel) and adds the fairlead loads to the
+ * bodies; the first call only evaluates the initial state
+ *******************************************************************************/
+void LumpedMassMooring::AddForce(double t, const HydroBodyStates& states, Eigen::Ref<Eigen::VectorXd> force) {
+    const int num_lines = GetNumLines();
+    const double dt     = started ? t - time_last : 0.0;
+#pragma omp parallel for if (num_lines >= min_parallel_lines)
+    for (int l = 0; l < num_lines; l++) {
+        int b                    = line_body[l];
+        Eigen::Vector3d fairlead = states.position.segment<3>(3 * b) + states.orientation[b] * line_fairlead.col(l);
+        if (dt > 0.0) {
+            Advance(l, dt, fairlead_last.col(l), fairlead);
+        } else {
+            node_position.col(node_first[l + 1] - 1) = fairlead.array();
+            ComputeNodeForces(l);
+        }
+        fairlead_force.col(l) = node_force.col(node_first[l + 1] - 1).matrix();
+        fairlead_last.col(l)  = fairlead;
+    }
+    for (int l = 0; l < num_lines; l++) {
+        int b               = line_body[l];
+        Eigen::Vector3d arm = states.orientation[b] * line_fairlead.col(l);
+        force.segment<3>(6 * b) += fairlead_force.col(l);
+        force.segment<3>(6 * b + 3) += arm.cross(fairlead_force.col(l));
+    }
+    if (dt > 0.0 || !started) {
+        time_last = t;
+    }
+    started = true;
+}
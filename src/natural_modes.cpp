@@ -0,0 +1,186 @@
+#include <hydroc/natural_modes.h>
+
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <Eigen/Eigenvalues>
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+// =============================================================================
+// NaturalModeAnalysis Class Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * NaturalModeAnalysis constructor (data, mass, dofs)
+ * gathers mass, restoring stiffness, infinite frequency added mass and the RIRF
+ * over the analysed dofs
+ *******************************************************************************/
+NaturalModeAnalysis::NaturalModeAnalysis(const HydroData& data,
+                                         const Eigen::MatrixXd& mass_matrix,
+                                         const std::vector<int>& analysed_dofs)
+    : dofs(analysed_dofs) {
+    int total_dofs = data.GetRIRFDims(1);
+    if (mass_matrix.rows() != total_dofs || mass_matrix.cols() != total_dofs) {
+        throw std::invalid_argument("NaturalModeAnalysis: expected a " + std::to_string(total_dofs) + " x " +
+                                    std::to_string(total_dofs) + " mass matrix");
+    }
+    if (dofs.empty()) {
+        for (int i = 0; i < total_dofs; i++) {
+            dofs.push_back(i);
+        }
+    }
+    for (size_t c = 0; c < dofs.size(); c++) {
+        if (dofs[c] < 0 || dofs[c] >= total_dofs || (c > 0 && dofs[c] <= dofs[c - 1])) {
+            throw std::invalid_argument("NaturalModeAnalysis: dofs must be increasing indices below " +
+                                        std::to_string(total_dofs));
+        }
+    }
+
+    int n = static_cast<int>(dofs.size());
+    mass.resize(n, n);
+    stiffness.setZero(n, n);
+    inf_added_mass.resize(n, n);
+    for (int r = 0; r < n; r++) {
+        int b                        = dofs[r] / 6;
+        Eigen::MatrixXd added_mass_b = data.GetInfAddedMassMatrix(b);  // 6 x 6N
+        for (int c = 0; c < n; c++) {
+            mass(r, c)           = mass_matrix(dofs[r], dofs[c]);
+            inf_added_mass(r, c) = added_mass_b(dofs[r] % 6, dofs[c]);
+            // restoring only acts within a body
+            if (dofs[c] / 6 == b) {
+                stiffness(r, c) = data.GetHydrostaticStiffnessVal(b, dofs[r] % 6, dofs[c] % 6);
+            }
+        }
+    }
+
+    rirf_time = data.GetRIRFTimeVector();
+    int steps = data.GetRIRFDims(2);
+    rirf_kernel.resize(n * n, steps);
+    for (int st = 0; st < steps; st++) {
+        for (int c = 0; c < n; c++) {
+            for (int r = 0; r < n; r++) {
+                rirf_kernel(r + n * c, st) = data.GetRIRFVal(dofs[r] / 6, dofs[r] % 6, dofs[c], st);
+            }
+        }
+    }
+    quadrature_weights.setZero(steps);
+    for (int st = 1; st < steps; st++) {
+        double half_dt = 0.5 * (rirf_time[st] - rirf_time[st - 1]);
+        quadrature_weights[st - 1] += half_dt;
+        quadrature_weights[st] += half_dt;
+    }
+}
+
+/*******************************************************************************
+ * NaturalModeAnalysis::GetRadiationCoefficients(omega, added_mass, damping)
+ * A(w) = A_inf - 1/w int K(t) sin(w t) dt, B(w) = int K(t) cos(w t) dt
+ *******************************************************************************/
+void NaturalModeAnalysis::GetRadiationCoefficients(double omega,
+                                                   Eigen::MatrixXd& added_mass,
+                                                   Eigen::MatrixXd& damping) const {
+    if (omega <= 0.0) {
+        throw std::invalid_argument("NaturalModeAnalysis::GetRadiationCoefficients: omega must be positive");
+    }
+    int n                        = static_cast<int>(dofs.size());
+    Eigen::ArrayXd phase         = omega * rirf_time.array();
+    Eigen::VectorXd cos_weights  = quadrature_weights.cwiseProduct(phase.cos().matrix());
+    Eigen::VectorXd sin_weights  = quadrature_weights.cwiseProduct(phase.sin().matrix());
+    Eigen::VectorXd cos_integral = rirf_kernel * cos_weights;
+    Eigen::VectorXd sin_integral = rirf_kernel * sin_weights;
+    damping                      = Eigen::Map<const Eigen::MatrixXd>(cos_integral.data(), n, n);
+    added_mass = inf_added_mass - Eigen::Map<const Eigen::MatrixXd>(sin_integral.data(), n, n) / omega;
+}
+
+/*******************************************************************************
+ * NaturalModeAnalysis::Solve(tolerance, max_iterations)
+ * undamped modes first, then per mode: state space eigenvalues of the damped
+ * model at the current frequency, the mode is the eigenvalue (upper half plane)
+ * whose shape is closest to the undamped shape (modal assurance criterion)
+ *******************************************************************************/
+std::vector<NaturalMode> NaturalModeAnalysis::Solve(double tolerance, int max_iterations) const {
+    int n = static_cast<int>(dofs.size());
+    std::vector<NaturalMode> modes;
+    if (n == 0) {
+        return modes;
+    }
+
+    // undamped modes of the symmetric parts, ascending frequency
+    Eigen::MatrixXd mass_inf = mass + inf_added_mass;
+    Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> undamped(0.5 * (stiffness + stiffness.transpose()),
+                                                                       0.5 * (mass_inf + mass_inf.transpose()));
+    if (undamped.info() != Eigen::Success) {
+        throw std::runtime_error(
+            "NaturalModeAnalysis::Solve: mass plus infinite frequency added mass is not positive definite");
+    }
+    const Eigen::VectorXd& omega_squared = undamped.eigenvalues();
+    double restoring_threshold           = 1e-8 * std::max(omega_squared.cwiseAbs().maxCoeff(), 1e-12);
+
+    Eigen::MatrixXd added_mass, damping;
+    Eigen::MatrixXd state = Eigen::MatrixXd::Zero(2 * n, 2 * n);
+    state.topRightCorner(n, n).setIdentity();
+    Eigen::EigenSolver<Eigen::MatrixXd> eigen_solver(2 * n);
+
+    for (int k = 0; k < n; k++) {
+        Eigen::VectorXcd reference = undamped.eigenvectors().col(k).cast<std::complex<double>>();
+        NaturalMode mode;
+        mode.period        = std::numeric_limits<double>::infinity();
+        mode.damping_ratio = 0.0;
+        mode.omega         = 0.0;
+        mode.shape         = reference.normalized();
+        mode.iterations    = 0;
+        mode.converged     = true;
+
+        if (omega_squared[k] > restoring_threshold) {
+            double omega   = std::sqrt(omega_squared[k]);
+            mode.converged = false;
+            while (mode.iterations < max_iterations && !mode.converged) {
+                GetRadiationCoefficients(omega, added_mass, damping);
+                Eigen::PartialPivLU<Eigen::MatrixXd> mass_lu(mass + added_mass);
+                state.bottomLeftCorner(n, n)  = -mass_lu.solve(stiffness);
+                state.bottomRightCorner(n, n) = -mass_lu.solve(damping);
+                eigen_solver.compute(state);
+                mode.iterations++;
+
+                // best match of the previous shape among the eigenvalues with Im >= 0
+                int best        = -1;
+                double best_mac = -1.0;
+                for (int j = 0; j < 2 * n; j++) {
+                    if (eigen_solver.eigenvalues()[j].imag() < 0.0) {
+                        continue;
+                    }
+                    Eigen::VectorXcd shape = eigen_solver.eigenvectors().col(j).head(n);
+                    double mac = std::norm(reference.dot(shape)) / (reference.squaredNorm() * shape.squaredNorm());
+                    if (mac > best_mac) {
+                        best     = j;
+                        best_mac = mac;
+                    }
+                }
+                std::complex<double> lambda = eigen_solver.eigenvalues()[best];
+                reference                   = eigen_solver.eigenvectors().col(best).head(n).normalized();
+                mode.damping_ratio          = -lambda.real() / std::abs(lambda);
+                mode.omega                  = lambda.imag();
+                if (mode.omega <= 0.0) {
+                    // overdamped: no oscillation left to evaluate the coefficients at
+                    mode.converged = true;
+                    break;
+                }
+                mode.converged = std::abs(mode.omega - omega) <= tolerance * mode.omega;
+                omega          = mode.omega;
+            }
+            mode.shape = reference;
+            if (mode.omega > 0.0) {
+                mode.period = 2.0 * M_PI / mode.omega;
+            }
+        }
+        mode.shape.cwiseAbs().maxCoeff(&mode.dof);
+        mode.dof = dofs[mode.dof];
+        modes.push_back(mode);
+    }
+    return modes;
+}
@@ -0,0 +1,123 @@
+#include <hydroc/viscous_drag.h>
+
+#include <stdexcept>
+
+// =============================================================================
+// ViscousDrag Class Definitions
+// =============================================================================
+
+/*******************************************************************************
+ * ViscousDrag constructor (num_bodies, rho)
+ *******************************************************************************/
+ViscousDrag::ViscousDrag(int num_bodies, double rho) : num_bodies(num_bodies), rho(rho) {
+    body_drag.setZero(6, 6 * num_bodies);
+    drag_velocity.setZero(6 * num_bodies);
+    morison_first.assign(num_bodies + 1, 0);
+}
+
+/*******************************************************************************
+ * ViscousDrag::SetQuadraticDrag(b, drag)
+ *******************************************************************************/
+void ViscousDrag::SetQuadraticDrag(int b, const Eigen::Matrix<double, 6, 6>& drag) {
+    if (b < 0 || b >= num_bodies) {
+        throw std::invalid_argument("TestHydro::SetQuadraticDrag: body index out of range");
+    }
+    body_drag.middleCols<6>(6 * b) = drag;
+    has_body_drag                  = !body_drag.isZero(0.0);
+}
+
+/*******************************************************************************
+ * ViscousDrag::AddMorisonElement(b, position, axis, drag_coefficient, area)
+ * inserts the element at the end of body b's column range and resizes the
+ * scratch arrays, so nothing is allocated while stepping
+ *******************************************************************************/
+void ViscousDrag::AddMorisonElement(int b,
+                                    const Eigen::Vector3d& position,
+                                    const Eigen::Vector3d& axis,
+                                    double drag_coefficient,
+                                    double area) {
+    if (b < 0 || b >= num_bodies) {
+        throw std::invalid_argument("TestHydro::AddMorisonElement: body index out of range");
+    }
+    if (drag_coefficient < 0.0 || area < 0.0) {
+        throw std::invalid_argument("TestHydro::AddMorisonElement: negative drag coefficient or area");
+    }
+    int count  = static_cast<int>(morison_coefficient.size());
+    int column = morison_first[b + 1];
+    int tail   = count - column;
+
+    Eigen::Matrix3Xd positions(3, count + 1);
+    Eigen::Matrix3Xd axes(3, count + 1);
+    Eigen::RowVectorXd coefficients(count + 1);
+    positions << morison_position.leftCols(column), position, morison_position.rightCols(tail);
+    axes << morison_axis.leftCols(column), axis.isZero(0.0) ? axis : axis.normalized(), morison_axis.rightCols(tail);
+    coefficients << morison_coefficient.head(column), 0.5 * rho * drag_coefficient * area,
+        morison_coefficient.tail(tail);
+    morison_position.swap(positions);
+    morison_axis.swap(axes);
+    morison_coefficient.swap(coefficients);
+    for (int i = b + 1; i <= num_bodies; i++) {
+        morison_first[i]++;
+    }
+
+    morison_arm.setZero(3, count + 1);
+    morison_normal.setZero(3, count + 1);
+    morison_velocity.setZero(3, count + 1);
+    morison_scratch.setZero(count + 1);
+}
+
+/*******************************************************************************
+ * ViscousDrag::ComputeForce(t, states, waves, force)
+ * quadratic drag of all bodies and Morison elements on the velocity relative
+ * to the wave particle velocity. Each stage runs over every body / element at
+ * once on the contiguous arrays; only the wave velocity lookup is per point.
+ *******************************************************************************/
+void ViscousDrag::ComputeForce(double t, const HydroBodyStates& states, WaveBase& waves, Eigen::VectorXd& force) {
+    force.setZero();
+
+    if (has_body_drag) {
+        drag_velocity = states.velocity;
+        for (int b = 0; b < num_bodies; b++) {
+            Eigen::Vector3d cog(states.position[3 * b], states.position[3 * b + 1], states.position[3 * b + 2]);
+            drag_velocity.segment<3>(6 * b) -= waves.GetParticleVelocity(cog, t);
+        }
+        drag_velocity.array() *= drag_velocity.array().abs();
+        for (int b = 0; b < num_bodies; b++) {
+            force.segment<6>(6 * b).noalias() -= body_drag.middleCols<6>(6 * b) * drag_velocity.segment<6>(6 * b);
+        }
+    }
+
+    if (morison_coefficient.size() == 0) {
+        return;
+    }
+    // world frame arms, axes and rigid body point velocities
+    for (int b = 0; b < num_bodies; b++) {
+        int first = morison_first[b];
+        int count = morison_first[b + 1] - first;
+        if (count == 0) {
+            continue;
+        }
+        const Eigen::Matrix3d& rot = states.orientation[b];
+        Eigen::Vector3d v          = states.velocity.segment<3>(6 * b);
+        Eigen::Vector3d w          = states.velocity.segment<3>(6 * b + 3);
+        Eigen::Vector3d cog(states.position[3 * b], states.position[3 * b + 1], states.position[3 * b + 2]);
+        morison_arm.middleCols(first, count).noalias()    = rot.lazyProduct(morison_position.middleCols(first, count));
+        morison_normal.middleCols(first, count).noalias() = rot.lazyProduct(morison_axis.middleCols(first, count));
+        for (int j = first; j < first + count; j++) {
+            morison_velocity.col(j) =
+                v + w.cross(morison_arm.col(j)) - waves.GetParticleVelocity(cog + morison_arm.col(j), t);
+        }
+    }
+    // remove the axial part, then F = -c |v_n| v_n
+    morison_scratch = morison_velocity.cwiseProduct(morison_normal).colwise().sum();
+    morison_velocity -= morison_normal * morison_scratch.asDiagonal();
+    morison_scratch = -morison_velocity.colwise().norm().cwiseProduct(morison_coefficient);
+    morison_velocity *= morison_scratch.asDiagonal();
+    // back to force and torque about the center of gravity of each body
+    for (int b = 0; b < num_bodies; b++) {
+        for (int j = morison_first[b]; j < morison_first[b + 1]; j++) {
+            force.segment<3>(6 * b) += morison_velocity.col(j);
+            force.segment<3>(6 * b + 3) += morison_arm.col(j).cross(morison_velocity.col(j));
+        }
+    }
+}
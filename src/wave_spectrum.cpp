@@ -0,0 +1,157 @@
+#include <hydroc/wave_spectrum.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+// 5/16 Hs^2 fp^4 f^-5 exp(-5/4 (fp / f)^4), NaN / inf at f <= 0 (masked by the callers)
+Eigen::ArrayXd PiersonMoskowitzShape(const Eigen::ArrayXd& f, double hs, double fp) {
+    double fp4            = fp * fp * fp * fp;
+    Eigen::ArrayXd inv_f4 = f.inverse().square().square();
+    return (5.0 / 16.0 * hs * hs * fp4) * inv_f4 / f * (-1.25 * fp4 * inv_f4).exp();
+}
+
+// gamma^r, r = exp(-(f - fp)^2 / (2 sigma^2 fp^2))
+Eigen::ArrayXd PeakEnhancement(const Eigen::ArrayXd& f, double fp, double gamma, double sigma_a, double sigma_b) {
+    auto two_sigma2_fp2 = (f <= fp).select(Eigen::ArrayXd::Constant(f.size(), 2.0 * sigma_a * sigma_a * fp * fp),
+                                           2.0 * sigma_b * sigma_b * fp * fp);
+    return (std::log(gamma) * (-(f - fp).square() / two_sigma2_fp2).exp()).exp();
+}
+
+Eigen::VectorXd ZeroAtNonPositive(const Eigen::VectorXd& freqs_hz, const Eigen::ArrayXd& densities) {
+    return (freqs_hz.array() > 0.0).select(densities, 0.0).matrix();
+}
+
+void CheckSeaState(const char* name, double hs, double period) {
+    if (!(hs >= 0.0) || !(period > 0.0)) {
+        throw std::invalid_argument(std::string(name) + ": expected Hs >= 0 and a positive period");
+    }
+}
+}  // namespace
+
+// =============================================================================
+// WaveSpectrum Class Definitions
+// =============================================================================
+
+PiersonMoskowitzSpectrum::PiersonMoskowitzSpectrum(double significant_wave_height, double peak_period)
+    : hs(significant_wave_height), tp(peak_period) {
+    CheckSeaState("PiersonMoskowitzSpectrum", hs, tp);
+}
+
+Eigen::VectorXd PiersonMoskowitzSpectrum::Evaluate(const Eigen::VectorXd& freqs_hz) const {
+    return ZeroAtNonPositive(freqs_hz, PiersonMoskowitzShape(freqs_hz.array(), hs, 1.0 / tp));
+}
+
+BretschneiderSpectrum::BretschneiderSpectrum(double significant_wave_height, double zero_crossing_period)
+    : PiersonMoskowitzSpectrum(significant_wave_height, std::pow(1.25 * M_PI, 0.25) * zero_crossing_period) {}
+
+/*******************************************************************************
+ * JonswapSpectrum constructor
+ * m0 of the enhanced shape by the trapezoidal rule over (0, 20 fp], fine enough
+ * for the narrowest peaks in use (sigma fp over 70 points at sigma = 0.07), and
+ * the Pierson-Moskowitz tail above
+ *******************************************************************************/
+JonswapSpectrum::JonswapSpectrum(double significant_wave_height,
+                                 double peak_period,
+                                 double gamma,
+                                 double sigma_a,
+                                 double sigma_b)
+    : hs(significant_wave_height), tp(peak_period), gamma(gamma), sigma_a(sigma_a), sigma_b(sigma_b), scale(1.0) {
+    CheckSeaState("JonswapSpectrum", hs, tp);
+    if (!(gamma >= 1.0) || !(sigma_a > 0.0) || !(sigma_b > 0.0)) {
+        throw std::invalid_argument("JonswapSpectrum: expected gamma >= 1 and positive sigma_a, sigma_b");
+    }
+    if (hs == 0.0) {
+        return;
+    }
+    const int num_points = 20000;
+    double fp            = 1.0 / tp;
+    double df            = 20.0 * fp / num_points;
+    Eigen::ArrayXd f     = Eigen::ArrayXd::LinSpaced(num_points, df, 20.0 * fp);
+    Eigen::ArrayXd s     = PiersonMoskowitzShape(f, hs, fp) * PeakEnhancement(f, fp, gamma, sigma_a, sigma_b);
+    // S(0) = 0, the tail above 20 fp is Pierson-Moskowitz: 5/64 Hs^2 fp^4 f^-4
+    double m0 = df * (s.sum() - 0.5 * s[num_points - 1]) + 5.0 / 64.0 * hs * hs / (20.0 * 20.0 * 20.0 * 20.0);
+    scale                = hs * hs / 16.0 / m0;
+}
+
+Eigen::VectorXd JonswapSpectrum::Evaluate(const Eigen::VectorXd& freqs_hz) const {
+    double fp                = 1.0 / tp;
+    Eigen::ArrayXd f         = freqs_hz.array();
+    Eigen::ArrayXd densities = PiersonMoskowitzShape(f, hs, fp) * PeakEnhancement(f, fp, gamma, sigma_a, sigma_b);
+    return ZeroAtNonPositive(freqs_hz, scale * densities);
+}
+
+OchiHubbleSpectrum::OchiHubbleSpectrum(const std::vector<OchiHubblePeak>& peaks) : peaks(peaks) {
+    if (peaks.empty()) {
+        throw std::invalid_argument("OchiHubbleSpectrum: expected at least one peak");
+    }
+    for (const OchiHubblePeak& peak : peaks) {
+        CheckSeaState("OchiHubbleSpectrum", peak.significant_wave_height, peak.peak_period);
+        if (!(peak.shape > 0.0)) {
+            throw std::invalid_argument("OchiHubbleSpectrum: expected a positive shape parameter");
+        }
+        double omega_p = 2.0 * M_PI / peak.peak_period;
+        double hs      = peak.significant_wave_height;
+        double lambda  = peak.shape;
+        log_factors.push_back(std::log(0.5 * M_PI * hs * hs) - std::lgamma(lambda) +
+                              lambda * std::log((4.0 * lambda + 1.0) / 4.0 * std::pow(omega_p, 4)));
+    }
+}
+
+Eigen::VectorXd OchiHubbleSpectrum::Evaluate(const Eigen::VectorXd& freqs_hz) const {
+    Eigen::ArrayXd omega      = 2.0 * M_PI * freqs_hz.array();
+    Eigen::ArrayXd log_omega  = omega.log();
+    Eigen::ArrayXd inv_omega4 = omega.inverse().square().square();
+    Eigen::ArrayXd densities  = Eigen::ArrayXd::Zero(omega.size());
+    for (size_t j = 0; j < peaks.size(); j++) {
+        if (peaks[j].significant_wave_height == 0.0) {
+            continue;
+        }
+        double exponent = 4.0 * peaks[j].shape + 1.0;
+        double omega_p  = 2.0 * M_PI / peaks[j].peak_period;
+        double omega_p4 = omega_p * omega_p * omega_p * omega_p;
+        densities += (log_factors[j] - exponent * log_omega - 0.25 * exponent * omega_p4 * inv_omega4).exp();
+    }
+    return ZeroAtNonPositive(freqs_hz, densities);
+}
+
+TabulatedSpectrum::TabulatedSpectrum(const Eigen::VectorXd& freqs_hz, const Eigen::VectorXd& spectral_densities)
+    : table_freqs(freqs_hz), table_densities(spectral_densities) {
+    if (freqs_hz.size() < 2 || freqs_hz.size() != spectral_densities.size()) {
+        throw std::invalid_argument("TabulatedSpectrum: expected at least two frequencies, one density each");
+    }
+    for (int i = 0; i < freqs_hz.size(); i++) {
+        if ((i > 0 && !(freqs_hz[i] > freqs_hz[i - 1])) || !(spectral_densities[i] >= 0.0)) {
+            throw std::invalid_argument(
+                "TabulatedSpectrum: expected increasing frequencies and non negative densities");
+        }
+    }
+}
+
+/*******************************************************************************
+ * TabulatedSpectrum::Evaluate()
+ * binary search per frequency (std::upper_bound), linear interpolation
+ *******************************************************************************/
+Eigen::VectorXd TabulatedSpectrum::Evaluate(const Eigen::VectorXd& freqs_hz) const {
+    Eigen::VectorXd densities(freqs_hz.size());
+    const double* begin = table_freqs.data();
+    const double* end   = begin + table_freqs.size();
+    for (int i = 0; i < freqs_hz.size(); i++) {
+        double f = freqs_hz[i];
+        if (!(f >= *begin) || !(f <= *(end - 1))) {
+            densities[i] = 0.0;
+            continue;
+        }
+        int k        = static_cast<int>(std::upper_bound(begin, end, f) - begin);
+        k            = std::min(std::max(k, 1), static_cast<int>(table_freqs.size()) - 1);
+        double s     = (f - table_freqs[k - 1]) / (table_freqs[k] - table_freqs[k - 1]);
+        densities[i] = (1.0 - s) * table_densities[k - 1] + s * table_densities[k];
+    }
+    return densities;
+}
@@ -1,14 +1,23 @@
+#include <hydroc/helper.h>
 #include <hydroc/wave_types.h>
+#include <unsupported/Eigen/FFT>
 #include <unsupported/Eigen/Splines>
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
 // NoWave class definitions:
-Eigen::VectorXd NoWave::GetForceAtTime(double t) {
+void NoWave::GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) {
     unsigned int dof = num_bodies * 6;
-    Eigen::VectorXd f(dof);
+    assert(f.size() >= dof);
     for (int i = 0; i < dof; i++) {
         f[i] = 0.0;
     }
-    return f;
 }
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Regular wave class definitions:
@@ -25,37 +34,93 @@ void RegularWave::Initialize() {
     int total_dofs = 6 * num_bodies;
     excitation_force_mag.resize(total_dofs);
     excitation_force_phase.resize(total_dofs);
-    force.resize(total_dofs);
 
     double wave_omega_delta = GetOmegaDelta();
     double freq_index_des   = (regular_wave_omega / wave_omega_delta) - 1;
     for (int b = 0; b < num_bodies; b++) {
+        const HydroData::RegularWaveInfo& info = wave_info[b];
+        if (scattering_excitation_only && info.scattering_mag_matrix.size() == 0) {
+            throw std::runtime_error(
+                "RegularWave: scattering_excitation_only needs the excitation/scattering coefficients in the h5 file");
+        }
+        const auto& mag   = scattering_excitation_only ? info.scattering_mag_matrix : info.excitation_mag_matrix;
+        const auto& phase = scattering_excitation_only ? info.scattering_phase_matrix : info.excitation_phase_matrix;
         for (int rowEx = 0; rowEx < 6; rowEx++) {
             int body_offset = 6 * b;
             // why are these always 0? vvv TODO check/change this
-            excitation_force_mag[body_offset + rowEx]   = GetExcitationMagInterp(b, rowEx, 0, freq_index_des);
-            excitation_force_phase[body_offset + rowEx] = GetExcitationPhaseInterp(b, rowEx, 0, freq_index_des);
+            excitation_force_mag[body_offset + rowEx]   = GetExcitationMagInterp(mag, rowEx, 0, freq_index_des);
+            excitation_force_phase[body_offset + rowEx] = GetExcitationPhaseInterp(phase, rowEx, 0, freq_index_des);
         }
     }
+    // phasor parts of mag A cos(omega t + phase) = mag A cos(phase) cos(omega t) - mag A sin(phase) sin(omega t)
+    Eigen::ArrayXd scaled_mag = regular_wave_amplitude * excitation_force_mag.array();
+    excitation_force_cos      = (scaled_mag * excitation_force_phase.array().cos()).matrix();
+    excitation_force_sin      = (scaled_mag * excitation_force_phase.array().sin()).matrix();
+
+    // incident wave field, finite depth unless the h5 file gives none (or infinite)
+    double g    = sim_data.g > 0.0 ? sim_data.g : 9.81;
+    double h    = sim_data.water_depth;
+    bool finite = std::isfinite(h) && h > 0.0;
+    wave_number = ComputeWaveNumbers({regular_wave_omega}, finite ? h : 1.0e4, g)[0];
+    depth_decay = finite ? std::exp(-2.0 * wave_number * h) : 0.0;
 }
 
-void RegularWave::AddH5Data(std::vector<HydroData::RegularWaveInfo>& reg_h5_data) {
-    wave_info = reg_h5_data;
+void RegularWave::AddH5Data(std::vector<HydroData::RegularWaveInfo>& reg_h5_data,
+                            HydroData::SimulationParameters& sim_data) {
+    wave_info      = reg_h5_data;
+    this->sim_data = sim_data;
 }
 
-// should return a 6N long vector
-Eigen::VectorXd RegularWave::GetForceAtTime(double t) {
-    unsigned int dof = num_bodies * 6;
-    Eigen::VectorXd f(dof);
-    // initialize the force here:
-    for (int b = 0; b < num_bodies; b++) {
-        int body_offset = 6 * b;
-        for (int rowEx = 0; rowEx < 6; rowEx++) {
-            f[body_offset + rowEx] = excitation_force_mag[body_offset + rowEx] * regular_wave_amplitude *
-                                     cos(regular_wave_omega * t + excitation_force_phase[rowEx]);
+double RegularWave::GetElevation(const Eigen::Vector3d& p, double t) {
+    return regular_wave_amplitude * std::cos(regular_wave_omega * t - wave_number * p.x());
+}
+
+/*******************************************************************************
+ * RegularWave::GetPressureHead()
+ * linear (Airy) dynamic pressure over rho g:
+ * A cosh(k (z + h)) / cosh(k h) cos(omega t - k x), written with exp(-2 k h)
+ * so that it does not overflow in deep water
+ *******************************************************************************/
+double RegularWave::GetPressureHead(const Eigen::Vector3d& p, double t, Eigen::Vector3d* gradient) {
+    double k       = wave_number;
+    double z       = std::min(p.z(), 0.0);
+    double e_up    = std::exp(k * z);
+    double e_down  = depth_decay > 0.0 ? depth_decay * std::exp(-k * z) : 0.0;
+    double profile = (e_up + e_down) / (1.0 + depth_decay);
+    double phase   = regular_wave_omega * t - wave_number * p.x();
+    double head    = regular_wave_amplitude * profile * std::cos(phase);
+    if (gradient) {
+        (*gradient)[0] = regular_wave_amplitude * profile * k * std::sin(phase);
+        (*gradient)[1] = 0.0;
+        (*gradient)[2] = p.z() < 0.0 ? regular_wave_amplitude * k * (e_up - e_down) / (1.0 + depth_decay) *
+                                           std::cos(phase)
+                                     : 0.0;
+    }
+    return head;
+}
+
+/*******************************************************************************
+ * RegularWave::GetForceAtTime()
+ * fills the first 6N entries of f with the real part of the excitation phasors
+ * rotated to time t: one cos / sin pair for all dofs
+ *******************************************************************************/
+void RegularWave::GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) {
+    int dof = excitation_force_cos.size();
+    assert(f.size() >= dof);
+    double phase = regular_wave_omega * t;
+    f.head(dof)  = std::cos(phase) * excitation_force_cos - std::sin(phase) * excitation_force_sin;
+}
+
+/*******************************************************************************
+ * RegularWave::MaskExcitationDofs()
+ *******************************************************************************/
+void RegularWave::MaskExcitationDofs(const std::vector<char>& dof_active) {
+    for (int i = 0; i < excitation_force_cos.size(); i++) {
+        if (!dof_active[i]) {
+            excitation_force_cos[i] = 0.0;
+            excitation_force_sin[i] = 0.0;
         }
     }
-    return f;
 }
 
 // put more reg wave forces here:
@@ -74,10 +139,13 @@ double RegularWave::GetOmegaDelta() const {
  * RegularWave::GetExcitationMagInterp()
  * returns excitation magnitudes for body b, row i, column j, frequency ix k
  *******************************************************************************/
-double RegularWave::GetExcitationMagInterp(int b, int i, int j, double freq_index_des) const {
+double RegularWave::GetExcitationMagInterp(const Eigen::Tensor<double, 3>& mag,
+                                           int i,
+                                           int j,
+                                           double freq_index_des) const {
     double freq_interp_val    = freq_index_des - floor(freq_index_des);
-    double excitationMagFloor = wave_info[b].excitation_mag_matrix(i, j, (int)floor(freq_index_des));
-    double excitationMagCeil  = wave_info[b].excitation_mag_matrix(i, j, (int)floor(freq_index_des) + 1);
+    double excitationMagFloor = mag(i, j, (int)floor(freq_index_des));
+    double excitationMagCeil  = mag(i, j, (int)floor(freq_index_des) + 1);
     double excitationMag      = (freq_interp_val * (excitationMagCeil - excitationMagFloor)) + excitationMagFloor;
 
     return excitationMag;
@@ -87,18 +155,531 @@ double RegularWave::GetExcitationMagInterp(int b, int i, int j, double freq_inde
  * RegularWave::GetExcitationPhaseInterp()
  * returns excitation phases for row i, column j, frequency ix k
  *******************************************************************************/
-double RegularWave::GetExcitationPhaseInterp(int b, int i, int j, double freq_index_des) const {
+double RegularWave::GetExcitationPhaseInterp(const Eigen::Tensor<double, 3>& phase,
+                                             int i,
+                                             int j,
+                                             double freq_index_des) const {
     double freq_interp_val      = freq_index_des - floor(freq_index_des);  // look into c++ modf TODO
-    double excitationPhaseFloor = wave_info[b].excitation_phase_matrix(
+    double excitationPhaseFloor = phase(
         i, j, (int)floor(freq_index_des));  // TODO check if freq_index_des is >0, if so just cast instead of floor
-    double excitationPhaseCeil = wave_info[b].excitation_phase_matrix(i, j, (int)floor(freq_index_des) + 1);
+    double excitationPhaseCeil = phase(i, j, (int)floor(freq_index_des) + 1);
     double excitationPhase = (freq_interp_val * (excitationPhaseCeil - excitationPhaseFloor)) + excitationPhaseFloor;
 
     return excitationPhase;
 }
 
+/*******************************************************************************
+ * RegularWave::GetParticleVelocity()
+ * linear (Airy) orbital velocity, horizontal A omega cosh(k (z + h)) / sinh(k h)
+ * and vertical A omega sinh(k (z + h)) / sinh(k h) profiles (exp(k z) in deep water)
+ *******************************************************************************/
+Eigen::Vector3d RegularWave::GetParticleVelocity(const Eigen::Vector3d& p, double t) {
+    double k      = wave_number;
+    double z      = std::min(p.z(), 0.0);
+    double e_up   = std::exp(k * z);
+    double e_down = depth_decay > 0.0 ? depth_decay * std::exp(-k * z) : 0.0;
+    double scale  = regular_wave_amplitude * regular_wave_omega / (1.0 - depth_decay);
+    double phase  = regular_wave_omega * t - wave_number * p.x();
+    return Eigen::Vector3d(scale * (e_up + e_down) * std::cos(phase), 0.0, -scale * (e_up - e_down) * std::sin(phase));
+}
+
+/*******************************************************************************
+ * RegularWave::GetWaveComponents()
+ * the single component A cos(omega t)
+ *******************************************************************************/
+void RegularWave::GetWaveComponents(Eigen::VectorXd& omegas, Eigen::VectorXd& amplitudes, Eigen::VectorXd& phases) {
+    omegas.setConstant(1, regular_wave_omega);
+    amplitudes.setConstant(1, regular_wave_amplitude);
+    phases.setZero(1);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Polychromatic wave class definitions:
+PolychromaticWave::PolychromaticWave() {
+    num_bodies = 1;
+}
+
+PolychromaticWave::PolychromaticWave(unsigned int num_b) {
+    num_bodies = num_b;
+}
+
+void PolychromaticWave::AddComponent(double amplitude, double omega, double phase) {
+    if (!(omega > 0.0)) {
+        throw std::invalid_argument("PolychromaticWave::AddComponent: omega must be positive");
+    }
+    components.push_back({amplitude, omega, phase});
+}
+
+void PolychromaticWave::AddH5Data(std::vector<HydroData::RegularWaveInfo>& reg_h5_data,
+                                  HydroData::SimulationParameters& sim_data) {
+    wave_info      = reg_h5_data;
+    this->sim_data = sim_data;
+}
+
+/*******************************************************************************
+ * PolychromaticWave::Initialize()
+ * excitation coefficients interpolated (linearly, on the h5 frequency grid as
+ * RegularWave) at each component frequency, folded with the component
+ * amplitude and phase into the phasor tables; wave numbers of the components
+ *******************************************************************************/
+void PolychromaticWave::Initialize() {
+    int total_dofs     = 6 * num_bodies;
+    int num_components = static_cast<int>(components.size());
+    omegas.resize(num_components);
+    amplitudes.resize(num_components);
+    phases.resize(num_components);
+    for (int i = 0; i < num_components; i++) {
+        omegas[i]     = components[i].omega;
+        amplitudes[i] = components[i].amplitude;
+        phases[i]     = components[i].phase;
+    }
+
+    excitation_cos.resize(total_dofs, num_components);
+    excitation_sin.resize(total_dofs, num_components);
+    for (int b = 0; b < num_bodies; b++) {
+        const HydroData::RegularWaveInfo& info = wave_info[b];
+        if (scattering_excitation_only && info.scattering_mag_matrix.size() == 0) {
+            throw std::runtime_error(
+                "PolychromaticWave: scattering_excitation_only needs the scattering coefficients in the h5 file");
+        }
+        const auto& mag   = scattering_excitation_only ? info.scattering_mag_matrix : info.excitation_mag_matrix;
+        const auto& phase = scattering_excitation_only ? info.scattering_phase_matrix : info.excitation_phase_matrix;
+        int num_freqs     = static_cast<int>(info.freq_list.size());
+        double omega_max  = info.freq_list[num_freqs - 1];
+        double d_omega    = omega_max / num_freqs;
+        for (int i = 0; i < num_components; i++) {
+            if (omegas[i] < d_omega || omegas[i] > omega_max) {
+                throw std::invalid_argument("PolychromaticWave: component frequency " + std::to_string(omegas[i]) +
+                                            " rad/s is outside the h5 frequency range");
+            }
+            double freq_index_des = omegas[i] / d_omega - 1.0;
+            int floor_index       = std::min(static_cast<int>(freq_index_des), num_freqs - 2);
+            double s              = freq_index_des - floor_index;
+            for (int dof = 0; dof < 6; dof++) {
+                double m = (1.0 - s) * mag(dof, 0, floor_index) + s * mag(dof, 0, floor_index + 1);
+                double p = (1.0 - s) * phase(dof, 0, floor_index) + s * phase(dof, 0, floor_index + 1);
+                excitation_cos(6 * b + dof, i) = m * amplitudes[i] * std::cos(p + phases[i]);
+                excitation_sin(6 * b + dof, i) = m * amplitudes[i] * std::sin(p + phases[i]);
+            }
+        }
+    }
+
+    double g    = sim_data.g > 0.0 ? sim_data.g : 9.81;
+    double h    = sim_data.water_depth;
+    bool finite = std::isfinite(h) && h > 0.0;
+    std::vector<double> k =
+        ComputeWaveNumbers(std::vector<double>(omegas.data(), omegas.data() + num_components), finite ? h : 1.0e4, g);
+    wave_numbers = Eigen::Map<Eigen::VectorXd>(k.data(), num_components);
+    depth_decays.setZero(num_components);
+    if (finite) {
+        depth_decays = (-2.0 * h * wave_numbers.array()).exp().matrix();
+    }
+
+    theta.resize(num_components);
+    cos_theta.resize(num_components);
+    sin_theta.resize(num_components);
+}
+
+/*******************************************************************************
+ * PolychromaticWave::GetForceAtTime()
+ * fills the first 6N entries of f: sum over the components of
+ * mag A cos(omega t + excitation phase + phase)
+ *******************************************************************************/
+void PolychromaticWave::GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) {
+    int dof = excitation_cos.rows();
+    assert(f.size() >= dof);
+    theta = t * omegas.array();
+    SinCos(theta, sin_theta, cos_theta);
+    f.head(dof).noalias() = excitation_cos * cos_theta.matrix();
+    f.head(dof).noalias() -= excitation_sin * sin_theta.matrix();
+}
+
+/*******************************************************************************
+ * PolychromaticWave::MaskExcitationDofs()
+ *******************************************************************************/
+void PolychromaticWave::MaskExcitationDofs(const std::vector<char>& dof_active) {
+    for (int i = 0; i < excitation_cos.rows(); i++) {
+        if (!dof_active[i]) {
+            excitation_cos.row(i).setZero();
+            excitation_sin.row(i).setZero();
+        }
+    }
+}
+
+double PolychromaticWave::GetElevation(const Eigen::Vector3d& p, double t) {
+    double elevation = 0.0;
+    for (int i = 0; i < omegas.size(); i++) {
+        elevation += amplitudes[i] * std::cos(omegas[i] * t - wave_numbers[i] * p.x() + phases[i]);
+    }
+    return elevation;
+}
+
+/*******************************************************************************
+ * PolychromaticWave::GetPressureHead()
+ * sum of the components' Airy pressure heads (see RegularWave::GetPressureHead)
+ *******************************************************************************/
+double PolychromaticWave::GetPressureHead(const Eigen::Vector3d& p, double t, Eigen::Vector3d* gradient) {
+    double z    = std::min(p.z(), 0.0);
+    double head = 0.0;
+    if (gradient) {
+        gradient->setZero();
+    }
+    for (int i = 0; i < omegas.size(); i++) {
+        double k       = wave_numbers[i];
+        double e_up    = std::exp(k * z);
+        double e_down  = depth_decays[i] > 0.0 ? depth_decays[i] * std::exp(-k * z) : 0.0;
+        double profile = (e_up + e_down) / (1.0 + depth_decays[i]);
+        double phase   = omegas[i] * t - k * p.x() + phases[i];
+        head += amplitudes[i] * profile * std::cos(phase);
+        if (gradient) {
+            (*gradient)[0] += amplitudes[i] * profile * k * std::sin(phase);
+            if (p.z() < 0.0) {
+                (*gradient)[2] += amplitudes[i] * k * (e_up - e_down) / (1.0 + depth_decays[i]) * std::cos(phase);
+            }
+        }
+    }
+    return head;
+}
+
+/*******************************************************************************
+ * PolychromaticWave::GetParticleVelocity()
+ * sum of the components' Airy orbital velocities (see RegularWave)
+ *******************************************************************************/
+Eigen::Vector3d PolychromaticWave::GetParticleVelocity(const Eigen::Vector3d& p, double t) {
+    double z = std::min(p.z(), 0.0);
+    Eigen::Vector3d velocity(0.0, 0.0, 0.0);
+    for (int i = 0; i < omegas.size(); i++) {
+        double k      = wave_numbers[i];
+        double e_up   = std::exp(k * z);
+        double e_down = depth_decays[i] > 0.0 ? depth_decays[i] * std::exp(-k * z) : 0.0;
+        double scale  = amplitudes[i] * omegas[i] / (1.0 - depth_decays[i]);
+        double phase  = omegas[i] * t - k * p.x() + phases[i];
+        velocity[0] += scale * (e_up + e_down) * std::cos(phase);
+        velocity[2] -= scale * (e_up - e_down) * std::sin(phase);
+    }
+    return velocity;
+}
+
+/*******************************************************************************
+ * PolychromaticWave::GetWaveComponents()
+ *******************************************************************************/
+void PolychromaticWave::GetWaveComponents(Eigen::VectorXd& omegas_out,
+                                          Eigen::VectorXd& amplitudes_out,
+                                          Eigen::VectorXd& phases_out) {
+    omegas_out     = omegas;
+    amplitudes_out = amplitudes;
+    phases_out     = phases;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// =============================================================================
+// IrregularExcitationStream
+// =============================================================================
+
+// The excitation force of IrregularWave's streaming mode, one chunk of chunk_steps time steps (plus the
+// next one, for the interpolation) at a time. Everything a chunk needs (elevation segment, cos / sin table
+// of the elevation, kernel spectra and FFT buffers) is sized in the constructor and two chunk buffers swap
+// roles (current / prefetched), so loading a chunk allocates nothing. The prefetch runs on one worker
+// thread that lives as long as the stream; the chunk scratch is used by one thread at a time, the caller
+// only computes a chunk while the worker is idle.
+class IrregularExcitationStream {
+  public:
+    IrregularExcitationStream(const Eigen::VectorXd& omegas,
+                              const Eigen::VectorXd& amplitudes,
+                              const Eigen::VectorXd& phases,
+                              const std::vector<Eigen::MatrixXd>& kernels,
+                              const std::vector<int>& kernel_first_step,
+                              double dt,
+                              double ramp_duration,
+                              int chunk_steps,
+                              bool prefetch);
+    ~IrregularExcitationStream();
+    IrregularExcitationStream(const IrregularExcitationStream&) = delete;
+    IrregularExcitationStream& operator=(const IrregularExcitationStream&) = delete;
+
+    // linear interpolation between the steps around t (t < 0: t = 0) into the first 6N entries of f
+    void GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f);
+    // zeroes the kernels and the chunks (current and prefetched) of the dofs with dof_active[i] == 0
+    void MaskDofs(const std::vector<char>& dof_active);
+
+  private:
+    void LoadChunk(int first_step);
+    void ComputeChunk(int first_step, Eigen::MatrixXd& force);
+    void RunWorker();
+
+    int num_bodies;
+    int chunk_steps;
+    double dt;
+    double ramp_duration;
+    std::vector<int> kernel_first_step;  // per body, first IRF time in steps of dt
+    int highest_step;                    // last IRF time of all bodies, in steps of dt
+    int convolution_size;
+    // elevation: cos / sin(omega_i m dt) for the offsets m of a table_steps block
+    Eigen::ArrayXd omegas;
+    Eigen::ArrayXd amplitudes;
+    Eigen::ArrayXd phases;
+    Eigen::MatrixXd cos_table;
+    Eigen::MatrixXd sin_table;
+    Eigen::ArrayXd theta;
+    Eigen::ArrayXd cos_theta;
+    Eigen::ArrayXd sin_theta;
+    Eigen::VectorXd a_cos;
+    Eigen::VectorXd a_sin;
+    Eigen::VectorXd eta_segment;  // the steps the IRF reaches from the chunk
+    // convolution
+    Eigen::FFT<double> fft;
+    std::vector<Eigen::VectorXcd> kernel_spectra;  // per body and dof
+    Eigen::VectorXd padded;
+    Eigen::VectorXcd eta_spectrum;
+    Eigen::VectorXcd product;
+    Eigen::VectorXd convolution;
+    // chunks, 6N x (chunk_steps + 1)
+    Eigen::MatrixXd current_chunk;
+    Eigen::MatrixXd next_chunk;
+    int current_first_step = 0;
+    int next_first_step    = -1;
+    // worker, declared last: started once everything above is set up
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool worker_busy   = false;  // a chunk is requested or being computed into next_chunk
+    bool worker_stop   = false;
+    int requested_step = 0;
+    std::thread worker;
+};
+
+/*******************************************************************************
+ * IrregularExcitationStream constructor
+ * sizes every buffer, transforms the kernels once (fixed FFT size) and computes
+ * the first chunk, which also sets up the FFT plans. prefetch: starts the worker
+ * on the second chunk
+ *******************************************************************************/
+IrregularExcitationStream::IrregularExcitationStream(const Eigen::VectorXd& omegas,
+                                                     const Eigen::VectorXd& amplitudes,
+                                                     const Eigen::VectorXd& phases,
+                                                     const std::vector<Eigen::MatrixXd>& kernels,
+                                                     const std::vector<int>& kernel_first_step,
+                                                     double dt,
+                                                     double ramp_duration,
+                                                     int chunk_steps,
+                                                     bool prefetch)
+    : num_bodies(static_cast<int>(kernels.size())),
+      chunk_steps(chunk_steps),
+      dt(dt),
+      ramp_duration(ramp_duration),
+      kernel_first_step(kernel_first_step),
+      omegas(omegas.array()),
+      amplitudes(amplitudes.array()),
+      phases(phases.array()) {
+    int lowest_step = 0;
+    int max_size    = 1;
+    highest_step    = 0;
+    for (int b = 0; b < num_bodies; b++) {
+        int size     = static_cast<int>(kernels[b].cols());
+        int last     = kernel_first_step[b] + size - 1;
+        lowest_step  = b == 0 ? kernel_first_step[b] : std::min(lowest_step, kernel_first_step[b]);
+        highest_step = b == 0 ? last : std::max(highest_step, last);
+        max_size     = std::max(max_size, size);
+    }
+    int segment_size = chunk_steps + 1 + highest_step - lowest_step;
+    convolution_size = segment_size + max_size - 1;
+    int fft_size     = 1;
+    while (fft_size < convolution_size) {
+        fft_size *= 2;
+    }
+
+    const int table_size = 256;
+    int num_freqs        = static_cast<int>(this->omegas.size());
+    int table_steps      = std::min(table_size, segment_size);
+    theta.resize(num_freqs);
+    cos_theta.resize(num_freqs);
+    sin_theta.resize(num_freqs);
+    a_cos.resize(num_freqs);
+    a_sin.resize(num_freqs);
+    cos_table.resize(num_freqs, table_steps);
+    sin_table.resize(num_freqs, table_steps);
+    for (int m = 0; m < table_steps; m++) {
+        theta = this->omegas * (m * dt);
+        SinCos(theta, sin_theta, cos_theta);
+        cos_table.col(m) = cos_theta.matrix();
+        sin_table.col(m) = sin_theta.matrix();
+    }
+    eta_segment.resize(segment_size);
+
+    padded.resize(fft_size);
+    kernel_spectra.resize(6 * num_bodies);
+    for (int b = 0; b < num_bodies; b++) {
+        for (int dof = 0; dof < 6; dof++) {
+            padded.setZero();
+            padded.head(kernels[b].cols()) = kernels[b].row(dof).transpose();
+            fft.fwd(kernel_spectra[6 * b + dof], padded);
+        }
+    }
+    eta_spectrum.resize(fft_size);
+    product.resize(fft_size);
+    convolution.resize(fft_size);
+
+    current_chunk.resize(6 * num_bodies, chunk_steps + 1);
+    next_chunk.resize(6 * num_bodies, chunk_steps + 1);
+    ComputeChunk(0, current_chunk);
+
+    if (prefetch) {
+        worker_busy    = true;
+        requested_step = chunk_steps;
+        worker         = std::thread(&IrregularExcitationStream::RunWorker, this);
+    }
+}
+
+/*******************************************************************************
+ * IrregularExcitationStream destructor
+ * stops the worker (after the chunk it may be computing) and joins it
+ *******************************************************************************/
+IrregularExcitationStream::~IrregularExcitationStream() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        worker_stop = true;
+    }
+    condition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+/*******************************************************************************
+ * IrregularExcitationStream::GetForceAtTime()
+ * the chunk holding t is loaded first when t is outside the current one
+ *******************************************************************************/
+void IrregularExcitationStream::GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) {
+    double steps = std::max(t / dt, 0.0);
+    int index    = static_cast<int>(steps);
+    if (index < current_first_step || index >= current_first_step + chunk_steps) {
+        LoadChunk(index - index % chunk_steps);
+    }
+    int column                = index - current_first_step;
+    double s                  = steps - index;
+    f.head(6 * num_bodies) = (1.0 - s) * current_chunk.col(column) + s * current_chunk.col(column + 1);
+}
+
+/*******************************************************************************
+ * IrregularExcitationStream::MaskDofs()
+ * waits for the worker, so that no chunk is being computed meanwhile
+ *******************************************************************************/
+void IrregularExcitationStream::MaskDofs(const std::vector<char>& dof_active) {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] { return !worker_busy; });
+    for (int i = 0; i < 6 * num_bodies; i++) {
+        if (!dof_active[i]) {
+            kernel_spectra[i].setZero();
+            current_chunk.row(i).setZero();
+            next_chunk.row(i).setZero();
+        }
+    }
+}
+
+/*******************************************************************************
+ * IrregularExcitationStream::LoadChunk()
+ * waits for the worker, takes its chunk when it is the one asked for (buffer
+ * swap) or computes it here, then has the worker prefetch the following one
+ *******************************************************************************/
+void IrregularExcitationStream::LoadChunk(int first_step) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return !worker_busy; });
+    }
+    if (next_first_step == first_step) {
+        current_chunk.swap(next_chunk);
+    } else {
+        ComputeChunk(first_step, current_chunk);
+    }
+    current_first_step = first_step;
+    next_first_step    = -1;
+
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requested_step = first_step + chunk_steps;
+            worker_busy    = true;
+        }
+        condition.notify_all();
+    }
+}
+
+/*******************************************************************************
+ * IrregularExcitationStream::ComputeChunk()
+ * excitation force of the steps first_step ... first_step + force.cols() - 1:
+ * eta (ramped, 0 before t = 0) over the steps the IRF reaches from there, in
+ * blocks of the cos / sin table, then one FFT convolution per body and dof
+ * (as IrregularWave::ConvolveExcitation) with the kernel spectra
+ *******************************************************************************/
+void IrregularExcitationStream::ComputeChunk(int first_step, Eigen::MatrixXd& force) {
+    int segment_first_step = first_step - highest_step;
+    int segment_size       = static_cast<int>(eta_segment.size());
+    int table_steps        = static_cast<int>(cos_table.cols());
+    for (int start = 0; start < segment_size; start += table_steps) {
+        int count = std::min(table_steps, segment_size - start);
+        theta     = omegas * ((segment_first_step + start) * dt) + phases;
+        SinCos(theta, sin_theta, cos_theta);
+        a_cos = (amplitudes * cos_theta).matrix();
+        a_sin = (amplitudes * sin_theta).matrix();
+        // a cos(theta + omega m dt) = a cos(theta) cos(omega m dt) - a sin(theta) sin(omega m dt)
+        eta_segment.segment(start, count).noalias() = cos_table.leftCols(count).transpose() * a_cos;
+        eta_segment.segment(start, count).noalias() -= sin_table.leftCols(count).transpose() * a_sin;
+    }
+    for (int i = 0; i < segment_size; i++) {
+        double t = (segment_first_step + i) * dt;
+        if (t < 0.0) {
+            eta_segment[i] = 0.0;
+        } else if (ramp_duration > 0.0 && t < ramp_duration) {
+            eta_segment[i] *= t / ramp_duration;
+        }
+    }
+
+    padded.setZero();
+    padded.head(segment_size) = eta_segment;
+    fft.fwd(eta_spectrum, padded);
+
+    int num_steps = static_cast<int>(force.cols());
+    force.setZero();
+    for (int b = 0; b < num_bodies; b++) {
+        // step n is convolution index n - offset, inside [0, convolution_size)
+        int offset    = segment_first_step + kernel_first_step[b];
+        int first_out = std::max(first_step, offset);
+        int last_out  = std::min(first_step + num_steps - 1, convolution_size - 1 + offset);
+        for (int dof = 0; dof < 6; dof++) {
+            product = kernel_spectra[6 * b + dof].cwiseProduct(eta_spectrum);
+            fft.inv(convolution, product);
+            for (int n = first_out; n <= last_out; n++) {
+                force(6 * b + dof, n - first_step) = dt * convolution[n - offset];
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * IrregularExcitationStream::RunWorker()
+ * computes the requested chunk into next_chunk, until stopped. Holds a
+ * StepScope: its work belongs to the simulation steps that asked for it
+ *******************************************************************************/
+void IrregularExcitationStream::RunWorker() {
+    hydroc::StepScope step_scope;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return worker_stop || worker_busy; });
+        if (worker_stop) {
+            return;
+        }
+        int first_step = requested_step;
+        lock.unlock();
+        ComputeChunk(first_step, next_chunk);
+        lock.lock();
+        next_first_step = first_step;
+        worker_busy     = false;
+        condition.notify_all();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Irregular wave class definitions:
 IrregularWave::IrregularWave() {
     num_bodies = 1;
@@ -108,29 +689,60 @@ IrregularWave::IrregularWave(unsigned int num_b) {
     num_bodies = num_b;
 }
 
+// defined here, where IrregularExcitationStream is complete
+IrregularWave::IrregularWave(IrregularWave&&) noexcept = default;
+IrregularWave::~IrregularWave()                        = default;
+
+/*******************************************************************************
+ * IrregularWave::Initialize()
+ * spectrum, eta, then the excitation IRF resampled on the time grid of eta and
+ * the excitation force of the whole simulation (PrecomputeExcitationForce).
+ * streaming: no eta, the IrregularExcitationStream (first chunk, worker)
+ *******************************************************************************/
 void IrregularWave::Initialize() {
-    std::vector<Eigen::MatrixXd> ex_irf_old(num_bodies);
-    std::vector<Eigen::VectorXd> ex_irf_time_old(num_bodies);
-    for (int b = 0; b < num_bodies; b++) {
-        ex_irf_old[b]      = GetExcitationIRF(b);
-        ex_irf_time_old[b] = wave_info[b].excitation_irf_time;
+    stream.reset();    // stops a previous worker
+    CreateSpectrum();  // output in spectrum_output_file
+    // one draw of the phases, shared by eta (or the stream) and GetWaveComponents (slow drift)
+    component_phases = WaveComponentPhases(spectrum_frequencies.size());
+    if (streaming) {
+        if (simulation_dt <= 0.0 || stream_chunk_steps < 1) {
+            throw std::invalid_argument("IrregularWave: streaming needs simulation_dt > 0 and stream_chunk_steps >= 1");
+        }
+        eta_dt = simulation_dt;
+        eta.resize(0);
+    } else {
+        CreateFreeSurfaceElevation();  // eta initialized in here, and output to eta_output_file
     }
 
-    // resample excitation IRF time series
-    // h5 file irf has different timestep, want to resample with interpolation (cubic spline?) once at start no
-    // interpolation in convolution integral part
-    // different one for each body it's 6x1x1000 so maybe switch to 2d reading
+    // resample excitation IRF time series on the eta time grid (cubic spline, once), so the convolution is a
+    // discrete one
     ex_irf_resampled.resize(num_bodies);
-    ex_irf_time_resampled.resize(num_bodies);
-    for (int b = 0; b < num_bodies; b++) {  // function call (time_in, vals_in, &time_out, &vals_out)
-        ex_irf_time_resampled[b] = ResampleTime(ex_irf_time_old[b], simulation_dt);
-        ex_irf_resampled[b]      = ResampleVals(ex_irf_time_old[b], ex_irf_old[b], ex_irf_time_resampled[b]);
+    ex_irf_first_step.resize(num_bodies);
+    for (int b = 0; b < num_bodies; b++) {
+        Eigen::MatrixXd ex_irf_old      = GetExcitationIRF(b);
+        const Eigen::VectorXd& t_old    = wave_info[b].excitation_irf_time;
+        Eigen::VectorXd ex_irf_time_new = ResampleTime(t_old, eta_dt);
+        ex_irf_resampled[b]             = ResampleVals(t_old, ex_irf_old, ex_irf_time_new);
+        ex_irf_first_step[b]            = static_cast<int>(std::lround(ex_irf_time_new[0] / eta_dt));
     }
 
-    CreateSpectrum();              // output in spectral_densities.txt
-    CreateFreeSurfaceElevation();  // eta initialized in here, and output to eta.txt
+    if (streaming) {
+        Eigen::VectorXd omegas, amplitudes, phases;
+        GetWaveComponents(omegas, amplitudes, phases);
+        excitation_force.resize(0, 0);
+        stream = std::make_unique<IrregularExcitationStream>(omegas, amplitudes, phases, ex_irf_resampled,
+                                                             ex_irf_first_step, eta_dt, ramp_duration,
+                                                             stream_chunk_steps, stream_prefetch);
+    } else {
+        PrecomputeExcitationForce();
+    }
 }
 
+/*******************************************************************************
+ * IrregularWave::ResampleVals()
+ * cubic spline through the (uniformly spaced) t_old samples, evaluated at t_new
+ * (inside [t_old first, t_old last])
+ *******************************************************************************/
 Eigen::MatrixXd IrregularWave::ResampleVals(const Eigen::VectorXd& t_old,
                                             Eigen::MatrixXd& vals_old,
                                             const Eigen::VectorXd& t_new) {
@@ -139,67 +751,82 @@ Eigen::MatrixXd IrregularWave::ResampleVals(const Eigen::VectorXd& t_old,
     Eigen::MatrixXd vals_new(6, t_new.size());
     // we need to scale t to be [0,1] for spline use
     // TODO: change this to accomodate variable dt instead of const dt
+    double t_initial             = t_old[0];
+    double t_span                = t_old[t_old.size() - 1] - t_initial;
     Eigen::VectorXd t_old_scaled = Eigen::VectorXd::LinSpaced(t_old.size(), 0, 1);
-    Eigen::VectorXd t_new_scaled = Eigen::VectorXd::LinSpaced(t_new.size(), 0, 1);
 
     Eigen::Spline<double, 6> spline =
         Eigen::SplineFitting<Eigen::Spline<double, 6>>::Interpolate(vals_old, 3, t_old_scaled);
     for (int i = 0; i < t_new.rows(); i++) {
-        vals_new.col(i) = spline(t_new_scaled[i]);
+        vals_new.col(i) = spline(std::clamp((t_new[i] - t_initial) / t_span, 0.0, 1.0));
     }
 
     return vals_new;
 }
 
+/*******************************************************************************
+ * IrregularWave::ResampleTime()
+ * the multiples of dt_new inside [t_old first, t_old last], so that resampled
+ * values line up with a time grid k dt_new starting at 0
+ *******************************************************************************/
 Eigen::VectorXd IrregularWave::ResampleTime(const Eigen::VectorXd& t_old, const double dt_new) {
-    double dt_old    = t_old[1] - t_old[0];
-    int size_new     = static_cast<int>(ceil(t_old.size() * dt_old / dt_new));
-    double t_initial = t_old[0];
-    double t_final   = t_old[t_old.size() - 1];
-    // t_0 and t_final should be the same in old/new versions, use new time step, which means a different number of
-    // timesteps
-    Eigen::VectorXd t_new = Eigen::VectorXd::LinSpaced(size_new, t_initial, t_final);
-
-    // print for testing
-    int N_old = t_old.size() - 1;
-    int N_new = t_new.size() - 1;
-    //std::cout << "T_old = {t_i | i = 0 .. " << N_old << ", t_0 = " << t_old[0] << ", t_" << N_old << " = "
-    //          << t_old[N_old] << "}\n"
-    //          << "dt_old = " << dt_old << "\nT_new = {t_i | i = 0 .. " << N_new << ", t_0 = " << t_new[0] << ", t_"
-    //          << N_new << " = " << t_new[N_new] << "}\n"
-    //          << "dt_new = " << dt_new << std::endl;
-
-    return t_new;
+    int first_step = static_cast<int>(std::ceil(t_old[0] / dt_new - 1e-9));
+    int last_step  = static_cast<int>(std::floor(t_old[t_old.size() - 1] / dt_new + 1e-9));
+    int size_new   = std::max(last_step - first_step + 1, 1);
+    return Eigen::VectorXd::LinSpaced(size_new, first_step * dt_new, (first_step + size_new - 1) * dt_new);
 }
 
 void IrregularWave::AddH5Data(std::vector<HydroData::IrregularWaveInfo>& irreg_h5_data,
                               HydroData::SimulationParameters& sim_data) {
-    wave_info = irreg_h5_data;
-    sim_data  = sim_data;
+    wave_info      = irreg_h5_data;
+    this->sim_data = sim_data;
 }
 
-Eigen::VectorXd IrregularWave::GetForceAtTime(double t) {
-    unsigned int total_dofs = num_bodies * 6;
-    Eigen::VectorXd f(total_dofs);
-    // initialize the force here:
-    // for now set f to all zeros
-    for (int i = 0; i < total_dofs; i++) {
-        f[i] = 0.0;
+/*******************************************************************************
+ * IrregularWave::GetForceAtTime()
+ * linear interpolation in the precomputed excitation force table, clamped to
+ * the simulation duration. streaming: from the IrregularExcitationStream
+ *******************************************************************************/
+void IrregularWave::GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) {
+    int total_dofs = 6 * num_bodies;
+    assert(f.size() >= total_dofs);
+    if (stream) {
+        stream->GetForceAtTime(t, f);
+        return;
     }
-    // see ComputeForceExcitation and convolution functions
 
-    // force_excitation.resize(total_dofs, 0.0);
+    int last = static_cast<int>(excitation_force.cols()) - 1;
+    if (last == 0) {
+        f.head(total_dofs) = excitation_force.col(0);
+        return;
+    }
+    double steps       = std::clamp(t / eta_dt, 0.0, static_cast<double>(last));
+    int index          = std::min(static_cast<int>(steps), last - 1);
+    double s           = steps - index;
+    f.head(total_dofs) = (1.0 - s) * excitation_force.col(index) + s * excitation_force.col(index + 1);
+}
 
-    for (int body = 0; body < num_bodies; body++) {
-        // Loop through the DOFs
-        for (int dof = 0; dof < 6; ++dof) {
-            // Compute the convolution for the current DOF
-            double f_dof          = ExcitationConvolution(body, dof, t);
-            unsigned int b_offset = body * 6;
-            f[b_offset + dof]     = f_dof;
+/*******************************************************************************
+ * IrregularWave::MaskExcitationDofs()
+ * the excitation force is linear in each IRF row: zeroing the force rows (or
+ * the streamed kernels) is the same as convolving with zeroed IRF rows
+ *******************************************************************************/
+void IrregularWave::MaskExcitationDofs(const std::vector<char>& dof_active) {
+    for (int b = 0; b < static_cast<int>(ex_irf_resampled.size()); b++) {
+        for (int dof = 0; dof < 6; dof++) {
+            if (!dof_active[6 * b + dof]) {
+                ex_irf_resampled[b].row(dof).setZero();
+            }
+        }
+    }
+    for (int i = 0; i < excitation_force.rows(); i++) {
+        if (!dof_active[i]) {
+            excitation_force.row(i).setZero();
         }
     }
-    return f;
+    if (stream) {
+        stream->MaskDofs(dof_active);
+    }
 }
 
 /*******************************************************************************
@@ -210,47 +837,123 @@ Eigen::MatrixXd IrregularWave::GetExcitationIRF(int b) const {
     return wave_info[b].excitation_irf_matrix;
 }
 
-double IrregularWave::ExcitationConvolution(int body, int dof, double time) {
-    double f_ex  = 0.0;
-    double width = ex_irf_time_resampled[body][1] - ex_irf_time_resampled[body][0];
-    //std::cout << "width=" << width << std::endl;
+/*******************************************************************************
+ * IrregularWave::GetWaveComponents()
+ * the components FreeSurfaceElevation sums into eta
+ *******************************************************************************/
+void IrregularWave::GetWaveComponents(Eigen::VectorXd& omegas, Eigen::VectorXd& amplitudes, Eigen::VectorXd& phases) {
+    omegas     = 2.0 * M_PI * spectrum_frequencies;
+    amplitudes = WaveComponentAmplitudes(spectrum_frequencies, spectral_densities);
+    phases     = component_phases;
+}
 
-    for (size_t j = 0; j < ex_irf_time_resampled[0].size(); ++j) {
-        double tau        = ex_irf_time_resampled[0][j];
-        double t_tau      = time - tau;
-        double ex_irf_val = ex_irf_resampled[body](dof, j);
-        if (0.0 < t_tau && t_tau < eta.size() * width) {
-            size_t eta_index = static_cast<size_t>(t_tau / width);
-            double eta_val   = eta[eta_index - 1];
-            f_ex += ex_irf_val * eta_val * width;  // eta is wave elevation
-        }
+/*******************************************************************************
+ * IrregularWave::GetRampFactor()
+ *******************************************************************************/
+double IrregularWave::GetRampFactor(double t) {
+    if (ramp_duration <= 0.0) {
+        return 1.0;
     }
-
-    return f_ex;
+    return std::clamp(t / ramp_duration, 0.0, 1.0);
 }
 
-Eigen::VectorXd IrregularWave::SetSpectrumFrequencies(double start, double end, int num_points) {
-    Eigen::VectorXd result(num_points);
-    double step = (end - start) / (num_points - 1);
+/*******************************************************************************
+ * IrregularWave::PrecomputeExcitationForce()
+ * excitation force at every time of eta (eta is 0 outside the simulation)
+ *******************************************************************************/
+void IrregularWave::PrecomputeExcitationForce() {
+    excitation_force.resize(6 * num_bodies, eta.size());
+    ConvolveExcitation(eta, 0, 0, excitation_force);
+}
 
-    for (int i = 0; i < num_points; ++i) {
-        result[i] = start + i * step;
+/*******************************************************************************
+ * IrregularWave::ConvolveExcitation()
+ * f(t_n) = dt sum_j K(tau_j) eta(t_n - tau_j), tau_j = (first + j) dt on the eta
+ * grid t_n = n dt, for the steps first_step ... first_step + force.cols() - 1,
+ * eta_segment holds the steps from segment_first_step on (0 outside): one linear
+ * convolution per body and dof, done with FFTs of a zero padded length instead
+ * of O(steps x IRF size) sums
+ *******************************************************************************/
+void IrregularWave::ConvolveExcitation(const Eigen::VectorXd& eta_segment,
+                                       int segment_first_step,
+                                       int first_step,
+                                       Eigen::MatrixXd& force) const {
+    int segment_size      = static_cast<int>(eta_segment.size());
+    int num_steps         = static_cast<int>(force.cols());
+    Eigen::Index max_size = 0;
+    for (const Eigen::MatrixXd& kernel : ex_irf_resampled) {
+        max_size = std::max(max_size, kernel.cols());
+    }
+    int convolution_size = segment_size + static_cast<int>(max_size) - 1;
+    int fft_size         = 1;
+    while (fft_size < convolution_size) {
+        fft_size *= 2;
     }
 
-    spectrum_frequencies = result;
+    Eigen::FFT<double> fft;
+    Eigen::VectorXd padded    = Eigen::VectorXd::Zero(fft_size);
+    padded.head(segment_size) = eta_segment;
+    Eigen::VectorXcd eta_spectrum, product;
+    fft.fwd(eta_spectrum, padded);
 
-    return result;
+    force.setZero();
+    Eigen::VectorXd convolution;
+    for (int b = 0; b < num_bodies; b++) {
+        // step n is convolution index n - offset, inside [0, convolution_size)
+        int offset    = segment_first_step + ex_irf_first_step[b];
+        int first_out = std::max(first_step, offset);
+        int last_out  = std::min(first_step + num_steps - 1, convolution_size - 1 + offset);
+        for (int dof = 0; dof < 6; dof++) {
+            padded.setZero();
+            padded.head(ex_irf_resampled[b].cols()) = ex_irf_resampled[b].row(dof).transpose();
+            fft.fwd(product, padded);
+            product = product.cwiseProduct(eta_spectrum);
+            fft.inv(convolution, product);
+            for (int n = first_out; n <= last_out; n++) {
+                force(6 * b + dof, n - first_step) = eta_dt * convolution[n - offset];
+            }
+        }
+    }
 }
 
+/*******************************************************************************
+ * IrregularWave::SetSpectrumFrequencies()
+ * sets the frequency range and resolution CreateSpectrum uses, returns the grid
+ *******************************************************************************/
+Eigen::VectorXd IrregularWave::SetSpectrumFrequencies(double start, double end, int num_points) {
+    spectrum_min_frequency   = start;
+    spectrum_max_frequency   = end;
+    spectrum_num_frequencies = num_points;
+    spectrum_frequencies     = Eigen::VectorXd::LinSpaced(num_points, start, end);
+    return spectrum_frequencies;
+}
+
+/*******************************************************************************
+ * IrregularWave::CreateSpectrum()
+ * spectrum (Pierson-Moskowitz from wave_height and wave_period when not set) on
+ * num frequencies evenly spaced over [min, max]
+ *******************************************************************************/
 void IrregularWave::CreateSpectrum() {
-    // Define the frequency vector
-    spectrum_frequencies = Eigen::VectorXd::LinSpaced(1000, 0.001, 1.0);
+    if (spectrum_num_frequencies < 1 || !(spectrum_min_frequency > 0.0) ||
+        !(spectrum_max_frequency >= spectrum_min_frequency) ||
+        (spectrum_num_frequencies > 1 && spectrum_max_frequency == spectrum_min_frequency)) {
+        throw std::invalid_argument("IrregularWave: expected 0 < spectrum_min_frequency < spectrum_max_frequency and "
+                                    "spectrum_num_frequencies >= 1");
+    }
+    spectrum_frequencies =
+        Eigen::VectorXd::LinSpaced(spectrum_num_frequencies, spectrum_min_frequency, spectrum_max_frequency);
+    if (spectrum) {
+        spectral_densities = spectrum->Evaluate(spectrum_frequencies);
+    } else {
+        spectral_densities = PiersonMoskowitzSpectrum(wave_height, wave_period).Evaluate(spectrum_frequencies);
+    }
 
-    // Calculate the Pierson-Moskowitz Spectrum
-    spectral_densities = PiersonMoskowitzSpectrumHz(spectrum_frequencies, wave_height, wave_period);
+    if (spectrum_output_file.empty()) {
+        return;
+    }
 
     // Open a file stream for writing
-    std::ofstream outputFile("spectral_densities.txt");
+    std::ofstream outputFile(spectrum_output_file);
 
     // Check if the file stream is open
     if (outputFile.is_open()) {
@@ -266,21 +969,8 @@ void IrregularWave::CreateSpectrum() {
     }
 }
 
-// TODO put spectrum functions in a new namespace (when we have more options?)
-Eigen::VectorXd PiersonMoskowitzSpectrumHz(Eigen::VectorXd& f, double Hs, double Tp) {
-    // Sort the frequency vector
-    std::sort(f.begin(), f.end());
-
-    // Initialize the spectral densities vector
-    Eigen::VectorXd spectral_densities(f.size());
-
-    // Calculate the spectral densities
-    for (size_t i = 0; i < f.size(); ++i) {
-        spectral_densities[i] = 1.25 * std::pow(1 / Tp, 4) * std::pow(Hs / 2, 2) * std::pow(f[i], -5) *
-                                std::exp(-1.25 * std::pow(1 / Tp, 4) * std::pow(f[i], -4));
-    }
-
-    return spectral_densities;
+Eigen::VectorXd PiersonMoskowitzSpectrumHz(const Eigen::VectorXd& f, double Hs, double Tp) {
+    return PiersonMoskowitzSpectrum(Hs, Tp).Evaluate(f);
 }
 
 void IrregularWave::CreateFreeSurfaceElevation() {
@@ -289,23 +979,24 @@ void IrregularWave::CreateFreeSurfaceElevation() {
     int num_timesteps = static_cast<int>(simulation_duration / simulation_dt) + 1;
 
     Eigen::VectorXd time_index = Eigen::VectorXd::LinSpaced(num_timesteps, 0, simulation_duration);
+    eta_dt                     = num_timesteps > 1 ? time_index[1] - time_index[0] : simulation_dt;
 
     // Calculate the free surface elevation
-    eta = FreeSurfaceElevation(spectrum_frequencies, spectral_densities, time_index, sim_data.water_depth);
+    eta = FreeSurfaceElevation(spectrum_frequencies, spectral_densities, time_index, component_phases);
 
-    // Apply ramp if ramp_duration is greater than 0
+    // Apply ramp if ramp_duration is greater than 0 (GetRampFactor, as in streaming)
     if (ramp_duration > 0.0) {
-        // UpdateRampTimesteps();
-        int ramp_timesteps   = static_cast<int>(ramp_duration / simulation_dt) + 1;
-        Eigen::VectorXd ramp = Eigen::VectorXd::LinSpaced(ramp_timesteps, 0.0, 1.0);
-
-        for (size_t i = 0; i < ramp.size(); ++i) {
-            eta[i] *= ramp[i];
+        for (int i = 0; i < eta.size() && time_index[i] < ramp_duration; ++i) {
+            eta[i] *= time_index[i] / ramp_duration;
         }
     }
 
+    if (eta_output_file.empty()) {
+        return;
+    }
+
     // Open a file stream for writing
-    std::ofstream eta_output("eta.txt");
+    std::ofstream eta_output(eta_output_file);
     // Check if the file stream is open
     if (eta_output.is_open()) {
         // Write the spectral densities and their corresponding frequencies to the file
@@ -324,11 +1015,47 @@ void IrregularWave::CreateFreeSurfaceElevation() {
     // WriteFreeSurfaceMeshObj(free_surface_3d_pts, free_surface_triangles, "fse_mesh.obj");
 }
 
+/*******************************************************************************
+ * SinCos(x, s, c)
+ * x = k pi / 2 + r, |r| <= pi / 4: k by the round to nearest of adding 1.5 2^52,
+ * r by subtracting k pi / 2 in three parts (exact products for |k| < 2^27),
+ * then sin(r) and cos(r) polynomials (Cephes sin.c) and a quadrant swap / sign
+ *******************************************************************************/
+void SinCos(const Eigen::ArrayXd& x, Eigen::ArrayXd& s, Eigen::ArrayXd& c) {
+    assert(s.size() == x.size() && c.size() == x.size());
+    const double round_shift = 6755399441055744.0;  // 1.5 2^52
+    const double pi_2_a      = 1.57079625129699707031;
+    const double pi_2_b      = 7.54978941586159635335e-8;
+    const double pi_2_c      = 5.39030285815811905290e-15;
+    const double* xp         = x.data();
+    double* sp               = s.data();
+    double* cp               = c.data();
+    for (Eigen::Index i = 0; i < x.size(); i++) {
+        double k  = (xp[i] * (2.0 / M_PI) + round_shift) - round_shift;
+        double r  = ((xp[i] - k * pi_2_a) - k * pi_2_b) - k * pi_2_c;
+        double z  = r * r;
+        double sr = r + r * z *
+                            (((((1.58962301576546568060e-10 * z - 2.50507477628578072866e-8) * z +
+                                2.75573136213857245213e-6) * z - 1.98412698295895385996e-4) * z +
+                              8.33333333332211858878e-3) * z - 1.66666666666666307295e-1);
+        double cr = 1.0 - 0.5 * z +
+                    z * z *
+                        (((((-1.13585365213876817300e-11 * z + 2.08757008419747316778e-9) * z -
+                            2.75573141792967388112e-7) * z + 2.48015872888517045348e-5) * z -
+                          1.38888888888730564116e-3) * z + 4.16666666666665929218e-2);
+        long long quadrant = static_cast<long long>(k) & 3;
+        double sin_abs     = (quadrant & 1) ? cr : sr;
+        double cos_abs     = (quadrant & 1) ? sr : cr;
+        sp[i]              = (quadrant & 2) ? -sin_abs : sin_abs;
+        cp[i]              = ((quadrant + 1) & 2) ? -cos_abs : cos_abs;
+    }
+}
+
 std::vector<double> ComputeWaveNumbers(const std::vector<double>& omegas,
                                        double water_depth,
-                                       double g           = 9.81,
-                                       double tolerance   = 1e-6,
-                                       int max_iterations = 100) {
+                                       double g,
+                                       double tolerance,
+                                       int max_iterations) {
     std::vector<double> wave_numbers(omegas.size());
 
     for (size_t i = 0; i < omegas.size(); ++i) {
@@ -356,56 +1083,216 @@ std::vector<double> ComputeWaveNumbers(const std::vector<double>& omegas,
     return wave_numbers;
 }
 
+Eigen::VectorXd WaveComponentAmplitudes(const Eigen::VectorXd& freqs_hz, const Eigen::VectorXd& spectral_densities) {
+    Eigen::Index size = freqs_hz.size();
+    double delta_f    = size > 1 ? (freqs_hz[size - 1] - freqs_hz[0]) / (size - 1) : freqs_hz[0];
+    return (2.0 * delta_f * spectral_densities.array()).sqrt().matrix();
+}
+
+Eigen::VectorXd WaveComponentPhases(int num_components, int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(0.0, 2 * M_PI);
+    Eigen::VectorXd phases(num_components);
+    for (int i = 0; i < num_components; ++i) {
+        phases[i] = dist(rng);
+    }
+    return phases;
+}
+
+/*******************************************************************************
+ * FreeSurfaceElevation()
+ * eta(t) = sum_i a_i cos(omega_i t + phase_i), in chunks of time steps: on a
+ * uniform time grid cos(omega_i (t_c + m dt) + phase_i) splits into a table over
+ * (component, m) shared by all chunks and the phases at the chunk start t_c,
+ * two matrix vector products per chunk. Otherwise one SinCos per time step.
+ * No time x frequency intermediate.
+ *******************************************************************************/
 Eigen::VectorXd FreeSurfaceElevation(const Eigen::VectorXd& freqs_hz,
                                      const Eigen::VectorXd& spectral_densities,
                                      const Eigen::VectorXd& time_index,
-                                     double water_depth,
-                                     int seed) {
-    double delta_f = freqs_hz(Eigen::last) / freqs_hz.size();
-    std::vector<double> omegas(freqs_hz.size());
+                                     const Eigen::VectorXd& component_phases) {
+    const int chunk_size = 256;
+    int num_freqs        = static_cast<int>(freqs_hz.size());
+    int num_steps        = static_cast<int>(time_index.size());
+
+    Eigen::ArrayXd omegas     = 2.0 * M_PI * freqs_hz.array();
+    Eigen::ArrayXd amplitudes = WaveComponentAmplitudes(freqs_hz, spectral_densities).array();
+    Eigen::ArrayXd phases     = component_phases.array();
+    if (phases.size() != num_freqs) {
+        throw std::invalid_argument("FreeSurfaceElevation: expected one phase per frequency");
+    }
 
-    for (size_t i = 0; i < freqs_hz.size(); ++i) {
-        omegas[i] = 2 * M_PI * freqs_hz[i];
+    Eigen::VectorXd eta = Eigen::VectorXd::Zero(num_steps);
+    if (num_steps == 0 || num_freqs == 0) {
+        return eta;
     }
 
-    std::vector<double> wave_numbers = ComputeWaveNumbers(omegas, water_depth);
+    double dt    = num_steps > 1 ? (time_index[num_steps - 1] - time_index[0]) / (num_steps - 1) : 0.0;
+    bool uniform = num_steps > 1;
+    for (int n = 1; n < num_steps && uniform; n++) {
+        double t_n = time_index[0] + n * dt;
+        uniform    = std::abs(time_index[n] - t_n) <= 1e-12 * std::max(1.0, std::abs(t_n));
+    }
 
-    std::vector<double> A(spectral_densities.size());
-    for (size_t i = 0; i < spectral_densities.size(); ++i) {
-        A[i] = 2 * spectral_densities[i] * delta_f;
+    Eigen::ArrayXd theta(num_freqs), sin_theta(num_freqs), cos_theta(num_freqs);
+    if (!uniform) {
+        for (int n = 0; n < num_steps; n++) {
+            theta = omegas * time_index[n] + phases;
+            SinCos(theta, sin_theta, cos_theta);
+            eta[n] = (amplitudes * cos_theta).sum();
+        }
+        return eta;
     }
 
-    std::vector<double> sqrt_A(A.size());
-    for (size_t i = 0; i < A.size(); ++i) {
-        sqrt_A[i] = std::sqrt(A[i]);
+    // cos(omega m dt) and sin(omega m dt), one column per offset m in a chunk
+    int chunk_steps = std::min(chunk_size, num_steps);
+    Eigen::MatrixXd cos_table(num_freqs, chunk_steps), sin_table(num_freqs, chunk_steps);
+    for (int m = 0; m < chunk_steps; m++) {
+        theta = omegas * (m * dt);
+        SinCos(theta, sin_theta, cos_theta);
+        cos_table.col(m) = cos_theta.matrix();
+        sin_table.col(m) = sin_theta.matrix();
     }
 
-    std::vector<std::vector<double>> omegas_t(time_index.size(), std::vector<double>(omegas.size()));
-    for (size_t i = 0; i < time_index.size(); ++i) {
-        for (size_t j = 0; j < omegas.size(); ++j) {
-            omegas_t[i][j] = time_index[i] * omegas[j];
-        }
+    Eigen::VectorXd a_cos(num_freqs), a_sin(num_freqs);
+    for (int start = 0; start < num_steps; start += chunk_steps) {
+        int count = std::min(chunk_steps, num_steps - start);
+        theta     = omegas * time_index[start] + phases;
+        SinCos(theta, sin_theta, cos_theta);
+        a_cos = (amplitudes * cos_theta).matrix();
+        a_sin = (amplitudes * sin_theta).matrix();
+        // a cos(theta + omega m dt) = a cos(theta) cos(omega m dt) - a sin(theta) sin(omega m dt)
+        eta.segment(start, count).noalias() = cos_table.leftCols(count).transpose() * a_cos;
+        eta.segment(start, count).noalias() -= sin_table.leftCols(count).transpose() * a_sin;
     }
 
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<double> dist(0.0, 2 * M_PI);
-    std::vector<double> phases(omegas.size());
-    for (size_t i = 0; i < phases.size(); ++i) {
-        phases[i] = dist(rng);
+    return eta;
+}
+
+// =============================================================================
+// NewmanDriftForce
+// =============================================================================
+
+/*******************************************************************************
+ * NewmanDriftForce constructor
+ * interpolates D at the component frequencies, builds the P and Q amplitude
+ * tables and keeps only the columns (components) that carry drift energy
+ *******************************************************************************/
+NewmanDriftForce::NewmanDriftForce(const Eigen::VectorXd& wave_omegas,
+                                   const Eigen::VectorXd& wave_amplitudes,
+                                   const Eigen::VectorXd& wave_phases,
+                                   const std::vector<Eigen::VectorXd>& drift_omegas,
+                                   const std::vector<Eigen::MatrixXd>& drift,
+                                   double max_dropped_energy) {
+    if (wave_amplitudes.size() != wave_omegas.size() || wave_phases.size() != wave_omegas.size()) {
+        throw std::invalid_argument("NewmanDriftForce: wave omegas, amplitudes and phases differ in size");
+    }
+    if (drift_omegas.size() != drift.size()) {
+        throw std::invalid_argument("NewmanDriftForce: expected one drift frequency list per body");
     }
+    int num_bodies = static_cast<int>(drift.size());
+    int count      = static_cast<int>(wave_omegas.size());
 
-    Eigen::VectorXd eta(time_index.size());
-    eta.setZero(time_index.size());
-    for (size_t i = 0; i < spectral_densities.size(); ++i) {
-        for (size_t j = 0; j < time_index.size(); ++j) {
-            eta[j] += sqrt_A[i] * std::cos(omegas_t[j][i] + phases[i]);
+    // D_i of each dof at each component
+    Eigen::MatrixXd coefficients = Eigen::MatrixXd::Zero(6 * num_bodies, count);
+    for (int b = 0; b < num_bodies; b++) {
+        const Eigen::VectorXd& w = drift_omegas[b];
+        if (drift[b].size() == 0) {
+            continue;
+        }
+        if (drift[b].rows() != 6 || drift[b].cols() != w.size() || w.size() == 0) {
+            throw std::invalid_argument("NewmanDriftForce: drift coefficients must be 6 x (number of frequencies)");
+        }
+        for (int k = 1; k < w.size(); k++) {
+            if (!(w[k] > w[k - 1])) {
+                throw std::invalid_argument("NewmanDriftForce: drift frequencies must be increasing");
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            double omega = wave_omegas[i];
+            int k        = static_cast<int>(std::upper_bound(w.data(), w.data() + w.size(), omega) - w.data());
+            if (k == 0) {
+                coefficients.block<6, 1>(6 * b, i) = drift[b].col(0);
+            } else if (k == w.size()) {
+                coefficients.block<6, 1>(6 * b, i) = drift[b].col(k - 1);
+            } else {
+                double s                           = (omega - w[k - 1]) / (w[k] - w[k - 1]);
+                coefficients.block<6, 1>(6 * b, i) = (1.0 - s) * drift[b].col(k - 1) + s * drift[b].col(k);
+            }
         }
     }
 
-    return eta;
+    // share of each component in the mean drift energy sum_i a_i^2 |D_i| of each dof, the largest over the dofs;
+    // the smallest components are dropped as long as their shares add up to less than max_dropped_energy
+    Eigen::MatrixXd magnitude = coefficients.cwiseAbs().cwiseSqrt() * wave_amplitudes.cwiseAbs().asDiagonal();
+    Eigen::VectorXd dof_total = magnitude.cwiseAbs2().rowwise().sum();
+    Eigen::VectorXd share     = Eigen::VectorXd::Zero(count);
+    for (int r = 0; r < dof_total.size(); r++) {
+        if (dof_total[r] > 0.0) {
+            share = share.cwiseMax(magnitude.row(r).transpose().cwiseAbs2() / dof_total[r]);
+        }
+    }
+    std::vector<int> order(count);
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&share](int i, int j) { return share[i] < share[j]; });
+    double dropped = 0.0;
+    int first_kept = 0;
+    while (first_kept < count && (share[order[first_kept]] == 0.0 ||
+                                  dropped + share[order[first_kept]] < max_dropped_energy)) {
+        dropped += share[order[first_kept]];
+        first_kept++;
+    }
+    std::vector<int> kept(order.begin() + first_kept, order.end());
+    std::sort(kept.begin(), kept.end());
+
+    int num_kept = static_cast<int>(kept.size());
+    omegas.resize(num_kept);
+    phases.resize(num_kept);
+    amplitudes.resize(6 * num_bodies, num_kept);
+    signed_amplitudes.resize(6 * num_bodies, num_kept);
+    mean_force.setZero(6 * num_bodies);
+    for (int j = 0; j < num_kept; j++) {
+        int i = kept[j];
+        // a negative amplitude is a phase shift of pi
+        omegas[j]                = wave_omegas[i];
+        phases[j]                = wave_phases[i] + (wave_amplitudes[i] < 0.0 ? M_PI : 0.0);
+        amplitudes.col(j)        = magnitude.col(i);
+        signed_amplitudes.col(j) = coefficients.col(i).cwiseSign().cwiseProduct(magnitude.col(i));
+        mean_force += wave_amplitudes[i] * wave_amplitudes[i] * coefficients.col(i);
+    }
+
+    cos_theta.resize(num_kept);
+    sin_theta.resize(num_kept);
+    p_re.resize(6 * num_bodies);
+    p_im.resize(6 * num_bodies);
+    q_re.resize(6 * num_bodies);
+    q_im.resize(6 * num_bodies);
+}
+
+/*******************************************************************************
+ * NewmanDriftForce::AddForceAtTime(t, f, ramp)
+ * F = Re[P conj(Q)] = P_re Q_re + P_im Q_im per dof
+ *******************************************************************************/
+void NewmanDriftForce::AddForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f, double ramp) {
+    assert(f.size() >= mean_force.size());
+    for (int i = 0; i < omegas.size(); i++) {
+        double theta = omegas[i] * t + phases[i];
+        cos_theta[i] = std::cos(theta);
+        sin_theta[i] = std::sin(theta);
+    }
+    p_re.noalias() = signed_amplitudes * cos_theta;
+    p_im.noalias() = signed_amplitudes * sin_theta;
+    q_re.noalias() = amplitudes * cos_theta;
+    q_im.noalias() = amplitudes * sin_theta;
+    f.head(mean_force.size()) += (ramp * ramp) * (p_re.cwiseProduct(q_re) + p_im.cwiseProduct(q_im));
 }
 
 void IrregularWave::SetUpWaveMesh(std::string filename) {
+    if (streaming) {
+        throw std::runtime_error("IrregularWave::SetUpWaveMesh: no elevation of the whole run in streaming mode");
+    }
     mesh_file_name                   = filename;
     int num_timesteps          = static_cast<int>(simulation_duration / simulation_dt) + 1;
     Eigen::VectorXd time_index = Eigen::VectorXd::LinSpaced(num_timesteps, 0, simulation_duration);
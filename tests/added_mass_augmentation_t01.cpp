@@ -0,0 +1,130 @@
+#include <hydroc/helper.h>
+#include <hydroc/hydro_forces.h>
+
+#include <chrono/physics/ChBodyEasy.h>
+#include <chrono/physics/ChSystemNSC.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>  // C++17
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks TestHydro::EnableAddedMassInertiaAugmentation:
+//   - a sphere decay with the added mass folded into the body's mass and inertia follows the decay with the
+//     ChLoadAddedMass load,
+//   - the coupling ratio warning is printed above max_coupling_ratio and not below it,
+//   - a body whose added mass cannot be applied explicitly (the rm3 heave plate, made almost massless) is refused
+//     with std::runtime_error.
+
+using std::filesystem::path;
+using namespace chrono;
+
+static const int NUM_STEPS = 600;
+
+// sphere decay from 1 m above equilibrium, as demo_sphere_decay without visualization, max_coupling_ratio < 0
+// keeps the added mass load: the heave time series, and what EnableAddedMassInertiaAugmentation wrote to std::cerr
+std::vector<double> SphereDecay(double max_coupling_ratio, std::string& warnings) {
+    path DATADIR(hydroc::getDataDir());
+    auto body1_meshfname =
+        (DATADIR / "sphere" / "geometry" / "oes_task10_sphere.obj").lexically_normal().generic_string();
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+    double timestep = 0.015;
+    system.SetSolverType(ChSolver::Type::GMRES);
+    system.SetSolverMaxIterations(300);
+    system.SetStep(timestep);
+
+    auto sphereBody = chrono_types::make_shared<ChBodyEasyMesh>(body1_meshfname, 1000, false, false, false);
+    system.Add(sphereBody);
+    sphereBody->SetNameString("body1");
+    sphereBody->SetPos(ChVector<>(0, 0, -1));
+    sphereBody->SetMass(261.8e3);
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    bodies.push_back(sphereBody);
+    TestHydro hydro_forces(bodies, h5fname);
+
+    warnings.clear();
+    if (max_coupling_ratio >= 0.0) {
+        std::ostringstream captured;
+        std::streambuf* cerr_buffer = std::cerr.rdbuf(captured.rdbuf());
+        hydro_forces.EnableAddedMassInertiaAugmentation(max_coupling_ratio);
+        std::cerr.rdbuf(cerr_buffer);
+        warnings = captured.str();
+    }
+
+    std::vector<double> heave;
+    heave.reserve(NUM_STEPS);
+    for (int step = 0; step < NUM_STEPS; step++) {
+        system.DoStepDynamics(timestep);
+        heave.push_back(sphereBody->GetPos().z());
+    }
+    return heave;
+}
+
+int main(int argc, char* argv[]) {
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+    int failures = 0;
+
+    // the sphere's translational added mass is not isotropic (surge != heave) and couples surge / sway with
+    // pitch / roll, so its coupling ratio is above 0; it is below 1, the limit of the explicit correction
+    std::string warnings;
+    std::vector<double> load_path = SphereDecay(-1.0, warnings);
+    std::vector<double> folded    = SphereDecay(1.0, warnings);
+    failures += Check(warnings.empty(), "no warning below max_coupling_ratio", warnings.size(), 0);
+    SphereDecay(0.0, warnings);
+    failures +=
+        Check(warnings.find("coupling ratio") != std::string::npos, "warning above max_coupling_ratio", 0, 1);
+
+    // 1 m initial offset: same decay within 2 cm over 9 s
+    double error = 0.0;
+    for (int step = 0; step < NUM_STEPS; step++) {
+        error = std::max(error, std::abs(folded[step] - load_path[step]));
+    }
+    failures += Check(error < 0.02, "folded added mass decay", error, 0.0);
+
+    // rm3 with an almost massless heave plate: the plate's heave added mass is far above its surge / sway added
+    // mass, the part left to the explicit correction exceeds the augmented mass
+    path DATADIR(hydroc::getDataDir());
+    auto h5fname     = (DATADIR / "rm3" / "hydroData" / "rm3.h5").lexically_normal().generic_string();
+    auto b1Meshfname = (DATADIR / "rm3" / "geometry" / "float_cog.obj").lexically_normal().generic_string();
+    auto b2Meshfname = (DATADIR / "rm3" / "geometry" / "plate_cog.obj").lexically_normal().generic_string();
+    ChSystemNSC system;
+    auto float_body1 = chrono_types::make_shared<ChBodyEasyMesh>(b1Meshfname, 0, false, false, false);
+    system.Add(float_body1);
+    float_body1->SetPos(ChVector<>(0, 0, -0.72));
+    float_body1->SetMass(725834);
+    float_body1->SetInertiaXX(ChVector<>(20907301.0, 21306090.66, 37085481.11));
+    auto plate_body2 = chrono_types::make_shared<ChBodyEasyMesh>(b2Meshfname, 0, false, false, false);
+    system.Add(plate_body2);
+    plate_body2->SetPos(ChVector<>(0, 0, -21.29));
+    plate_body2->SetMass(1.0);
+    plate_body2->SetInertiaXX(ChVector<>(1.0, 1.0, 1.0));
+    std::vector<std::shared_ptr<ChBody>> bodies = {float_body1, plate_body2};
+    TestHydro hydro_forces(bodies, h5fname);
+    bool refused = false;
+    try {
+        hydro_forces.EnableAddedMassInertiaAugmentation();
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    failures += Check(refused, "strongly coupled added mass refused", 0, 1);
+    failures += Check(plate_body2->GetMass() == 1.0, "refused: body mass unchanged", plate_body2->GetMass(), 1.0);
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
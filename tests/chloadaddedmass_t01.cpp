@@ -4,6 +4,7 @@
 
 #include <chrono/core/ChTypes.h>
 #include <chrono/physics/ChBodyEasy.h>
+#include <chrono/physics/ChLoadContainer.h>
 #include <chrono/physics/ChSystemSMC.h>
 
 #include <cstdlib>
@@ -32,7 +33,7 @@ int main(int argc, char* argv[]) {
     double density        = 0.0;
     bool evaluate_mass    = false;
     bool create_visu_mesh = true;
-    bool detect_collision = true;
+    bool detect_collision = false;  // no contact material needed, the bodies are stepped below
 
     auto body1 =
         chrono_types::make_shared<chrono::ChBodyEasyMesh>(b1Meshfname,  // file name
@@ -57,6 +58,56 @@ int main(int argc, char* argv[]) {
 
     my_loadbodyinertia = chrono_types::make_shared<ChLoadAddedMass>(infos.GetBodyInfos(), loadables, &my_system);
 
+    // the residual product works on the hydro bodies' 6x6 blocks, check it against the dense system sized
+    // product; a non hydro body is added first so the hydro blocks do not start at offset 0
+    auto other_body = chrono_types::make_shared<chrono::ChBody>();
+    my_system.AddBody(other_body);
+    my_system.Add(body1);
+    my_system.Add(body2);
+    auto load_container = chrono_types::make_shared<chrono::ChLoadContainer>();
+    my_system.Add(load_container);
+    load_container->Add(my_loadbodyinertia);
+    my_system.DoStepDynamics(0.01);  // assigns the variables offsets and creates the jacobians
+
+    auto jac = my_loadbodyinertia->GetJacobians();
+    if (!jac) {
+        std::cerr << "added mass jacobians not created" << std::endl;
+        return 1;
+    }
+    my_loadbodyinertia->ComputeJacobian(nullptr, nullptr, jac->K, jac->R, jac->M);
+    if (jac->M.rows() != 6 * nBodies || jac->M.cols() != 6 * nBodies) {
+        std::cerr << "added mass jacobian is " << jac->M.rows() << "x" << jac->M.cols() << ", expected 6N x 6N"
+                  << std::endl;
+        return 1;
+    }
+
+    int ndofs = my_system.GetNcoords_w();
+    chrono::ChVectorDynamic<> w(ndofs);
+    for (int i = 0; i < ndofs; i++) {
+        w[i] = 1.0 + 0.1 * i;
+    }
+    const double c = 0.5;
+    chrono::ChVectorDynamic<> R(ndofs);
+    R.setZero();
+    my_loadbodyinertia->LoadIntLoadResidual_Mv(R, w, c);
+
+    chrono::ChMatrixDynamic<> M_system(ndofs, ndofs);
+    M_system.setZero();
+    std::shared_ptr<chrono::ChBody> hydro_bodies[nBodies] = {body1, body2};
+    for (int i = 0; i < nBodies; i++) {
+        for (int j = 0; j < nBodies; j++) {
+            M_system.block(hydro_bodies[i]->Variables().GetOffset(), hydro_bodies[j]->Variables().GetOffset(), 6, 6) =
+                jac->M.block(6 * i, 6 * j, 6, 6);
+        }
+    }
+    chrono::ChVectorDynamic<> R_expected = c * M_system * w;
+
+    double error = (R - R_expected).norm();
+    if (error > 1e-9 * R_expected.norm()) {
+        std::cerr << "added mass residual differs from the dense product, error " << error << std::endl;
+        return 1;
+    }
+
     std::cout << "End" << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <hydroc/hydro_forces.h>
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks HydroComponentRate (multi-rate hydro force updates):
+//   - SetEverySteps(k) updates on the first step and then every k steps,
+//   - SetInterval(hydro_dt) updates once hydro_dt has passed, also when hydro_dt is a multiple of the time step
+//     that round off in t would otherwise miss by one step,
+//   - Predict holds the last update, or extrapolates linearly from the last two (after two updates only),
+//   - an update is forced when time goes backwards,
+//   - invalid rates are refused.
+
+// a linear force, so linear extrapolation is exact
+Eigen::VectorXd Force(double t) {
+    Eigen::VectorXd force(3);
+    force << 1.0 + 2.0 * t, -3.0 * t, 5.0;
+    return force;
+}
+
+// steps rate over num_steps time steps of dt, storing Force(t) when due: the steps it was due at, and the
+// largest difference between the predicted and expected force in between
+std::vector<int> Run(HydroComponentRate& rate, int num_steps, double dt, bool extrapolate, double& predict_error) {
+    std::vector<int> due_steps;
+    Eigen::VectorXd force(3), held(3);
+    predict_error = 0.0;
+    double t      = 0.0;
+    for (int step = 0; step < num_steps; step++, t += dt) {
+        if (rate.IsDue(t)) {
+            force = Force(t);
+            rate.Store(t, force);
+            held = force;
+            due_steps.push_back(step);
+            continue;
+        }
+        rate.Predict(t, force);
+        Eigen::VectorXd expected = extrapolate && due_steps.size() >= 2 ? Force(t) : held;
+        predict_error            = std::max(predict_error, (force - expected).cwiseAbs().maxCoeff());
+    }
+    return due_steps;
+}
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+    double predict_error;
+
+    // every step (default)
+    HydroComponentRate rate;
+    rate.Resize(3);
+    std::vector<int> due = Run(rate, 5, 0.1, false, predict_error);
+    failures += Check(due == std::vector<int>{0, 1, 2, 3, 4}, "default: every step", due.size(), 5);
+
+    // every 3 steps, held
+    rate = HydroComponentRate();
+    rate.Resize(3);
+    rate.SetEverySteps(3, false);
+    due = Run(rate, 10, 0.1, false, predict_error);
+    failures += Check(due == std::vector<int>{0, 3, 6, 9}, "every 3 steps", due.size(), 4);
+    failures += Check(predict_error == 0.0, "every 3 steps: held", predict_error, 0.0);
+
+    // every 4 steps, extrapolated (held until the second update)
+    rate = HydroComponentRate();
+    rate.Resize(3);
+    rate.SetEverySteps(4, true);
+    due = Run(rate, 13, 0.01, true, predict_error);
+    failures += Check(due == std::vector<int>{0, 4, 8, 12}, "every 4 steps", due.size(), 4);
+    failures += Check(predict_error < 1e-12, "every 4 steps: extrapolated", predict_error, 0.0);
+
+    // interval 0.25 s at dt 0.1 s: due at 0, 0.3, 0.6, 0.9
+    rate = HydroComponentRate();
+    rate.Resize(3);
+    rate.SetInterval(0.25, false);
+    due = Run(rate, 10, 0.1, false, predict_error);
+    failures += Check(due == std::vector<int>{0, 3, 6, 9}, "interval 0.25 s, dt 0.1 s", due.size(), 4);
+    failures += Check(predict_error == 0.0, "interval: held", predict_error, 0.0);
+
+    // interval 0.3 s at dt 0.1 s: with the round off accumulated in t, 0.6 - 0.3 < 0.3, still every 3 steps
+    rate = HydroComponentRate();
+    rate.Resize(3);
+    rate.SetInterval(0.3, true);
+    due = Run(rate, 10, 0.1, true, predict_error);
+    failures += Check(due == std::vector<int>{0, 3, 6, 9}, "interval 0.3 s, dt 0.1 s", due.size(), 4);
+    failures += Check(predict_error < 1e-12, "interval: extrapolated", predict_error, 0.0);
+
+    // time going backwards forces an update, even right after one
+    rate = HydroComponentRate();
+    rate.Resize(3);
+    rate.SetEverySteps(10, false);
+    failures += Check(rate.IsDue(1.0), "first step due", 0, 1);
+    rate.Store(1.0, Force(1.0));
+    failures += Check(!rate.IsDue(1.1), "not due after one step", 1, 0);
+    failures += Check(rate.IsDue(0.5), "due when time goes backwards", 0, 1);
+    rate.Store(0.5, Force(0.5));
+    failures += Check(!rate.IsDue(0.6), "not due after the backwards update", 1, 0);
+
+    // invalid rates
+    bool refused = false;
+    try {
+        rate.SetEverySteps(0, false);
+    } catch (const std::invalid_argument&) {
+        refused = true;
+    }
+    failures += Check(refused, "every 0 steps refused", 0, 1);
+    refused = false;
+    try {
+        rate.SetInterval(0.0, false);
+    } catch (const std::invalid_argument&) {
+        refused = true;
+    }
+    failures += Check(refused, "zero interval refused", 0, 1);
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <hydroc/helper.h>
+#include <hydroc/hydro_forces.h>
+
+#include <chrono/physics/ChBodyEasy.h>
+#include <chrono/physics/ChLinkTSDA.h>
+#include <chrono/physics/ChSystemNSC.h>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <filesystem>  // C++17
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Checks that independent TestHydro instances can run concurrently in one process: the
+// sphere decay, regular wave and irregular wave set ups are run serially, then several
+// copies of each are run at the same time on their own threads. Every threaded run must
+// reproduce its serial heave time series exactly.
+
+using std::filesystem::path;
+using namespace chrono;
+
+enum class SphereCase { decay = 0, regular = 1, irregular = 2 };
+
+static const int NUM_CASES = 3;
+static const int NUM_STEPS = 600;
+
+// same set up as the sphere demos, without visualization or file output
+std::vector<double> RunSphere(SphereCase sphere_case) {
+    path DATADIR(hydroc::getDataDir());
+
+    auto body1_meshfname =
+        (DATADIR / "sphere" / "geometry" / "oes_task10_sphere.obj").lexically_normal().generic_string();
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+    double timestep = 0.015;
+    system.SetSolverType(ChSolver::Type::GMRES);
+    system.SetSolverMaxIterations(300);
+    system.SetStep(timestep);
+    // keep each simulation on its own thread, the comparison with the serial run is exact
+    system.SetNumThreads(1, 1, 1);
+
+    auto ground = chrono_types::make_shared<ChBody>();
+    system.AddBody(ground);
+    ground->SetPos(ChVector<>(0, 0, -5));
+    ground->SetBodyFixed(true);
+    ground->SetCollide(false);
+
+    auto sphereBody = chrono_types::make_shared<ChBodyEasyMesh>(body1_meshfname, 1000, false, false, false);
+    system.Add(sphereBody);
+    sphereBody->SetNameString("body1");
+    sphereBody->SetPos(ChVector<>(0, 0, sphere_case == SphereCase::decay ? -1 : -2));
+    sphereBody->SetMass(261.8e3);
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    bodies.push_back(sphereBody);
+    TestHydro hydro_forces(bodies, h5fname);
+
+    if (sphere_case == SphereCase::decay) {
+        hydro_forces.AddWaves(std::make_shared<NoWave>(1));
+    } else {
+        auto prismatic = chrono_types::make_shared<ChLinkLockPrismatic>();
+        prismatic->Initialize(sphereBody, ground, false, ChCoordsys<>(ChVector<>(0, 0, -2)),
+                              ChCoordsys<>(ChVector<>(0, 0, -5)));
+        system.AddLink(prismatic);
+
+        auto spring_1 = chrono_types::make_shared<ChLinkTSDA>();
+        spring_1->Initialize(sphereBody, ground, false, ChVector<>(0, 0, -2), ChVector<>(0, 0, -5));
+        spring_1->SetSpringCoefficient(0.0);
+        spring_1->SetDampingCoefficient(sphere_case == SphereCase::regular ? 1077123.445 : 0.0);
+        system.AddLink(spring_1);
+
+        if (sphere_case == SphereCase::regular) {
+            auto waves                    = std::make_shared<RegularWave>(1);
+            waves->regular_wave_amplitude = 0.594;
+            waves->regular_wave_omega     = 0.571198664;
+            hydro_forces.AddWaves(waves);
+        } else {
+            auto waves                 = std::make_shared<IrregularWave>();
+            waves->wave_height         = 2.0;
+            waves->wave_period         = 12.0;
+            waves->simulation_duration = NUM_STEPS * timestep;
+            waves->simulation_dt       = timestep;
+            waves->ramp_duration       = 3.0;
+            hydro_forces.AddWaves(waves);
+        }
+    }
+
+    std::vector<double> heave_position;
+    heave_position.reserve(NUM_STEPS);
+    for (int step = 0; step < NUM_STEPS; step++) {
+        system.DoStepDynamics(timestep);
+        heave_position.push_back(sphereBody->GetPos().z());
+    }
+
+    return heave_position;
+}
+
+int main(int argc, char* argv[]) {
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+
+    std::vector<std::vector<double>> serial(NUM_CASES);
+    for (int c = 0; c < NUM_CASES; c++) {
+        serial[c] = RunSphere(static_cast<SphereCase>(c));
+    }
+
+    // at least two concurrent copies of each case
+    unsigned int num_threads = std::min(4u * NUM_CASES, std::thread::hardware_concurrency());
+    num_threads              = std::max(2u * NUM_CASES, num_threads);
+    std::vector<std::vector<double>> threaded(num_threads);
+    std::vector<std::string> errors(num_threads);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; t++) {
+        threads.emplace_back([t, &threaded, &errors]() {
+            try {
+                threaded[t] = RunSphere(static_cast<SphereCase>(t % NUM_CASES));
+            } catch (const std::exception& e) {
+                errors[t] = e.what();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    int failures = 0;
+    for (unsigned int t = 0; t < num_threads; t++) {
+        const auto& expected = serial[t % NUM_CASES];
+        if (!errors[t].empty()) {
+            std::cerr << "thread " << t << " threw: " << errors[t] << std::endl;
+            failures++;
+            continue;
+        }
+        if (threaded[t].size() != expected.size()) {
+            std::cerr << "thread " << t << " recorded " << threaded[t].size() << " steps, expected "
+                      << expected.size() << std::endl;
+            failures++;
+            continue;
+        }
+        double max_diff = 0.0;
+        for (size_t i = 0; i < expected.size(); i++) {
+            max_diff = std::max(max_diff, std::abs(threaded[t][i] - expected[i]));
+        }
+        if (threaded[t] != expected) {
+            std::cerr << "thread " << t << " (case " << t % NUM_CASES << ") differs from serial run, max heave diff "
+                      << max_diff << std::endl;
+            failures++;
+        }
+    }
+
+    std::cout << num_threads << " concurrent simulations, " << failures << " mismatches" << std::endl;
+    if (failures != 0) {
+        return 1;
+    }
+
+    std::cout << "End" << std::endl;
+    return 0;
+}
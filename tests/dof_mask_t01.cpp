@@ -0,0 +1,159 @@
+#include <hydroc/helper.h>
+#include <hydroc/hydro_forces.h>
+
+#include <chrono/physics/ChBodyEasy.h>
+#include <chrono/physics/ChLinkLock.h>
+#include <chrono/physics/ChLinkTSDA.h>
+#include <chrono/physics/ChSystemNSC.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <filesystem>  // C++17
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks the active dof mask of TestHydro on the heave only sphere (prismatic joint to the ground):
+//   - DetectActiveDofs finds heave only,
+//   - the heave time series (regular waves) with the mask matches the full 6 dof model,
+//   - the radiation convolution of the reduced model is timed against the full one,
+//   - an inactive dof still gets the drag force, only the linear hydro terms are masked.
+
+using std::filesystem::path;
+using namespace chrono;
+
+static const int NUM_STEPS = 600;
+
+// same set up as demo_sphere_reg_waves, without visualization; mask: detect the active dofs
+std::vector<double> RunSphere(bool mask, int& failures, double& convolution_us) {
+    path DATADIR(hydroc::getDataDir());
+
+    auto body1_meshfname =
+        (DATADIR / "sphere" / "geometry" / "oes_task10_sphere.obj").lexically_normal().generic_string();
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+    double timestep = 0.015;
+    system.SetSolverType(ChSolver::Type::GMRES);
+    system.SetSolverMaxIterations(300);
+    system.SetStep(timestep);
+
+    auto ground = chrono_types::make_shared<ChBody>();
+    system.AddBody(ground);
+    ground->SetPos(ChVector<>(0, 0, -5));
+    ground->SetBodyFixed(true);
+    ground->SetCollide(false);
+
+    auto sphereBody = chrono_types::make_shared<ChBodyEasyMesh>(body1_meshfname, 1000, false, false, false);
+    system.Add(sphereBody);
+    sphereBody->SetNameString("body1");
+    sphereBody->SetPos(ChVector<>(0, 0, -2));
+    sphereBody->SetMass(261.8e3);
+
+    auto prismatic = chrono_types::make_shared<ChLinkLockPrismatic>();
+    prismatic->Initialize(sphereBody, ground, false, ChCoordsys<>(ChVector<>(0, 0, -2)),
+                          ChCoordsys<>(ChVector<>(0, 0, -5)));
+    system.AddLink(prismatic);
+
+    auto spring_1 = chrono_types::make_shared<ChLinkTSDA>();
+    spring_1->Initialize(sphereBody, ground, false, ChVector<>(0, 0, -2), ChVector<>(0, 0, -5));
+    spring_1->SetSpringCoefficient(0.0);
+    spring_1->SetDampingCoefficient(1077123.445);
+    system.AddLink(spring_1);
+
+    auto waves                    = std::make_shared<RegularWave>(1);
+    waves->regular_wave_amplitude = 0.594;
+    waves->regular_wave_omega     = 0.571198664;
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    bodies.push_back(sphereBody);
+    TestHydro hydro_forces(bodies, h5fname);
+    hydro_forces.AddWaves(waves);
+    if (mask) {
+        hydro_forces.DetectActiveDofs();
+        std::array<bool, 6> heave_only = {false, false, true, false, false, false};
+        failures += Check(hydro_forces.GetActiveDofs(0) == heave_only, "detected active dofs",
+                          std::count(hydro_forces.GetActiveDofs(0).begin(), hydro_forces.GetActiveDofs(0).end(), true),
+                          1);
+    }
+
+    std::vector<double> heave_position;
+    heave_position.reserve(NUM_STEPS);
+    for (int step = 0; step < NUM_STEPS; step++) {
+        system.DoStepDynamics(timestep);
+        heave_position.push_back(sphereBody->GetPos().z());
+    }
+
+    const int num_calls = 200;
+    auto begin          = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_calls; i++) {
+        hydro_forces.ComputeForceRadiationDampingConv();
+    }
+    auto end       = std::chrono::high_resolution_clock::now();
+    convolution_us = std::chrono::duration<double, std::micro>(end - begin).count() / num_calls;
+
+    return heave_position;
+}
+
+// heave only sphere moving in surge with a surge drag: the total hydro force on surge is the drag alone
+int CheckInactiveDofDrag() {
+    path DATADIR(hydroc::getDataDir());
+    auto body1_meshfname =
+        (DATADIR / "sphere" / "geometry" / "oes_task10_sphere.obj").lexically_normal().generic_string();
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+    auto sphereBody = chrono_types::make_shared<ChBodyEasyMesh>(body1_meshfname, 1000, false, false, false);
+    system.Add(sphereBody);
+    sphereBody->SetNameString("body1");
+    sphereBody->SetPos(ChVector<>(0, 0, -2));
+    sphereBody->SetMass(261.8e3);
+    sphereBody->SetPos_dt(ChVector<>(2.0, 0, 0));
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    bodies.push_back(sphereBody);
+    TestHydro hydro_forces(bodies, h5fname);
+    hydro_forces.SetActiveDofs(0, {false, false, true, false, false, false});
+    Eigen::Matrix<double, 6, 6> drag = Eigen::Matrix<double, 6, 6>::Zero();
+    drag(0, 0)                       = 1e4;
+    hydro_forces.SetQuadraticDrag(0, drag);
+
+    double surge = hydro_forces.coordinateFunc(1, 0);
+    double sway  = hydro_forces.coordinateFunc(1, 1);
+    return Check(surge == -4e4, "inactive surge: drag only", surge, -4e4) +
+           Check(sway == 0.0, "inactive sway: no force", sway, 0.0);
+}
+
+int main(int argc, char* argv[]) {
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+
+    int failures = 0;
+    double full_us, masked_us;
+    std::vector<double> full   = RunSphere(false, failures, full_us);
+    std::vector<double> masked = RunSphere(true, failures, masked_us);
+
+    double max_diff  = 0.0;
+    double amplitude = 0.0;
+    for (size_t i = 0; i < full.size(); i++) {
+        max_diff  = std::max(max_diff, std::abs(masked[i] - full[i]));
+        amplitude = std::max(amplitude, std::abs(full[i] - full[0]));
+    }
+    failures += Check(max_diff < 1e-4 * amplitude, "heave, masked vs full", max_diff, 0.0);
+    failures += CheckInactiveDofDrag();
+    std::cout << "radiation convolution: " << full_us << " us (6 dofs), " << masked_us << " us (heave only)"
+              << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
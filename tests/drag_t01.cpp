@@ -0,0 +1,127 @@
+#include <hydroc/h5fileinfo.h>
+#include <hydroc/helper.h>
+#include <hydroc/hydro_forces.h>
+
+#include <chrono/physics/ChBodyEasy.h>
+#include <chrono/physics/ChSystemNSC.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>  // C++17
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "test_helpers.h"
+
+// Checks TestHydro::ComputeForceDrag against hand computed forces on the sphere:
+//   - SetQuadraticDrag: a body moving at constant speed in still water gets -drag * (|v| v) on every dof,
+//     twice the speed four times the force, opposite sign when reversed,
+//   - SetQuadraticDrag: a body at rest in a regular wave is dragged along by the wave particle velocity,
+//   - AddMorisonElement: a strip away from the center of gravity on a translating and rotating body gets
+//     -0.5 rho Cd area |v_n| v_n at its rigid body point velocity, without the part along its axis, and the
+//     matching torque about the center of gravity.
+
+using std::filesystem::path;
+using namespace chrono;
+
+int CheckForce(const Eigen::VectorXd& force, const Eigen::VectorXd& expected, const std::string& what) {
+    double error = (force - expected).cwiseAbs().maxCoeff();
+    double scale = std::max(1.0, expected.cwiseAbs().maxCoeff());
+    return Check(error <= 1e-10 * scale, what, error, 0.0);
+}
+
+// the sphere with linear velocity v and angular velocity w (world frame) at t = 0, configure adds the drag:
+// the drag force TestHydro computes for that state
+Eigen::VectorXd SphereDrag(const ChVector<>& v,
+                           const ChVector<>& w,
+                           std::shared_ptr<WaveBase> waves,
+                           const std::function<void(TestHydro&)>& configure) {
+    path DATADIR(hydroc::getDataDir());
+    auto body1_meshfname =
+        (DATADIR / "sphere" / "geometry" / "oes_task10_sphere.obj").lexically_normal().generic_string();
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+
+    auto sphereBody = chrono_types::make_shared<ChBodyEasyMesh>(body1_meshfname, 1000, false, false, false);
+    system.Add(sphereBody);
+    sphereBody->SetNameString("body1");
+    sphereBody->SetPos(ChVector<>(0, 0, -2));
+    sphereBody->SetMass(261.8e3);
+    sphereBody->SetPos_dt(v);
+    sphereBody->SetWvel_par(w);
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    bodies.push_back(sphereBody);
+    TestHydro hydro_forces(bodies, h5fname, waves);
+    configure(hydro_forces);
+
+    // gathers the body state and evaluates every component once, drag included
+    hydro_forces.coordinateFunc(1, 0);
+    return hydro_forces.ComputeForceDrag();
+}
+
+int main(int argc, char* argv[]) {
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+    int failures = 0;
+
+    path DATADIR(hydroc::getDataDir());
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+    double rho   = H5FileInfo(h5fname, 1).readH5Data().GetRhoVal();
+
+    Eigen::Matrix<double, 6, 6> drag = Eigen::Matrix<double, 6, 6>::Zero();
+    drag.diagonal() << 1e4, 2e4, 5e4, 1e6, 2e6, 3e6;
+    auto body_drag = [&drag](TestHydro& hydro_forces) { hydro_forces.SetQuadraticDrag(0, drag); };
+
+    // constant speed in still water
+    Eigen::VectorXd velocity(6);
+    velocity << 1.5, -0.5, 0.25, 0.1, -0.2, 0.05;
+    ChVector<> v(velocity[0], velocity[1], velocity[2]);
+    ChVector<> w(velocity[3], velocity[4], velocity[5]);
+    Eigen::VectorXd expected = -drag * velocity.cwiseAbs().cwiseProduct(velocity);
+    Eigen::VectorXd force    = SphereDrag(v, w, std::make_shared<NoWave>(1), body_drag);
+    failures += CheckForce(force, expected, "body drag, constant speed");
+
+    force = SphereDrag(2.0 * v, 2.0 * w, std::make_shared<NoWave>(1), body_drag);
+    failures += CheckForce(force, 4.0 * expected, "body drag, twice the speed");
+
+    force = SphereDrag(-v, -w, std::make_shared<NoWave>(1), body_drag);
+    failures += CheckForce(force, -expected, "body drag, reversed");
+
+    // at rest in a regular wave: relative velocity -u on the linear dofs, at the center of gravity
+    auto waves                    = std::make_shared<RegularWave>(1);
+    waves->regular_wave_amplitude = 0.5;
+    waves->regular_wave_omega     = 1.0;
+    force                         = SphereDrag(ChVector<>(0, 0, 0), ChVector<>(0, 0, 0), waves, body_drag);
+    Eigen::Vector3d u             = waves->GetParticleVelocity(Eigen::Vector3d(0.0, 0.0, -2.0), 0.0);
+    failures += Check(u.norm() > 0.0, "regular wave particle velocity", u.norm(), 1.0);
+    expected.setZero(6);
+    expected.head<3>() = drag.topLeftCorner<3, 3>() * u.cwiseAbs().cwiseProduct(u);
+    failures += CheckForce(force, expected, "body drag, regular wave");
+
+    // Morison strip at (0, 2, 0) from the center of gravity, axis z. v = (1.5, 0, 0.8), w = (0, 0, 0.5):
+    // point velocity v + w x r = (0.5, 0, 0.8), the axial 0.8 is removed, F = -c 0.5^2 x
+    double cd    = 1.2;
+    double area  = 3.0;
+    double c     = 0.5 * rho * cd * area;
+    auto morison = [cd, area](TestHydro& hydro_forces) {
+        hydro_forces.AddMorisonElement(0, Eigen::Vector3d(0.0, 2.0, 0.0), Eigen::Vector3d::UnitZ(), cd, area);
+    };
+    force     = SphereDrag(ChVector<>(1.5, 0, 0.8), ChVector<>(0, 0, 0.5), std::make_shared<NoWave>(1), morison);
+    double fx = -c * 0.5 * 0.5;
+    expected.setZero(6);
+    expected[0] = fx;
+    expected[5] = -2.0 * fx;  // r x F = (0, 2, 0) x (fx, 0, 0)
+    failures += CheckForce(force, expected, "Morison element");
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <hydroc/wave_types.h>
+
+#include <algorithm>
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks FreeSurfaceElevation:
+//   - on a uniform time grid (chunked evaluation, several chunks and a partial one) and on a non uniform one,
+//     eta matches the direct sum of the components a_i cos(omega_i t + phase_i),
+//   - the sphere irregular wave demo's elevation (600 s at 0.015 s, 1000 frequencies) is timed.
+
+double MaxErrorToDirectSum(const Eigen::VectorXd& freqs_hz,
+                           const Eigen::VectorXd& spectrum,
+                           const Eigen::VectorXd& time_index,
+                           const Eigen::VectorXd& eta) {
+    Eigen::VectorXd amplitudes = WaveComponentAmplitudes(freqs_hz, spectrum);
+    Eigen::VectorXd phases     = WaveComponentPhases(freqs_hz.size());
+    double error               = 0.0;
+    for (int n = 0; n < time_index.size(); n++) {
+        double sum = 0.0;
+        for (int i = 0; i < freqs_hz.size(); i++) {
+            sum += amplitudes[i] * std::cos(2.0 * M_PI * freqs_hz[i] * time_index[n] + phases[i]);
+        }
+        error = std::max(error, std::abs(eta[n] - sum));
+    }
+    return error;
+}
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+
+    Eigen::VectorXd freqs_hz = Eigen::VectorXd::LinSpaced(1000, 0.001, 1.0);
+    Eigen::VectorXd spectrum = PiersonMoskowitzSpectrumHz(freqs_hz, 2.0, 8.0);
+    Eigen::VectorXd phases   = WaveComponentPhases(freqs_hz.size());
+
+    Eigen::VectorXd uniform = Eigen::VectorXd::LinSpaced(1201, 0.0, 600.0);
+    Eigen::VectorXd eta     = FreeSurfaceElevation(freqs_hz, spectrum, uniform, phases);
+    double error            = MaxErrorToDirectSum(freqs_hz, spectrum, uniform, eta);
+    failures += Check(error < 1e-10, "uniform time grid", error, 0.0);
+
+    Eigen::VectorXd non_uniform = uniform.array().square() / 600.0;
+    eta                         = FreeSurfaceElevation(freqs_hz, spectrum, non_uniform, phases);
+    error                       = MaxErrorToDirectSum(freqs_hz, spectrum, non_uniform, eta);
+    failures += Check(error < 1e-10, "non uniform time grid", error, 0.0);
+
+    Eigen::VectorXd single = Eigen::VectorXd::Constant(1, 3.7);
+    eta                    = FreeSurfaceElevation(freqs_hz, spectrum, single, phases);
+    error                  = MaxErrorToDirectSum(freqs_hz, spectrum, single, eta);
+    failures += Check(error < 1e-10, "single time", error, 0.0);
+
+    // demo_sphere_irreg_waves
+    const double duration = 600.0;
+    const double dt       = 0.015;
+    int num_steps         = static_cast<int>(duration / dt) + 1;
+    Eigen::VectorXd times = Eigen::VectorXd::LinSpaced(num_steps, 0.0, duration);
+    auto begin            = std::chrono::high_resolution_clock::now();
+    eta                   = FreeSurfaceElevation(freqs_hz, spectrum, times, phases);
+    auto end              = std::chrono::high_resolution_clock::now();
+    failures += Check(std::isfinite(eta.sum()), "eta finite", eta.sum(), 0.0);
+    std::cout << num_steps << " steps, " << freqs_hz.size() << " frequencies: "
+              << std::chrono::duration<double, std::milli>(end - begin).count() << " ms" << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <hydroc/helper.h>
+#include <hydroc/hydro_pressure.h>
+
+#include <cmath>
+#include <filesystem>  // C++17
+#include <iostream>
+#include <string>
+
+#include "test_helpers.h"
+
+// Checks HydroPressureMesh on the sphere mesh:
+//   - fully submerged in still water: buoyancy rho g V, no torque, the aggregated (hierarchy) and
+//     per triangle evaluations agree,
+//   - half submerged and rotated: buoyancy of half the volume, no torque about the center,
+//   - deeply submerged under a wave: the linearized node pressure matches the per triangle one,
+//   - HydrostaticTable: exact at grid points (any yaw and horizontal position), close in between,
+//     unchanged by a save / load round trip.
+
+using std::filesystem::path;
+
+static const double RHO = 1000.0;
+static const double G   = 9.81;
+
+// deep water Airy wave along +x
+class TestWave : public WaveBase {
+  public:
+    TestWave(double amplitude, double omega) : amplitude(amplitude), omega(omega), k(omega * omega / G) {}
+    void Initialize() override {}
+    void GetForceAtTime(double t, Eigen::Ref<Eigen::VectorXd> f) override { f.setZero(); }
+    WaveMode GetWaveMode() override { return WaveMode::regular; }
+    double GetElevation(const Eigen::Vector3d& p, double t) override {
+        return amplitude * std::cos(omega * t - k * p.x());
+    }
+    double GetPressureHead(const Eigen::Vector3d& p, double t, Eigen::Vector3d* gradient) override {
+        double decay = std::exp(k * std::min(p.z(), 0.0));
+        double phase = omega * t - k * p.x();
+        if (gradient) {
+            *gradient = Eigen::Vector3d(amplitude * decay * k * std::sin(phase), 0.0,
+                                        p.z() < 0.0 ? amplitude * k * decay * std::cos(phase) : 0.0);
+        }
+        return amplitude * decay * std::cos(phase);
+    }
+    double GetElevationBound() override { return amplitude; }
+    double GetMaxWaveNumber() override { return k; }
+
+  private:
+    double amplitude;
+    double omega;
+    double k;
+};
+
+int main(int argc, char* argv[]) {
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+    path DATADIR(hydroc::getDataDir());
+    auto mesh_fname = (DATADIR / "sphere" / "geometry" / "oes_task10_sphere.obj").lexically_normal().generic_string();
+
+    HydroPressureMesh mesh(mesh_fname);
+    double volume = mesh.GetVolume();
+    std::cout << mesh.GetNumTriangles() << " triangles, " << mesh.GetNumNodes() << " nodes, volume " << volume
+              << std::endl;
+
+    int failures = Check(volume > 0.0, "mesh volume (outward normals)", volume, 0.0);
+    Eigen::Matrix<double, 6, 1> force;
+    Eigen::Matrix<double, 6, 1> reference;
+    const double buoyancy = RHO * G * volume;
+
+    // fully submerged, still water
+    Eigen::Vector3d deep(1.0, 2.0, -30.0);
+    Eigen::Matrix3d rot = Eigen::AngleAxisd(0.7, Eigen::Vector3d(1.0, 2.0, 3.0).normalized()).toRotationMatrix();
+    mesh.Integrate(deep, rot, 0.0, RHO, G, nullptr, false, force);
+    failures += Check(std::abs(force[2] - buoyancy) < 1e-9 * buoyancy, "submerged buoyancy", force[2], buoyancy);
+    failures += Check(force.tail<3>().norm() < 1e-6 * buoyancy, "submerged torque", force.tail<3>().norm(), 0.0);
+    failures += Check(mesh.GetNumAggregatedNodes() == 1, "submerged aggregated nodes", mesh.GetNumAggregatedNodes(), 1);
+
+    mesh.max_linearized_node_kr = -1.0;  // per triangle only
+    mesh.Integrate(deep, rot, 0.0, RHO, G, nullptr, false, reference);
+    failures += Check((force - reference).norm() < 1e-9 * buoyancy, "submerged aggregated vs triangles",
+                      (force - reference).norm(), 0.0);
+    mesh.max_linearized_node_kr = 0.2;
+
+    // half submerged, rotated (the mesh is a sphere about its origin)
+    mesh.Integrate(Eigen::Vector3d(3.0, -1.0, 0.0), rot, 0.0, RHO, G, nullptr, false, force);
+    failures += Check(std::abs(force[2] - 0.5 * buoyancy) < 0.01 * buoyancy, "half submerged buoyancy", force[2],
+                      0.5 * buoyancy);
+    failures += Check(force.head<2>().norm() < 1e-3 * buoyancy, "half submerged lateral force", force.head<2>().norm(),
+                      0.0);
+    failures += Check(force.tail<3>().norm() < 1e-3 * buoyancy, "half submerged torque", force.tail<3>().norm(), 0.0);
+    failures += Check(mesh.GetNumClippedTriangles() > 0, "half submerged clipped triangles",
+                      mesh.GetNumClippedTriangles(), 1);
+
+    // deeply submerged under a 60 m wave: linearized node pressure vs per triangle
+    TestWave wave(1.0, 1.0);
+    mesh.Integrate(deep, rot, 2.0, RHO, G, &wave, true, force);
+    int aggregated = mesh.GetNumAggregatedNodes();
+    mesh.max_linearized_node_kr = -1.0;
+    mesh.Integrate(deep, rot, 2.0, RHO, G, &wave, true, reference);
+    double dynamic = (reference.head<3>() - Eigen::Vector3d(0.0, 0.0, buoyancy)).norm();
+    failures += Check(aggregated > 0, "wave aggregated nodes", aggregated, 1);
+    failures += Check(dynamic > 1e-6 * buoyancy, "wave dynamic force", dynamic, 0.0);
+    failures += Check((force - reference).head<3>().norm() < 0.01 * dynamic, "wave aggregated vs triangles",
+                      (force - reference).head<3>().norm(), 0.0);
+
+    // hydrostatic table
+    mesh.max_linearized_node_kr = 0.2;
+    Eigen::VectorXd heights(5), angles(3);
+    heights << -3.0, -1.0, 0.0, 1.0, 3.0;
+    angles << -0.4, 0.0, 0.4;
+    HydrostaticTable table(mesh, heights, angles, angles, RHO, G);
+    Eigen::Matrix3d grid_rot = (Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitZ()) *
+                                Eigen::AngleAxisd(0.4, Eigen::Vector3d::UnitX()))
+                                   .toRotationMatrix();
+    Eigen::Vector3d grid_pos(4.0, -2.0, -1.0);
+    table.Interpolate(grid_pos, grid_rot, force);
+    mesh.Integrate(grid_pos, grid_rot, 0.0, RHO, G, nullptr, false, reference);
+    failures += Check((force - reference).norm() < 1e-6 * buoyancy, "table at grid point", (force - reference).norm(),
+                      0.0);
+
+    Eigen::Vector3d between(0.0, 0.0, -2.0);
+    table.Interpolate(between, Eigen::Matrix3d::Identity(), force);
+    mesh.Integrate(between, Eigen::Matrix3d::Identity(), 0.0, RHO, G, nullptr, false, reference);
+    failures += Check(std::abs(force[2] - reference[2]) < 0.02 * buoyancy, "table between grid points", force[2],
+                      reference[2]);
+
+    auto table_fname = (std::filesystem::temp_directory_path() / "hydro_pressure_t01_table.txt").generic_string();
+    table.Save(table_fname);
+    HydrostaticTable loaded(table_fname);
+    std::filesystem::remove(table_fname);
+    table.Interpolate(grid_pos, rot, force);
+    loaded.Interpolate(grid_pos, rot, reference);
+    failures += Check(force == reference, "table save / load", (force - reference).norm(), 0.0);
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <hydroc/helper.h>
+#include <hydroc/hydro_forces.h>
+#include <hydroc/hydro_solver.h>
+
+#include <chrono/physics/ChBodyEasy.h>
+#include <chrono/physics/ChLinkLock.h>
+#include <chrono/physics/ChLinkTSDA.h>
+#include <chrono/physics/ChSystemNSC.h>
+#include <chrono/solver/ChDirectSolverLS.h>
+#include <chrono/solver/ChIterativeSolverLS.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>  // C++17
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks the hydro linear solvers (hydro_solver.h) on the heave only sphere in regular waves against
+// Chrono's ChSolverSparseQR:
+//   - ChSolverHydroGMRES (hydro block preconditioner) and ChSolverHydroSparseQR (kept symbolic
+//     factorization) give the same heave time series,
+//   - ChSolverHydroGMRES needs no more iterations than Chrono's GMRES (diagonal preconditioner),
+//     both counts are printed,
+//   - with the sparsity pattern locked (TestHydro::EnableSymbolicReuse) ChSolverHydroSparseQR does the
+//     symbolic factorization once and still matches.
+
+using std::filesystem::path;
+using namespace chrono;
+
+static const int NUM_STEPS = 200;
+
+enum class TestSolver { sparse_qr = 0, gmres = 1, hydro_gmres = 2, hydro_sparse_qr = 3, hydro_sparse_qr_locked = 4 };
+
+struct SolverRun {
+    std::vector<double> heave_position;
+    double mean_iterations  = 0.0;  // iterative solvers only
+    int num_analyze_pattern = 0;    // ChSolverHydroSparseQR only
+};
+
+// same set up as demo_sphere_reg_waves, without visualization, stepped with the given solver
+SolverRun RunSphere(TestSolver solver_type) {
+    path DATADIR(hydroc::getDataDir());
+    auto body1_meshfname =
+        (DATADIR / "sphere" / "geometry" / "oes_task10_sphere.obj").lexically_normal().generic_string();
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+    double timestep = 0.015;
+    system.SetStep(timestep);
+
+    auto ground = chrono_types::make_shared<ChBody>();
+    system.AddBody(ground);
+    ground->SetPos(ChVector<>(0, 0, -5));
+    ground->SetBodyFixed(true);
+    ground->SetCollide(false);
+
+    auto sphereBody = chrono_types::make_shared<ChBodyEasyMesh>(body1_meshfname, 1000, false, false, false);
+    system.Add(sphereBody);
+    sphereBody->SetNameString("body1");
+    sphereBody->SetPos(ChVector<>(0, 0, -2));
+    sphereBody->SetMass(261.8e3);
+
+    auto prismatic = chrono_types::make_shared<ChLinkLockPrismatic>();
+    prismatic->Initialize(sphereBody, ground, false, ChCoordsys<>(ChVector<>(0, 0, -2)),
+                          ChCoordsys<>(ChVector<>(0, 0, -5)));
+    system.AddLink(prismatic);
+
+    auto spring_1 = chrono_types::make_shared<ChLinkTSDA>();
+    spring_1->Initialize(sphereBody, ground, false, ChVector<>(0, 0, -2), ChVector<>(0, 0, -5));
+    spring_1->SetSpringCoefficient(0.0);
+    spring_1->SetDampingCoefficient(1077123.445);
+    system.AddLink(spring_1);
+
+    auto waves                    = std::make_shared<RegularWave>(1);
+    waves->regular_wave_amplitude = 0.594;
+    waves->regular_wave_omega     = 0.571198664;
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    bodies.push_back(sphereBody);
+    TestHydro hydro_forces(bodies, h5fname, waves);
+
+    std::shared_ptr<ChSolver> solver;
+    switch (solver_type) {
+        case TestSolver::sparse_qr:
+            system.SetSolverType(ChSolver::Type::SPARSE_QR);
+            solver = system.GetSolver();
+            break;
+        case TestSolver::gmres:
+        case TestSolver::hydro_gmres: {
+            std::shared_ptr<ChIterativeSolverLS> iterative_solver;
+            if (solver_type == TestSolver::hydro_gmres) {
+                iterative_solver = chrono_types::make_shared<ChSolverHydroGMRES>(bodies);
+            } else {
+                iterative_solver = chrono_types::make_shared<ChSolverGMRES>();
+            }
+            iterative_solver->SetMaxIterations(300);
+            iterative_solver->SetTolerance(1e-12);
+            solver = iterative_solver;
+            system.SetSolver(solver);
+            break;
+        }
+        case TestSolver::hydro_sparse_qr:
+        case TestSolver::hydro_sparse_qr_locked:
+            solver = chrono_types::make_shared<ChSolverHydroSparseQR>();
+            system.SetSolver(solver);
+            if (solver_type == TestSolver::hydro_sparse_qr_locked) {
+                hydro_forces.EnableSymbolicReuse();
+            }
+            break;
+    }
+
+    SolverRun run;
+    run.heave_position.reserve(NUM_STEPS);
+    for (int step = 0; step < NUM_STEPS; step++) {
+        system.DoStepDynamics(timestep);
+        run.heave_position.push_back(sphereBody->GetPos().z());
+        run.mean_iterations += solver->GetIterations();
+    }
+    run.mean_iterations /= NUM_STEPS;
+    if (auto hydro_qr = std::dynamic_pointer_cast<ChSolverHydroSparseQR>(solver)) {
+        run.num_analyze_pattern = hydro_qr->GetNumAnalyzePattern();
+    }
+    return run;
+}
+
+// largest difference of the heave time series, relative to the reference heave amplitude
+double RelativeDifference(const std::vector<double>& heave, const std::vector<double>& reference) {
+    double max_diff  = 0.0;
+    double amplitude = 0.0;
+    for (size_t i = 0; i < reference.size(); i++) {
+        max_diff  = std::max(max_diff, std::abs(heave[i] - reference[i]));
+        amplitude = std::max(amplitude, std::abs(reference[i] - reference[0]));
+    }
+    return max_diff / amplitude;
+}
+
+int main(int argc, char* argv[]) {
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+    int failures = 0;
+
+    SolverRun reference   = RunSphere(TestSolver::sparse_qr);
+    SolverRun gmres       = RunSphere(TestSolver::gmres);
+    SolverRun hydro_gmres = RunSphere(TestSolver::hydro_gmres);
+    SolverRun hydro_qr    = RunSphere(TestSolver::hydro_sparse_qr);
+    SolverRun locked_qr   = RunSphere(TestSolver::hydro_sparse_qr_locked);
+
+    double diff = RelativeDifference(gmres.heave_position, reference.heave_position);
+    failures += Check(diff < 1e-6, "GMRES vs SparseQR heave", diff, 0.0);
+    diff = RelativeDifference(hydro_gmres.heave_position, reference.heave_position);
+    failures += Check(diff < 1e-6, "ChSolverHydroGMRES vs SparseQR heave", diff, 0.0);
+    diff = RelativeDifference(hydro_qr.heave_position, reference.heave_position);
+    failures += Check(diff < 1e-10, "ChSolverHydroSparseQR vs SparseQR heave", diff, 0.0);
+    diff = RelativeDifference(locked_qr.heave_position, reference.heave_position);
+    failures += Check(diff < 1e-10, "ChSolverHydroSparseQR, locked pattern vs SparseQR heave", diff, 0.0);
+    failures += Check(locked_qr.num_analyze_pattern == 1, "symbolic factorizations with the locked pattern",
+                      locked_qr.num_analyze_pattern, 1);
+    failures += Check(hydro_gmres.mean_iterations <= gmres.mean_iterations, "ChSolverHydroGMRES mean iterations",
+                      hydro_gmres.mean_iterations, gmres.mean_iterations);
+    std::cout << "mean GMRES iterations: " << gmres.mean_iterations << " (diagonal), " << hydro_gmres.mean_iterations
+              << " (hydro block)" << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
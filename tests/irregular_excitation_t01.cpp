@@ -0,0 +1,123 @@
+#include <hydroc/wave_types.h>
+
+#include <algorithm>
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks IrregularWave's precomputed excitation force:
+//   - an IRF sampled on the eta time grid matches the direct convolution dt sum_j K(tau_j) eta(t - tau_j),
+//   - an IRF on a coarser h5 like grid (resampled with a spline) matches the direct convolution of the exact IRF,
+//   - GetForceAtTime interpolates between steps and holds the last value after the simulation,
+//   - the precomputation and a call are timed.
+
+static const int NUM_BODIES = 2;
+
+// smooth acausal excitation IRF of body b, dof i
+double Kernel(int b, int i, double tau) {
+    return 1.0e4 * (b + 1) * (i + 1) * std::exp(-0.5 * tau * tau) * std::cos((0.8 + 0.1 * i) * tau + 0.5 * b);
+}
+
+IrregularWave MakeWaves(double irf_dt, double duration, double dt) {
+    const double irf_end = 8.0;
+    int irf_size         = static_cast<int>(std::lround(2.0 * irf_end / irf_dt)) + 1;
+    std::vector<HydroData::IrregularWaveInfo> infos(NUM_BODIES);
+    for (int b = 0; b < NUM_BODIES; b++) {
+        infos[b].excitation_irf_time = Eigen::VectorXd::LinSpaced(irf_size, -irf_end, irf_end);
+        infos[b].excitation_irf_matrix.resize(6, irf_size);
+        for (int i = 0; i < 6; i++) {
+            for (int j = 0; j < irf_size; j++) {
+                infos[b].excitation_irf_matrix(i, j) = Kernel(b, i, infos[b].excitation_irf_time[j]);
+            }
+        }
+    }
+    HydroData::SimulationParameters sim_data;
+    sim_data.rho         = 1000.0;
+    sim_data.g           = 9.81;
+    sim_data.water_depth = 50.0;
+
+    IrregularWave waves(NUM_BODIES);
+    waves.wave_height          = 2.0;
+    waves.wave_period          = 8.0;
+    waves.simulation_duration  = duration;
+    waves.simulation_dt        = dt;
+    waves.ramp_duration        = 10.0;
+    waves.AddH5Data(infos, sim_data);
+    waves.Initialize();
+    return waves;
+}
+
+// dt sum_j K(j dt) eta((n - j) dt), eta = 0 outside the simulation
+double DirectConvolution(const Eigen::VectorXd& eta, int b, int i, int n, double dt) {
+    double f = 0.0;
+    for (int j = -400; j <= 400; j++) {
+        if (n - j >= 0 && n - j < eta.size() && std::abs(j * dt) <= 8.0 + 1e-9) {
+            f += Kernel(b, i, j * dt) * eta[n - j];
+        }
+    }
+    return dt * f;
+}
+
+int main(int argc, char* argv[]) {
+    int failures    = 0;
+    const double dt = 0.02;
+    Eigen::VectorXd force(6 * NUM_BODIES), next(6 * NUM_BODIES);
+
+    for (double irf_dt : {dt, 0.1}) {
+        IrregularWave waves = MakeWaves(irf_dt, 60.0, dt);
+        double tolerance    = irf_dt == dt ? 1e-9 : 1e-3;
+        double scale        = 0.0;
+        double error        = 0.0;
+        for (int n : {0, 1, 7, 400, 1500, 2999, 3000}) {
+            waves.GetForceAtTime(n * dt, force);
+            for (int b = 0; b < NUM_BODIES; b++) {
+                for (int i = 0; i < 6; i++) {
+                    double expected = DirectConvolution(waves.eta, b, i, n, dt);
+                    scale           = std::max(scale, std::abs(expected));
+                    error           = std::max(error, std::abs(force[6 * b + i] - expected));
+                }
+            }
+        }
+        failures += Check(scale > 0.0 && error < tolerance * scale,
+                          "convolution, IRF time step " + std::to_string(irf_dt), error, 0.0);
+    }
+
+    IrregularWave waves = MakeWaves(0.1, 60.0, dt);
+    Eigen::VectorXd expected(6 * NUM_BODIES);
+    waves.GetForceAtTime(30.0, force);
+    waves.GetForceAtTime(30.0 + dt, next);
+    waves.GetForceAtTime(30.0 + 0.25 * dt, expected);
+    failures += Check((expected - 0.75 * force - 0.25 * next).norm() < 1e-9 * force.norm(), "interpolation",
+                      expected[2], 0.75 * force[2] + 0.25 * next[2]);
+    waves.GetForceAtTime(60.0, force);
+    waves.GetForceAtTime(75.0, next);
+    failures += Check((force - next).norm() == 0.0, "after the simulation", next[2], force[2]);
+
+    // a 10 minute run
+    auto begin               = std::chrono::high_resolution_clock::now();
+    IrregularWave long_waves = MakeWaves(0.1, 600.0, dt);
+    auto end                 = std::chrono::high_resolution_clock::now();
+    std::cout << "600 s at " << dt << " s, " << NUM_BODIES << " bodies: Initialize "
+              << std::chrono::duration<double, std::milli>(end - begin).count() << " ms" << std::endl;
+    const int num_steps = 1000000;
+    double sum          = 0.0;
+    begin               = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < num_steps; step++) {
+        long_waves.GetForceAtTime(0.000607 * step, force);
+        sum += force[2];
+    }
+    end = std::chrono::high_resolution_clock::now();
+    failures += Check(std::isfinite(sum), "excitation finite", sum, 0.0);
+    std::cout << "excitation: " << std::chrono::duration<double, std::nano>(end - begin).count() / num_steps
+              << " ns per call" << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <hydroc/wave_types.h>
+
+#include <algorithm>
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks IrregularWave's streaming mode:
+//   - the chunked excitation force matches the whole run table, inside chunks, across chunk boundaries and
+//     between steps, with and without the background prefetch, for two bodies with different IRF spans,
+//   - going back in time reloads the chunk,
+//   - MaskExcitationDofs zeroes the masked dofs of the table and of the stream (chunks already loaded or
+//     prefetched, and the ones after) and leaves the others unchanged,
+//   - a 3 hour run at 0.01 s is timed (Initialize, then amortized per call).
+
+static const int NUM_BODIES = 2;
+
+// smooth acausal excitation IRF of body b, dof i
+double Kernel(int b, int i, double tau) {
+    return 1.0e4 * (b + 1) * (i + 1) * std::exp(-0.5 * tau * tau) * std::cos((0.8 + 0.1 * i) * tau + 0.5 * b);
+}
+
+IrregularWave MakeWaves(bool streaming, bool prefetch, int chunk_steps, double duration, double dt) {
+    std::vector<HydroData::IrregularWaveInfo> infos(NUM_BODIES);
+    for (int b = 0; b < NUM_BODIES; b++) {
+        // body 1: shorter and not centered
+        double irf_start = b == 0 ? -8.0 : -5.0;
+        double irf_end   = b == 0 ? 8.0 : 6.0;
+        int irf_size     = static_cast<int>(std::lround((irf_end - irf_start) / 0.1)) + 1;
+        infos[b].excitation_irf_time = Eigen::VectorXd::LinSpaced(irf_size, irf_start, irf_end);
+        infos[b].excitation_irf_matrix.resize(6, irf_size);
+        for (int i = 0; i < 6; i++) {
+            for (int j = 0; j < irf_size; j++) {
+                infos[b].excitation_irf_matrix(i, j) = Kernel(b, i, infos[b].excitation_irf_time[j]);
+            }
+        }
+    }
+    HydroData::SimulationParameters sim_data;
+    sim_data.rho         = 1000.0;
+    sim_data.g           = 9.81;
+    sim_data.water_depth = 50.0;
+
+    IrregularWave waves(NUM_BODIES);
+    waves.wave_height          = 2.0;
+    waves.wave_period          = 8.0;
+    waves.simulation_duration  = duration;
+    waves.simulation_dt        = dt;
+    waves.ramp_duration        = 10.0;
+    waves.streaming            = streaming;
+    waves.stream_chunk_steps   = chunk_steps;
+    waves.stream_prefetch      = prefetch;
+    waves.AddH5Data(infos, sim_data);
+    waves.Initialize();
+    return waves;
+}
+
+int main(int argc, char* argv[]) {
+    int failures    = 0;
+    const double dt = 0.02;
+    Eigen::VectorXd force(6 * NUM_BODIES), expected(6 * NUM_BODIES);
+
+    IrregularWave table = MakeWaves(false, false, 0, 120.0, dt);
+    for (bool prefetch : {false, true}) {
+        IrregularWave stream = MakeWaves(true, prefetch, 500, 120.0, dt);
+        std::string name     = prefetch ? "streaming with prefetch" : "streaming";
+        double scale         = 0.0;
+        double error         = 0.0;
+        // the table's eta stops at 120 s, the IRF looks 8 s ahead
+        for (double t = 0.0; t < 111.9; t += 0.0137) {
+            stream.GetForceAtTime(t, force);
+            table.GetForceAtTime(t, expected);
+            scale = std::max(scale, expected.cwiseAbs().maxCoeff());
+            error = std::max(error, (force - expected).cwiseAbs().maxCoeff());
+        }
+        for (double t : {9.99, 10.0, 10.01, 3.3, 0.0, 100.0}) {  // chunk boundary at 10 s, then back
+            stream.GetForceAtTime(t, force);
+            table.GetForceAtTime(t, expected);
+            error = std::max(error, (force - expected).cwiseAbs().maxCoeff());
+        }
+        failures += Check(scale > 0.0 && error < 1e-9 * scale, name, error, 0.0);
+    }
+
+    // mask after a few chunks: the stream zeroes the loaded, prefetched and later chunks of the masked dofs
+    std::vector<char> dof_active(6 * NUM_BODIES, 1);
+    dof_active[0] = dof_active[1] = dof_active[6 * NUM_BODIES - 1] = 0;
+    for (bool prefetch : {false, true}) {
+        IrregularWave stream = MakeWaves(true, prefetch, 500, 120.0, dt);
+        stream.GetForceAtTime(15.0, force);
+        stream.MaskExcitationDofs(dof_active);
+        double error = 0.0;
+        for (double t : {15.0, 19.99, 25.0, 60.0, 3.0}) {
+            stream.GetForceAtTime(t, force);
+            table.GetForceAtTime(t, expected);
+            for (int i = 0; i < 6 * NUM_BODIES; i++) {
+                error = std::max(error, std::abs(force[i] - (dof_active[i] ? expected[i] : 0.0)));
+            }
+        }
+        failures += Check(error < 1e-9 * expected.cwiseAbs().maxCoeff(),
+                          prefetch ? "masked dofs, streaming with prefetch" : "masked dofs, streaming", error, 0.0);
+    }
+    IrregularWave masked_table = MakeWaves(false, false, 0, 120.0, dt);
+    masked_table.MaskExcitationDofs(dof_active);
+    double mask_error = 0.0;
+    for (double t : {0.5, 30.0, 90.0}) {
+        masked_table.GetForceAtTime(t, force);
+        table.GetForceAtTime(t, expected);
+        for (int i = 0; i < 6 * NUM_BODIES; i++) {
+            mask_error = std::max(mask_error, std::abs(force[i] - (dof_active[i] ? expected[i] : 0.0)));
+        }
+    }
+    failures += Check(mask_error == 0.0, "masked dofs, table", mask_error, 0.0);
+
+    // 3 hours, default chunks
+    auto begin           = std::chrono::high_resolution_clock::now();
+    IrregularWave stream = MakeWaves(true, true, IrregularWave().stream_chunk_steps, 0.0, 0.01);
+    auto end             = std::chrono::high_resolution_clock::now();
+    std::cout << "streaming Initialize: " << std::chrono::duration<double, std::milli>(end - begin).count() << " ms"
+              << std::endl;
+    const int num_steps = 1080000;
+    double sum          = 0.0;
+    begin               = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < num_steps; step++) {
+        stream.GetForceAtTime(0.01 * step, force);
+        sum += force[2];
+    }
+    end = std::chrono::high_resolution_clock::now();
+    failures += Check(std::isfinite(sum), "excitation finite", sum, 0.0);
+    std::cout << "3 hours at 0.01 s, " << NUM_BODIES
+              << " bodies: " << std::chrono::duration<double, std::nano>(end - begin).count() / num_steps
+              << " ns per call" << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <hydroc/mooring.h>
+
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "test_helpers.h"
+
+// Checks CatenaryMooring:
+//   - SolveCatenary reproduces the span for slack (seabed contact) and fully suspended lines, and
+//     the seabed contact switch is consistent with the line weight,
+//   - the tabulated tension matches the Newton solution between grid points,
+//   - three symmetric lines give no net horizontal force or torque on a centered body, an offset
+//     body gets a restoring force,
+//   - LumpedMassMooring: the lines start and stay at rest on their static shape (fairlead force
+//     matches the catenary), 12 lines of 50 segments are timed.
+
+static const double DEPTH = 200.0;
+
+// OC4 DeepCWind semi-submersible like line: 835.35 m, 108.63 kg/m wet, EA 753.6 MN
+CatenaryLine MakeLine(double angle) {
+    CatenaryLine line;
+    line.body      = 0;
+    line.fairlead  = Eigen::Vector3d(40.868 * std::cos(angle), 40.868 * std::sin(angle), -14.0);
+    line.anchor    = Eigen::Vector3d(837.6 * std::cos(angle), 837.6 * std::sin(angle), -DEPTH);
+    line.length    = 835.35;
+    line.weight    = 108.63 * 9.81;
+    line.stiffness = 753.6e6;
+    return line;
+}
+
+LumpedMassLine MakeDynamicLine(double angle, int segments) {
+    CatenaryLine catenary = MakeLine(angle);
+    LumpedMassLine line;
+    line.body         = 0;
+    line.fairlead     = catenary.fairlead;
+    line.anchor       = catenary.anchor;
+    line.length       = catenary.length;
+    line.diameter     = 0.0766;
+    line.mass         = 113.35;
+    line.stiffness    = catenary.stiffness;
+    line.damping      = 2e6;
+    line.num_segments = segments;
+    return line;
+}
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+    const double pi = 3.14159265358979323846;
+
+    // direct solutions
+    CatenaryLine line = MakeLine(0.0);
+    for (double x : {700.0, 780.0, 800.0}) {
+        Eigen::Vector2d tension = CatenaryMooring::SolveCatenary(line, x, 186.0);
+        Eigen::Vector2d span    = CatenaryMooring::CatenarySpan(line, tension[0], tension[1]);
+        failures += Check((span - Eigen::Vector2d(x, 186.0)).norm() < 1e-6, "catenary span", span[0], x);
+        failures += Check(tension[0] > 0.0, "horizontal tension", tension[0], 1.0);
+        std::cout << "span " << x << ": H " << tension[0] << " N, V " << tension[1] << " N" << std::endl;
+    }
+    // short span: part of the line on the seabed, V is the weight of the suspended part
+    Eigen::Vector2d slack = CatenaryMooring::SolveCatenary(line, 700.0, 186.0);
+    failures += Check(slack[1] < line.weight * line.length, "slack line vertical tension", slack[1],
+                      line.weight * line.length);
+    // shorter than the line can reach lying straight: hangs vertically, no horizontal tension
+    Eigen::Vector2d piled = CatenaryMooring::SolveCatenary(line, 600.0, 186.0);
+    failures += Check(piled[0] == 0.0 && std::abs(piled[1] - line.weight * 186.0) < 1e-3 * piled[1],
+                      "piled up line vertical tension", piled[1], line.weight * 186.0);
+    // nearly taut: fully suspended
+    Eigen::Vector2d hanging = CatenaryMooring::SolveCatenary(line, 300.0, 780.0);
+    failures += Check(hanging[1] > line.weight * line.length, "suspended line vertical tension", hanging[1],
+                      line.weight * line.length);
+
+    // table lookup vs Newton, three lines at 120 degrees
+    CatenaryMooring mooring(20.0, 64);
+    for (int i = 0; i < 3; i++) {
+        mooring.AddLine(MakeLine(pi + 2.0 * pi * i / 3.0));
+    }
+    HydroBodyStates states;
+    states.resize(1);
+    mooring.Initialize(states);
+
+    Eigen::VectorXd force = Eigen::VectorXd::Zero(6);
+    mooring.AddForce(0.0, states, force);
+    double vertical = -force[2];
+    failures += Check(vertical > 0.0, "mooring pulls down", force[2], -1.0);
+    failures += Check(force.head<2>().norm() < 1e-6 * vertical, "centered horizontal force", force.head<2>().norm(),
+                      0.0);
+    failures += Check(force.tail<3>().norm() < 1e-6 * vertical * 40.0, "centered torque", force.tail<3>().norm(), 0.0);
+
+    // surge offset between grid points: compare every line with the direct solution
+    states.position << 7.3, 0.0, 0.4;
+    force.setZero();
+    mooring.AddForce(0.0, states, force);
+    failures += Check(force[0] < 0.0, "surge restoring force", force[0], -1.0);
+    for (int i = 0; i < 3; i++) {
+        CatenaryLine l           = MakeLine(pi + 2.0 * pi * i / 3.0);
+        Eigen::Vector3d fairlead = states.position.head<3>() + l.fairlead;
+        double x                 = (fairlead - l.anchor).head<2>().norm();
+        double z                 = fairlead.z() - l.anchor.z();
+        Eigen::Vector2d exact    = CatenaryMooring::SolveCatenary(l, x, z);
+        Eigen::Vector2d lookup   = mooring.GetFairleadTensions().col(i);
+        failures += Check((lookup - exact).norm() < 1e-3 * exact.norm(), "table vs Newton", lookup[0], exact[0]);
+    }
+
+    // lumped mass lines at rest: quasi-static fairlead force, nothing moves
+    states.position.setZero();
+    LumpedMassMooring dynamic(1025.0, 9.81);
+    for (int i = 0; i < 3; i++) {
+        dynamic.AddLine(MakeDynamicLine(pi + 2.0 * pi * i / 3.0, 50));
+    }
+    dynamic.Initialize(states);
+    LumpedMassMooring::NodeArray start = dynamic.GetNodePositions();
+    for (int step = 0; step <= 2000; step++) {
+        force.setZero();
+        dynamic.AddForce(0.01 * step, states, force);
+    }
+    Eigen::Vector2d exact = CatenaryMooring::SolveCatenary(line, 837.6 - 40.868, 186.0);
+    Eigen::Vector3d pull  = dynamic.GetFairleadForces().col(0);
+    double drift          = (dynamic.GetNodePositions() - start).abs().maxCoeff();
+    std::cout << "lumped mass fairlead H " << pull.head<2>().norm() << " N, V " << -pull.z() << " N, sub-step "
+              << dynamic.GetSubstep(0) << " s, max node drift " << drift << " m" << std::endl;
+    failures += Check(std::abs(pull.head<2>().norm() - exact[0]) < 0.03 * exact[0], "lumped mass horizontal tension",
+                      pull.head<2>().norm(), exact[0]);
+    failures += Check(std::abs(-pull.z() - exact[1]) < 0.03 * exact[1], "lumped mass vertical tension", -pull.z(),
+                      exact[1]);
+    failures += Check(drift < 0.5, "lumped mass at rest", drift, 0.0);
+
+    // 12 lines of 50 segments, heaving body
+    LumpedMassMooring farm(1025.0, 9.81);
+    for (int i = 0; i < 12; i++) {
+        farm.AddLine(MakeDynamicLine(2.0 * pi * i / 12.0, 50));
+    }
+    farm.Initialize(states);
+    const int num_steps = 1000;
+    auto begin          = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < num_steps; step++) {
+        states.position[2] = 2.0 * std::sin(0.5 * 0.01 * step);
+        force.setZero();
+        farm.AddForce(0.01 * step, states, force);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    failures += Check(force.allFinite(), "lumped mass force finite", force.norm(), 0.0);
+    double per_step = std::chrono::duration<double, std::micro>(end - begin).count() / num_steps;
+    std::cout << "12 lines x 50 segments: " << per_step << " us per 0.01 s step" << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
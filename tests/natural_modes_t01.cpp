@@ -0,0 +1,163 @@
+#include <hydroc/h5fileinfo.h>
+#include <hydroc/helper.h>
+#include <hydroc/natural_modes.h>
+
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <complex>
+#include <filesystem>  // C++17
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks NaturalModeAnalysis on the sphere (demo_sphere_decay):
+//   - the heave period and damping ratio match the decay reference data
+//     (sphere/postprocessing/sphere_decay_comparison.txt, linear codes and CFD),
+//   - the modes solve the quadratic eigenproblem at their frequency,
+//   - analysing heave alone gives the same heave mode, the analysis is timed.
+
+using std::filesystem::path;
+
+// mean damped period (zero crossings over the first two cycles) and damping ratio (logarithmic decrement of
+// the first peaks) of the decay time series in the reference file, over all its columns
+bool ReferenceDecay(const std::string& file_name, double& period, double& damping_ratio) {
+    std::ifstream file(file_name);
+    std::string line;
+    std::getline(file, line);  // header
+    std::vector<std::vector<double>> times, values;
+    while (std::getline(file, line)) {
+        std::stringstream cells(line);
+        std::string cell;
+        double t = 0.0;
+        for (int c = 0; std::getline(cells, cell, '\t'); c++) {
+            if (cell.find_first_not_of(" \r") == std::string::npos) {
+                continue;
+            }
+            if (c == 0) {
+                t = std::stod(cell);
+                continue;
+            }
+            if (static_cast<int>(values.size()) < c) {
+                times.resize(c);
+                values.resize(c);
+            }
+            times[c - 1].push_back(t);
+            values[c - 1].push_back(std::stod(cell));
+        }
+    }
+    period        = 0.0;
+    damping_ratio = 0.0;
+    int columns   = 0;
+    for (size_t c = 0; c < values.size(); c++) {
+        const std::vector<double>& t = times[c];
+        const std::vector<double>& z = values[c];
+        std::vector<double> crossings, peaks{std::abs(z[0])};
+        for (size_t i = 0; i + 1 < z.size(); i++) {
+            if (z[i] * z[i + 1] < 0.0) {
+                crossings.push_back(t[i] - z[i] * (t[i + 1] - t[i]) / (z[i + 1] - z[i]));
+            }
+            if (i > 0 && std::abs(z[i]) > std::abs(z[i - 1]) && std::abs(z[i]) >= std::abs(z[i + 1])) {
+                peaks.push_back(std::abs(z[i]));
+            }
+        }
+        if (crossings.size() < 5 || peaks.size() < 4) {
+            continue;
+        }
+        double decrement = 2.0 * std::log(peaks[0] / peaks[3]) / 3.0;  // per cycle, from half cycles
+        period += (crossings[4] - crossings[0]) / 2.0;
+        damping_ratio += decrement / std::sqrt(4.0 * M_PI * M_PI + decrement * decrement);
+        columns++;
+    }
+    if (columns == 0) {
+        return false;
+    }
+    period /= columns;
+    damping_ratio /= columns;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+    path DATADIR(hydroc::getDataDir());
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+    auto reference_fname =
+        (DATADIR / "sphere" / "postprocessing" / "sphere_decay_comparison.txt").lexically_normal().generic_string();
+
+    int failures   = 0;
+    HydroData data = H5FileInfo(h5fname, 1).readH5Data();
+
+    // demo_sphere_decay's mass, inertia of a uniform sphere of radius 5 m
+    const double mass    = 261.8e3;
+    const double inertia = 0.4 * mass * 25.0;
+    Eigen::MatrixXd mass_matrix(6, 6);
+    mass_matrix.diagonal() << mass, mass, mass, inertia, inertia, inertia;
+
+    NaturalModeAnalysis analysis(data, mass_matrix);
+    const int num_runs = 20;
+    std::vector<NaturalMode> modes;
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < num_runs; run++) {
+        modes = analysis.Solve();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    const NaturalMode* heave = nullptr;
+    for (const NaturalMode& mode : modes) {
+        std::cout << "dof " << mode.dof << ": period " << mode.period << " s, damping ratio " << mode.damping_ratio
+                  << ", " << mode.iterations << " iterations" << std::endl;
+        failures += Check(mode.converged, "converged", mode.iterations, 0);
+        if (mode.dof == 2) {
+            heave = &mode;
+        }
+        // residual of the quadratic eigenproblem at the mode's own frequency
+        if (mode.omega > 0.0) {
+            Eigen::MatrixXd added_mass, damping;
+            analysis.GetRadiationCoefficients(mode.omega, added_mass, damping);
+            Eigen::MatrixXd stiffness(6, 6);
+            for (int i = 0; i < 6; i++) {
+                for (int j = 0; j < 6; j++) {
+                    stiffness(i, j) = data.GetHydrostaticStiffnessVal(0, i, j);
+                }
+            }
+            double omega_n              = mode.omega / std::sqrt(1.0 - mode.damping_ratio * mode.damping_ratio);
+            std::complex<double> lambda = {-mode.damping_ratio * omega_n, mode.omega};
+            Eigen::MatrixXcd quadratic  = (lambda * lambda) * (mass_matrix + added_mass).cast<std::complex<double>>() +
+                                         lambda * damping.cast<std::complex<double>>() +
+                                         stiffness.cast<std::complex<double>>();
+            double residual = (quadratic * mode.shape).norm() / (stiffness * mode.shape.cwiseAbs()).norm();
+            failures += Check(residual < 1e-6, "quadratic eigenproblem residual", residual, 0.0);
+        }
+    }
+    std::cout << "analysis: " << std::chrono::duration<double, std::milli>(end - begin).count() / num_runs << " ms"
+              << std::endl;
+
+    double reference_period, reference_damping_ratio;
+    failures += Check(ReferenceDecay(reference_fname, reference_period, reference_damping_ratio),
+                      "reference decay data", 0, 1);
+    failures += Check(heave != nullptr, "heave mode", 0, 1);
+    if (heave != nullptr) {
+        std::cout << "heave reference: period " << reference_period << " s, damping ratio " << reference_damping_ratio
+                  << std::endl;
+        failures += Check(std::abs(heave->period - reference_period) < 0.03 * reference_period, "heave period",
+                          heave->period, reference_period);
+        failures += Check(std::abs(heave->damping_ratio - reference_damping_ratio) < 0.2 * reference_damping_ratio,
+                          "heave damping ratio", heave->damping_ratio, reference_damping_ratio);
+
+        // heave alone (prismatic joint): the sphere's heave does not couple
+        std::vector<NaturalMode> heave_only = NaturalModeAnalysis(data, mass_matrix, {2}).Solve();
+        failures += Check(std::abs(heave_only[0].period - heave->period) < 1e-6 * heave->period, "heave only period",
+                          heave_only[0].period, heave->period);
+    }
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
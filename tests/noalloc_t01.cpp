@@ -0,0 +1,249 @@
+#include <hydroc/helper.h>
+#include <hydroc/hydro_forces.h>
+
+#include <chrono/physics/ChBodyEasy.h>
+#include <chrono/physics/ChLinkLock.h>
+#include <chrono/physics/ChLinkTSDA.h>
+#include <chrono/physics/ChSystemNSC.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>  // C++17
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Checks the TestHydro allocation guarantee: once initialized, DoStepDynamics makes no heap
+// allocation inside HydroChrono code (hydro force path, wave force path, added mass load), on rm3
+// with regular waves, drag and drift, and on the sphere with streaming irregular waves (chunks loaded
+// and prefetched on the worker thread while stepping).
+//
+// The global allocator is wrapped and counts while g_counting is set, around DoStepDynamics. An
+// allocation is attributed to the library when it happens inside a hydroc::StepScope, which the
+// library's per step entry points hold on their thread; Chrono's own allocations are not counted.
+
+static std::atomic<bool> g_counting{false};
+static std::atomic<long> g_allocations{0};
+
+static void CountAllocation() {
+    if (g_counting && hydroc::inStepScope()) g_allocations++;
+}
+
+#if defined(__GLIBC__)
+// On glibc wrap malloc itself: Eigen allocates through std::malloc, not through operator new
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+    CountAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    CountAllocation();
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    CountAllocation();
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+// Elsewhere only operator new can be replaced portably
+void* operator new(std::size_t size) {
+    CountAllocation();
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
+using std::filesystem::path;
+using namespace chrono;
+
+// HydroChrono allocations in num_steps steps, after a first step that sets everything up
+long CountStepAllocations(ChSystem& system, double timestep, int num_steps) {
+    system.DoStepDynamics(timestep);
+    g_allocations = 0;
+    g_counting    = true;
+    for (int step = 0; step < num_steps; step++) {
+        system.DoStepDynamics(timestep);
+    }
+    g_counting = false;
+    return g_allocations;
+}
+
+// same set up as the sphere irregular wave demo, streaming with short chunks
+long SphereStreaming(int num_steps) {
+    path DATADIR(hydroc::getDataDir());
+    auto body1_meshfname =
+        (DATADIR / "sphere" / "geometry" / "oes_task10_sphere.obj").lexically_normal().generic_string();
+    auto h5fname = (DATADIR / "sphere" / "hydroData" / "sphere.h5").lexically_normal().generic_string();
+
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+    double timestep = 0.015;
+    system.SetSolverType(ChSolver::Type::GMRES);
+    system.SetSolverMaxIterations(300);
+    system.SetStep(timestep);
+
+    auto ground = chrono_types::make_shared<ChBody>();
+    system.AddBody(ground);
+    ground->SetPos(ChVector<>(0, 0, -5));
+    ground->SetBodyFixed(true);
+    ground->SetCollide(false);
+
+    auto sphereBody = chrono_types::make_shared<ChBodyEasyMesh>(body1_meshfname, 1000, false, false, false);
+    system.Add(sphereBody);
+    sphereBody->SetNameString("body1");
+    sphereBody->SetPos(ChVector<>(0, 0, -2));
+    sphereBody->SetMass(261.8e3);
+
+    auto prismatic = chrono_types::make_shared<ChLinkLockPrismatic>();
+    prismatic->Initialize(sphereBody, ground, false, ChCoordsys<>(ChVector<>(0, 0, -2)),
+                          ChCoordsys<>(ChVector<>(0, 0, -5)));
+    system.AddLink(prismatic);
+
+    auto waves                = std::make_shared<IrregularWave>();
+    waves->wave_height        = 2.0;
+    waves->wave_period        = 12.0;
+    waves->simulation_dt      = timestep;
+    waves->ramp_duration      = 3.0;
+    waves->streaming          = true;
+    waves->stream_chunk_steps = 64;
+    waves->stream_prefetch    = true;
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    bodies.push_back(sphereBody);
+    TestHydro hydro_forces(bodies, h5fname);
+    hydro_forces.AddWaves(waves);
+
+    return CountStepAllocations(system, timestep, num_steps);
+}
+
+int main(int argc, char* argv[]) {
+    if (hydroc::setInitialEnvironment(argc, argv) != 0) {
+        return 1;
+    }
+
+    path DATADIR(hydroc::getDataDir());
+
+    auto h5fname     = (DATADIR / "rm3" / "hydroData" / "rm3.h5").lexically_normal().generic_string();
+    auto b1Meshfname = (DATADIR / "rm3" / "geometry" / "float_cog.obj").lexically_normal().generic_string();
+    auto b2Meshfname = (DATADIR / "rm3" / "geometry" / "plate_cog.obj").lexically_normal().generic_string();
+
+    // same set up as demo_rm3_reg_waves, without visualization
+    ChSystemNSC system;
+    system.Set_G_acc(ChVector<>(0.0, 0.0, -9.81));
+    double timestep = 0.01;
+    system.SetTimestepperType(ChTimestepper::Type::HHT);
+    system.SetSolverType(ChSolver::Type::GMRES);
+    system.SetSolverMaxIterations(300);
+    system.SetStep(timestep);
+
+    auto float_body1 = chrono_types::make_shared<ChBodyEasyMesh>(b1Meshfname, 0, false, false, false);
+    system.Add(float_body1);
+    float_body1->SetNameString("body1");
+    float_body1->SetPos(ChVector<>(0, 0, -0.72));
+    float_body1->SetMass(725834);
+    float_body1->SetInertiaXX(ChVector<>(20907301.0, 21306090.66, 37085481.11));
+
+    auto plate_body2 = chrono_types::make_shared<ChBodyEasyMesh>(b2Meshfname, 0, false, false, false);
+    system.Add(plate_body2);
+    plate_body2->SetNameString("body2");
+    plate_body2->SetPos(ChVector<>(0, 0, -21.29));
+    plate_body2->SetMass(886691);
+    plate_body2->SetInertiaXX(ChVector<>(94419614.57, 94407091.24, 28542224.82));
+
+    auto prismatic = chrono_types::make_shared<ChLinkLockPrismatic>();
+    prismatic->Initialize(float_body1, plate_body2, false, ChCoordsys<>(ChVector<>(0, 0, -0.72)),
+                          ChCoordsys<>(ChVector<>(0, 0, -21.29)));
+    system.AddLink(prismatic);
+
+    auto prismatic_pto = chrono_types::make_shared<ChLinkTSDA>();
+    prismatic_pto->Initialize(float_body1, plate_body2, false, ChVector<>(0, 0, -0.72), ChVector<>(0, 0, -21.29));
+    prismatic_pto->SetDampingCoefficient(0.0);
+    system.AddLink(prismatic_pto);
+
+    auto waves                    = std::make_shared<RegularWave>(2);
+    waves->regular_wave_amplitude = 1.0;
+    waves->regular_wave_omega     = 2.10;
+
+    std::vector<std::shared_ptr<ChBody>> bodies;
+    bodies.push_back(float_body1);
+    bodies.push_back(plate_body2);
+    TestHydro hydro_forces(bodies, h5fname);
+    hydro_forces.AddWaves(waves);
+    // viscous drag on both bodies: 6x6 coefficients on the float, Morison strips on the plate
+    Eigen::Matrix<double, 6, 6> drag = Eigen::Matrix<double, 6, 6>::Zero();
+    drag.diagonal() << 1e4, 1e4, 5e4, 1e6, 1e6, 1e6;
+    hydro_forces.SetQuadraticDrag(0, drag);
+    for (int i = 0; i < 4; i++) {
+        double angle = i * CH_C_PI_2;
+        hydro_forces.AddMorisonElement(1, Eigen::Vector3d(10.0 * std::cos(angle), 10.0 * std::sin(angle), 0.0),
+                                       Eigen::Vector3d::UnitZ(), 1.0, 50.0);
+    }
+    // slow drift on the float (rm3.h5 has no mean drift coefficients)
+    Eigen::VectorXd drift_omegas = Eigen::VectorXd::LinSpaced(10, 0.5, 3.0);
+    Eigen::MatrixXd drift        = Eigen::MatrixXd::Zero(6, 10);
+    drift.row(0).setConstant(2e3);
+    hydro_forces.SetMeanDriftCoefficients(0, drift_omegas, drift);
+
+    // the hooks see an allocation made inside a StepScope
+    g_counting = true;
+    std::vector<double> probe;
+    {
+        hydroc::StepScope step_scope;
+        probe.resize(16);
+    }
+    g_counting = false;
+    if (g_allocations != 1) {
+        std::cerr << "allocation hooks not working: " << g_allocations << " allocations counted" << std::endl;
+        return 1;
+    }
+
+    const int num_steps = 1000;
+    long allocations    = CountStepAllocations(system, timestep, num_steps);
+    std::cout << "HydroChrono allocations in " << num_steps << " steps: " << allocations << std::endl;
+    if (allocations != 0) {
+        std::cerr << "HydroChrono allocated memory during steady state stepping" << std::endl;
+        return 1;
+    }
+
+    allocations = SphereStreaming(num_steps);
+    std::cout << "HydroChrono allocations in " << num_steps << " steps, streaming irregular waves: " << allocations
+              << std::endl;
+    if (allocations != 0) {
+        std::cerr << "HydroChrono allocated memory while streaming the irregular wave excitation" << std::endl;
+        return 1;
+    }
+
+    std::cout << "End" << std::endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <hydroc/wave_types.h>
+
+#include <algorithm>
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks PolychromaticWave:
+//   - one component matches RegularWave (excitation, elevation, pressure head, particle velocity),
+//   - a component phase is a time shift, two components are the sum of two regular waves,
+//   - components outside the h5 frequency range are refused, 16 components on 3 bodies are timed,
+//   - SinCos matches std::sin / std::cos.
+
+static const int NUM_BODIES = 3;
+
+// h5 like coefficients on the frequency grid d_omega * (1 ... num_freqs)
+std::vector<HydroData::RegularWaveInfo> MakeInfos() {
+    const int num_freqs  = 60;
+    const double d_omega = 0.05;
+    std::vector<HydroData::RegularWaveInfo> infos(NUM_BODIES);
+    for (int b = 0; b < NUM_BODIES; b++) {
+        HydroData::RegularWaveInfo& info = infos[b];
+        info.freq_list                   = Eigen::VectorXd::LinSpaced(num_freqs, d_omega, d_omega * num_freqs);
+        info.excitation_mag_matrix.resize(6, 1, num_freqs);
+        info.excitation_phase_matrix.resize(6, 1, num_freqs);
+        for (int i = 0; i < 6; i++) {
+            for (int k = 0; k < num_freqs; k++) {
+                info.excitation_mag_matrix(i, 0, k)   = 1.0e5 * (b + 1) * (i + 1) / (1.0 + 0.3 * k);
+                info.excitation_phase_matrix(i, 0, k) = 0.3 * i - 0.7 * b + 0.04 * k;
+            }
+        }
+    }
+    return infos;
+}
+
+HydroData::SimulationParameters MakeSimData() {
+    HydroData::SimulationParameters sim_data;
+    sim_data.rho         = 1000.0;
+    sim_data.g           = 9.81;
+    sim_data.water_depth = 30.0;
+    return sim_data;
+}
+
+RegularWave MakeRegular(double amplitude, double omega) {
+    std::vector<HydroData::RegularWaveInfo> infos = MakeInfos();
+    HydroData::SimulationParameters sim_data      = MakeSimData();
+    RegularWave regular(NUM_BODIES);
+    regular.regular_wave_amplitude = amplitude;
+    regular.regular_wave_omega     = omega;
+    regular.AddH5Data(infos, sim_data);
+    regular.Initialize();
+    return regular;
+}
+
+PolychromaticWave MakePolychromatic(const std::vector<WaveComponent>& components) {
+    std::vector<HydroData::RegularWaveInfo> infos = MakeInfos();
+    HydroData::SimulationParameters sim_data      = MakeSimData();
+    PolychromaticWave waves(NUM_BODIES);
+    for (const WaveComponent& c : components) {
+        waves.AddComponent(c.amplitude, c.omega, c.phase);
+    }
+    waves.AddH5Data(infos, sim_data);
+    waves.Initialize();
+    return waves;
+}
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+    Eigen::VectorXd force(6 * NUM_BODIES), expected(6 * NUM_BODIES), other(6 * NUM_BODIES);
+    const std::vector<Eigen::Vector3d> points{{0.0, 0.0, 0.0}, {3.0, 1.0, -2.5}, {-7.0, 0.0, -12.0}};
+
+    // one component, between grid frequencies: RegularWave
+    RegularWave regular      = MakeRegular(0.8, 0.63);
+    PolychromaticWave single = MakePolychromatic({{0.8, 0.63}});
+    for (double t : {0.0, 2.1, 333.3}) {
+        single.GetForceAtTime(t, force);
+        regular.GetForceAtTime(t, expected);
+        failures += Check((force - expected).norm() < 1e-9 * expected.norm(), "single component excitation",
+                          force[2], expected[2]);
+        for (const Eigen::Vector3d& p : points) {
+            Eigen::Vector3d gradient, expected_gradient;
+            failures += Check(std::abs(single.GetElevation(p, t) - regular.GetElevation(p, t)) < 1e-12,
+                              "single component elevation", single.GetElevation(p, t), regular.GetElevation(p, t));
+            double head          = single.GetPressureHead(p, t, &gradient);
+            double expected_head = regular.GetPressureHead(p, t, &expected_gradient);
+            failures += Check(std::abs(head - expected_head) < 1e-12 && (gradient - expected_gradient).norm() < 1e-12,
+                              "single component pressure head", head, expected_head);
+            failures += Check((single.GetParticleVelocity(p, t) - regular.GetParticleVelocity(p, t)).norm() < 1e-12,
+                              "single component particle velocity", single.GetParticleVelocity(p, t)[0],
+                              regular.GetParticleVelocity(p, t)[0]);
+        }
+    }
+
+    // phase: time shift; two components: superposition
+    const double phase        = 1.2;
+    PolychromaticWave shifted = MakePolychromatic({{0.8, 0.63, phase}});
+    RegularWave second        = MakeRegular(0.3, 1.37);
+    PolychromaticWave both    = MakePolychromatic({{0.8, 0.63}, {0.3, 1.37}});
+    for (double t : {0.5, 41.0, 10799.0}) {
+        shifted.GetForceAtTime(t, force);
+        regular.GetForceAtTime(t + phase / 0.63, expected);
+        failures += Check((force - expected).norm() < 1e-9 * expected.norm(), "component phase", force[2], expected[2]);
+
+        both.GetForceAtTime(t, force);
+        regular.GetForceAtTime(t, expected);
+        second.GetForceAtTime(t, other);
+        expected += other;
+        failures += Check((force - expected).norm() < 1e-9 * expected.norm(), "two components", force[2], expected[2]);
+        failures += Check(std::abs(both.GetElevation(points[1], t) - regular.GetElevation(points[1], t) -
+                                   second.GetElevation(points[1], t)) < 1e-12,
+                          "two components elevation", both.GetElevation(points[1], t), 0.0);
+    }
+    failures += Check(std::abs(both.GetElevationBound() - 1.1) < 1e-12, "elevation bound", both.GetElevationBound(),
+                      1.1);
+
+    bool thrown = false;
+    try {
+        MakePolychromatic({{0.5, 0.6}, {0.5, 4.0}});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    failures += Check(thrown, "component outside the h5 frequencies refused", 0, 1);
+
+    // the kernel, over the phases of a 3 hour run
+    Eigen::ArrayXd x = Eigen::ArrayXd::LinSpaced(200001, -1.0e3, 7.0e4), s(x.size()), c(x.size());
+    SinCos(x, s, c);
+    double sincos_error = 0.0;
+    for (int i = 0; i < x.size(); i++) {
+        sincos_error = std::max({sincos_error, std::abs(s[i] - std::sin(x[i])), std::abs(c[i] - std::cos(x[i]))});
+    }
+    failures += Check(sincos_error < 1e-15, "SinCos", sincos_error, 0.0);
+
+    // 16 components, 3 bodies
+    std::vector<WaveComponent> tones;
+    for (int i = 0; i < 16; i++) {
+        tones.push_back({0.1 + 0.01 * i, 0.3 + 0.15 * i, 0.4 * i});
+    }
+    PolychromaticWave multi = MakePolychromatic(tones);
+    const int num_steps     = 100000;
+    double sum              = 0.0;
+    auto begin              = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < num_steps; step++) {
+        multi.GetForceAtTime(0.01 * step, force);
+        sum += force[2];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    failures += Check(std::isfinite(sum), "excitation finite", sum, 0.0);
+    std::cout << "16 components, " << NUM_BODIES << " bodies: "
+              << std::chrono::duration<double, std::nano>(end - begin).count() / num_steps << " ns per call"
+              << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
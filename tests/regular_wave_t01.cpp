@@ -0,0 +1,79 @@
+#include <hydroc/wave_types.h>
+
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks RegularWave::GetForceAtTime (excitation phasors):
+//   - two bodies with different excitation phases match mag A cos(omega t + phase) of their own dofs,
+//   - still exact late in a 3 hour run,
+//   - a call is timed.
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+
+    // h5 like coefficients on the frequency grid d_omega * (1 ... num_freqs)
+    const int num_bodies = 2;
+    const int num_freqs  = 50;
+    const double d_omega = 0.05;
+    std::vector<HydroData::RegularWaveInfo> infos(num_bodies);
+    for (int b = 0; b < num_bodies; b++) {
+        HydroData::RegularWaveInfo& info = infos[b];
+        info.freq_list                   = Eigen::VectorXd::LinSpaced(num_freqs, d_omega, d_omega * num_freqs);
+        info.excitation_mag_matrix.resize(6, 1, num_freqs);
+        info.excitation_phase_matrix.resize(6, 1, num_freqs);
+        for (int i = 0; i < 6; i++) {
+            for (int k = 0; k < num_freqs; k++) {
+                info.excitation_mag_matrix(i, 0, k)   = 1.0e5 * (b + 1) * (i + 1) / (1.0 + k);
+                info.excitation_phase_matrix(i, 0, k) = 0.3 * i - 1.1 * b + 0.01 * k;
+            }
+        }
+    }
+    HydroData::SimulationParameters sim_data;
+    sim_data.rho         = 1000.0;
+    sim_data.g           = 9.81;
+    sim_data.water_depth = 100.0;
+
+    RegularWave waves(num_bodies);
+    waves.regular_wave_amplitude = 0.7;
+    waves.regular_wave_omega     = 0.6;  // on grid point 11
+    waves.AddH5Data(infos, sim_data);
+    waves.Initialize();
+
+    Eigen::VectorXd force(6 * num_bodies);
+    for (double t : {0.0, 1.3, 77.7, 10799.99}) {
+        waves.GetForceAtTime(t, force);
+        for (int b = 0; b < num_bodies; b++) {
+            for (int i = 0; i < 6; i++) {
+                double mag      = infos[b].excitation_mag_matrix(i, 0, 11);
+                double phase    = infos[b].excitation_phase_matrix(i, 0, 11);
+                double expected = mag * 0.7 * std::cos(0.6 * t + phase);
+                failures += Check(std::abs(force[6 * b + i] - expected) < 1e-9 * mag, "excitation body " +
+                                  std::to_string(b) + " dof " + std::to_string(i), force[6 * b + i], expected);
+            }
+        }
+    }
+
+    const int num_steps = 1000000;
+    double sum          = 0.0;
+    auto begin          = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < num_steps; step++) {
+        waves.GetForceAtTime(0.01 * step, force);
+        sum += force[2];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    failures += Check(std::isfinite(sum), "excitation finite", sum, 0.0);
+    std::cout << "regular wave excitation: "
+              << std::chrono::duration<double, std::nano>(end - begin).count() / num_steps << " ns per call"
+              << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
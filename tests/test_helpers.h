@@ -0,0 +1,13 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// shared by the tests: prints a failed check, returns 1 if it failed (summed into a failure count)
+inline int Check(bool ok, const std::string& what, double value, double expected) {
+    if (!ok) {
+        std::cerr << "FAILED " << what << ": " << value << " expected " << expected << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <hydroc/wave_types.h>
+
+#include <algorithm>
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks NewmanDriftForce:
+//   - the factored sum matches the double sum over frequency pairs with Newman's QTF,
+//   - a regular wave gives the constant force A^2 D,
+//   - the time average over the common period is the mean drift force,
+//   - the components (WaveComponentAmplitudes / WaveComponentPhases) sum to FreeSurfaceElevation's eta,
+//   - on a Pierson-Moskowitz sea only the components carrying drift energy are kept, a step is timed.
+
+// surge / sway / heave / yaw drift of a moored platform like body, negative heave, some sign changes
+Eigen::MatrixXd MakeDrift(const Eigen::VectorXd& omegas, double scale) {
+    Eigen::MatrixXd drift(6, omegas.size());
+    for (int k = 0; k < omegas.size(); k++) {
+        double w = omegas[k];
+        drift.col(k) << scale * w * w / (1.0 + w * w), 0.1 * scale * std::sin(3.0 * w), -0.3 * scale * w, 0.0,
+            0.02 * scale * std::cos(2.0 * w), 0.05 * scale * (w - 0.8);
+    }
+    return drift;
+}
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+
+    // two bodies with their own frequency grids, the second one without drift
+    Eigen::VectorXd grid = Eigen::VectorXd::LinSpaced(40, 0.1, 3.0);
+    std::vector<Eigen::VectorXd> drift_omegas{grid, Eigen::VectorXd(), grid.head(20)};
+    std::vector<Eigen::MatrixXd> drift{MakeDrift(grid, 1.0e4), Eigen::MatrixXd(), MakeDrift(grid.head(20), 3.0e3)};
+
+    // components on a common period 2 pi / d_omega
+    const int count      = 25;
+    const double d_omega = 0.05;
+    Eigen::VectorXd omegas(count), amplitudes(count), phases(count);
+    for (int i = 0; i < count; i++) {
+        omegas[i]     = 0.3 + d_omega * i;
+        amplitudes[i] = 0.2 + 0.5 * std::sin(0.37 * i) * std::sin(0.37 * i);
+        phases[i]     = std::fmod(2.3 * i * i, 2.0 * M_PI);
+    }
+    NewmanDriftForce newman(omegas, amplitudes, phases, drift_omegas, drift, 0.0);
+    failures += Check(newman.GetNumComponents() == count, "all components kept", newman.GetNumComponents(), count);
+
+    // the same coefficients interpolated by hand: zero drift components would also be dropped otherwise
+    Eigen::MatrixXd d = Eigen::MatrixXd::Zero(18, count);
+    for (int b : {0, 2}) {
+        for (int i = 0; i < count; i++) {
+            const Eigen::VectorXd& w = drift_omegas[b];
+            int k                    = 1;
+            while (k < w.size() - 1 && w[k] < omegas[i]) {
+                k++;
+            }
+            double s                = std::clamp((omegas[i] - w[k - 1]) / (w[k] - w[k - 1]), 0.0, 1.0);
+            d.block<6, 1>(6 * b, i) = (1.0 - s) * drift[b].col(k - 1) + s * drift[b].col(k);
+        }
+    }
+
+    Eigen::VectorXd force(18), reference(18), average = Eigen::VectorXd::Zero(18);
+    double scale = (amplitudes.array().square().matrix().transpose() * d.transpose().cwiseAbs()).maxCoeff();
+    for (double t : {0.0, 1.7, 23.4, 101.3}) {
+        force.setZero();
+        newman.AddForceAtTime(t, force);
+        reference.setZero();
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < count; j++) {
+                double c = std::cos((omegas[i] - omegas[j]) * t + phases[i] - phases[j]);
+                for (int r = 0; r < 18; r++) {
+                    double qtf = (d(r, i) < 0.0 ? -1.0 : 1.0) * std::sqrt(std::abs(d(r, i) * d(r, j)));
+                    reference[r] += amplitudes[i] * amplitudes[j] * qtf * c;
+                }
+            }
+        }
+        failures += Check((force - reference).norm() < 1e-10 * scale, "factored vs double sum",
+                          (force - reference).norm(), 0.0);
+    }
+    failures += Check(force.segment<6>(6).isZero(0.0), "no drift on body without coefficients", force.norm(), 0.0);
+
+    // time average over the common period: the mean drift force
+    const int samples = 4000;
+    for (int s = 0; s < samples; s++) {
+        newman.AddForceAtTime(s * 2.0 * M_PI / d_omega / samples, average);
+    }
+    average /= samples;
+    Eigen::VectorXd mean = d * amplitudes.array().square().matrix();
+    failures += Check((average - mean).norm() < 1e-9 * scale, "time average", average[0], mean[0]);
+    failures += Check((newman.GetMeanForce() - mean).norm() < 1e-9 * scale, "mean force", newman.GetMeanForce()[0],
+                      mean[0]);
+
+    // regular wave: constant A^2 D, scaled by the ramp squared
+    NewmanDriftForce regular(Eigen::VectorXd::Constant(1, grid[10]), Eigen::VectorXd::Constant(1, 1.5),
+                             Eigen::VectorXd::Zero(1), drift_omegas, drift);
+    Eigen::VectorXd expected = 2.25 * drift[0].col(10);
+    for (double t : {0.0, 3.0, 7.1}) {
+        force.setZero();
+        regular.AddForceAtTime(t, force, 0.5);
+        failures += Check((force.head<6>() - 0.25 * expected).norm() < 1e-9 * expected.norm(), "regular wave drift",
+                          force[0], 0.25 * expected[0]);
+    }
+
+    // the components reproduce eta
+    Eigen::VectorXd freqs_hz       = Eigen::VectorXd::LinSpaced(1000, 0.001, 1.0);
+    Eigen::VectorXd spectrum       = PiersonMoskowitzSpectrumHz(freqs_hz, 6.0, 12.0);
+    Eigen::VectorXd time_index     = Eigen::VectorXd::LinSpaced(5, 0.0, 40.0);
+    Eigen::VectorXd sea_phases     = WaveComponentPhases(freqs_hz.size());
+    Eigen::VectorXd eta            = FreeSurfaceElevation(freqs_hz, spectrum, time_index, sea_phases);
+    Eigen::VectorXd sea_amplitudes = WaveComponentAmplitudes(freqs_hz, spectrum);
+    Eigen::VectorXd sea_omegas     = 2.0 * M_PI * freqs_hz;
+    for (int k = 0; k < time_index.size(); k++) {
+        double sum = (sea_amplitudes.array() * (sea_omegas.array() * time_index[k] + sea_phases.array()).cos()).sum();
+        failures += Check(std::abs(sum - eta[k]) < 1e-9, "components vs eta", sum, eta[k]);
+    }
+
+    // Pierson-Moskowitz sea, 1000 components: the weakest are dropped, the mean force barely changes
+    NewmanDriftForce sea(sea_omegas, sea_amplitudes, sea_phases, drift_omegas, drift);
+    NewmanDriftForce full_sea(sea_omegas, sea_amplitudes, sea_phases, drift_omegas, drift, 0.0);
+    std::cout << "Pierson-Moskowitz sea: " << sea.GetNumComponents() << " of " << full_sea.GetNumComponents()
+              << " components kept" << std::endl;
+    failures += Check(sea.GetNumComponents() < full_sea.GetNumComponents(), "components dropped",
+                      sea.GetNumComponents(), full_sea.GetNumComponents());
+    // dropped: at most 1e-4 of sum_i a_i^2 |D_i| per dof
+    std::vector<Eigen::MatrixXd> abs_drift{drift[0].cwiseAbs(), drift[1], drift[2].cwiseAbs()};
+    NewmanDriftForce abs_sea(sea_omegas, sea_amplitudes, sea_phases, drift_omegas, abs_drift, 0.0);
+    Eigen::VectorXd mean_error = (sea.GetMeanForce() - full_sea.GetMeanForce()).cwiseAbs();
+    failures += Check((mean_error.array() <= 1e-4 * abs_sea.GetMeanForce().array()).all(),
+                      "mean force of the kept components", mean_error.maxCoeff(), 0.0);
+    const int num_steps = 10000;
+    auto begin          = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < num_steps; step++) {
+        force.setZero();
+        sea.AddForceAtTime(0.01 * step, force);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    failures += Check(force.allFinite(), "sea drift finite", force.norm(), 0.0);
+    std::cout << "drift force step: " << std::chrono::duration<double, std::micro>(end - begin).count() / num_steps
+              << " us" << std::endl;
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}
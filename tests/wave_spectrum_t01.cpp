@@ -0,0 +1,174 @@
+#include <hydroc/wave_spectrum.h>
+#include <hydroc/wave_types.h>
+
+#include <chrono>  // std::chrono::high_resolution_clock::now
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_helpers.h"
+
+// Checks the wave spectra:
+//   - Pierson-Moskowitz matches the closed form, PiersonMoskowitzSpectrumHz keeps its input (no sort),
+//   - every spectrum has m0 = Hs^2 / 16 (Ochi-Hubble: sum of its peaks), Bretschneider has sqrt(m0 / m2) = Tz,
+//     JONSWAP with gamma = 1 and a single Ochi-Hubble peak with lambda = 1 are Pierson-Moskowitz, JONSWAP peaks
+//     at fp,
+//   - tabulated spectra interpolate linearly and are 0 outside, invalid parameters are refused,
+//   - IrregularWave uses the spectrum and frequency range it is given,
+//   - evaluation is timed.
+
+// spectral moment m_n by the trapezoidal rule (S(0) = 0)
+double Moment(const Eigen::VectorXd& f, const Eigen::VectorXd& s, int n) {
+    double df                = f[1] - f[0];
+    Eigen::VectorXd weighted = s.cwiseProduct(f.array().pow(n).matrix());
+    return df * (weighted.sum() - 0.5 * weighted[f.size() - 1]);
+}
+
+template <typename Spectrum>
+bool Refused(const std::function<Spectrum()>& make) {
+    try {
+        make();
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+
+    const double hs    = 2.5;
+    const double tp    = 9.0;
+    Eigen::VectorXd f  = Eigen::VectorXd::LinSpaced(200000, 1e-4, 20.0);  // fine grid for the moments
+    Eigen::VectorXd pm = PiersonMoskowitzSpectrum(hs, tp).Evaluate(f);
+    double pm_error    = 0.0;
+    for (int i = 0; i < f.size(); i += 97) {
+        double expected = 1.25 * std::pow(1 / tp, 4) * std::pow(hs / 2, 2) * std::pow(f[i], -5) *
+                          std::exp(-1.25 * std::pow(1 / tp, 4) * std::pow(f[i], -4));
+        pm_error = std::max(pm_error, std::abs(pm[i] - expected));
+    }
+    failures += Check(pm_error < 1e-13 * pm.maxCoeff(), "Pierson-Moskowitz closed form", pm_error, 0.0);
+    failures += Check(std::abs(Moment(f, pm, 0) - hs * hs / 16.0) < 1e-6 * hs * hs, "Pierson-Moskowitz m0",
+                      Moment(f, pm, 0), hs * hs / 16.0);
+
+    Eigen::VectorXd unsorted(4);
+    unsorted << 0.3, 0.1, -0.2, 0.2;
+    Eigen::VectorXd unsorted_copy = unsorted;
+    Eigen::VectorXd densities     = PiersonMoskowitzSpectrumHz(unsorted, hs, tp);
+    failures += Check(unsorted == unsorted_copy, "input not sorted", unsorted[0], unsorted_copy[0]);
+    Eigen::VectorXd at_0_3 = PiersonMoskowitzSpectrum(hs, tp).Evaluate(Eigen::VectorXd::Constant(1, 0.3));
+    failures += Check(densities[2] == 0.0 && densities[0] == at_0_3[0], "densities in the input order, 0 at f <= 0",
+                      densities[0], at_0_3[0]);
+
+    // Bretschneider
+    const double tz      = 6.5;
+    Eigen::VectorXd bret = BretschneiderSpectrum(hs, tz).Evaluate(f);
+    double bret_tz       = std::sqrt(Moment(f, bret, 0) / Moment(f, bret, 2));
+    failures += Check(std::abs(bret_tz - tz) < 1e-3 * tz, "Bretschneider zero crossing period", bret_tz, tz);
+
+    // JONSWAP
+    for (double gamma : {1.0, 3.3, 7.0}) {
+        Eigen::VectorXd js = JonswapSpectrum(hs, tp, gamma).Evaluate(f);
+        failures += Check(std::abs(Moment(f, js, 0) - hs * hs / 16.0) < 1e-6 * hs * hs,
+                          "JONSWAP m0, gamma " + std::to_string(gamma), Moment(f, js, 0), hs * hs / 16.0);
+        Eigen::Index peak;
+        js.maxCoeff(&peak);
+        failures += Check(std::abs(f[peak] - 1.0 / tp) < 2e-3 / tp, "JONSWAP peak, gamma " + std::to_string(gamma),
+                          f[peak], 1.0 / tp);
+        if (gamma == 1.0) {
+            failures += Check((js - pm).norm() < 1e-6 * pm.norm(), "JONSWAP gamma 1", js.maxCoeff(), pm.maxCoeff());
+        }
+    }
+
+    // Ochi-Hubble
+    Eigen::VectorXd single = OchiHubbleSpectrum({{hs, tp, 1.0}}).Evaluate(f);
+    failures += Check((single - pm).norm() < 1e-12 * pm.norm(), "Ochi-Hubble lambda 1", single.maxCoeff(),
+                      pm.maxCoeff());
+    Eigen::VectorXd bimodal = OchiHubbleSpectrum({{1.5, 14.0, 3.0}, {2.0, 6.0, 1.5}}).Evaluate(f);
+    failures += Check(std::abs(Moment(f, bimodal, 0) - (1.5 * 1.5 + 2.0 * 2.0) / 16.0) < 1e-6,
+                      "Ochi-Hubble bimodal m0", Moment(f, bimodal, 0), (1.5 * 1.5 + 2.0 * 2.0) / 16.0);
+
+    // tabulated
+    Eigen::VectorXd table_f(3), table_s(3), query(6);
+    table_f << 0.05, 0.1, 0.3;
+    table_s << 0.0, 2.0, 1.0;
+    query << 0.01, 0.05, 0.075, 0.2, 0.3, 0.5;
+    Eigen::VectorXd tabulated = TabulatedSpectrum(table_f, table_s).Evaluate(query);
+    Eigen::VectorXd expected(6);
+    expected << 0.0, 0.0, 1.0, 1.5, 1.0, 0.0;
+    failures += Check((tabulated - expected).norm() < 1e-14, "tabulated", tabulated[3], expected[3]);
+
+    failures += Check(Refused<JonswapSpectrum>([] { return JonswapSpectrum(2.0, 8.0, 0.5); }), "gamma < 1 refused",
+                      0, 1);
+    failures += Check(Refused<PiersonMoskowitzSpectrum>([] { return PiersonMoskowitzSpectrum(2.0, 0.0); }),
+                      "zero period refused", 0, 1);
+    Eigen::VectorXd decreasing = query.reverse();
+    failures += Check(Refused<TabulatedSpectrum>([&] { return TabulatedSpectrum(decreasing, query); }),
+                      "decreasing table refused", 0, 1);
+    failures += Check(Refused<OchiHubbleSpectrum>([] { return OchiHubbleSpectrum({}); }), "no peaks refused", 0, 1);
+
+    // IrregularWave with a JONSWAP sea over 0.02 ... 0.5 Hz
+    std::vector<HydroData::IrregularWaveInfo> infos(1);
+    infos[0].excitation_irf_time   = Eigen::VectorXd::LinSpaced(41, -2.0, 2.0);
+    infos[0].excitation_irf_matrix = Eigen::MatrixXd::Ones(6, 41);
+    HydroData::SimulationParameters sim_data;
+    sim_data.rho         = 1000.0;
+    sim_data.g           = 9.81;
+    sim_data.water_depth = 50.0;
+    IrregularWave waves;
+    waves.spectrum                 = std::make_shared<JonswapSpectrum>(hs, tp, 3.3);
+    waves.spectrum_min_frequency   = 0.02;
+    waves.spectrum_max_frequency   = 0.5;
+    waves.spectrum_num_frequencies = 241;
+    waves.simulation_duration      = 10.0;
+    waves.simulation_dt            = 0.1;
+    waves.ramp_duration            = 0.0;
+    waves.AddH5Data(infos, sim_data);
+    waves.Initialize();
+    Eigen::VectorXd omegas, amplitudes, phases;
+    waves.GetWaveComponents(omegas, amplitudes, phases);
+    Eigen::VectorXd grid = Eigen::VectorXd::LinSpaced(241, 0.02, 0.5);
+    Eigen::VectorXd component_amplitudes =
+        (2.0 * 0.002 * JonswapSpectrum(hs, tp, 3.3).Evaluate(grid).array()).sqrt().matrix();
+    failures += Check(omegas.size() == 241 && (omegas - 2.0 * M_PI * grid).norm() < 1e-12, "IrregularWave frequencies",
+                      omegas.size(), 241);
+    failures += Check((amplitudes - component_amplitudes).norm() < 1e-12 * component_amplitudes.norm(),
+                      "IrregularWave amplitudes", amplitudes.maxCoeff(), component_amplitudes.maxCoeff());
+    // the components carry about m0 = Hs^2 / 16 of the (mostly covered) spectrum
+    double variance = 0.5 * amplitudes.squaredNorm();
+    failures += Check(std::abs(variance - hs * hs / 16.0) < 0.02 * hs * hs / 16.0, "IrregularWave variance",
+                      variance, hs * hs / 16.0);
+
+    // evaluation, 1000 frequencies
+    JonswapSpectrum jonswap(hs, tp, 3.3);
+    PiersonMoskowitzSpectrum pierson_moskowitz(hs, tp);
+    Eigen::VectorXd grid_1000 = Eigen::VectorXd::LinSpaced(1000, 0.001, 1.0);
+    Eigen::VectorXd sum       = Eigen::VectorXd::Zero(grid_1000.size());
+    const int num_runs        = 1000;
+    auto begin          = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < num_runs; run++) {
+        sum += jonswap.Evaluate(grid_1000);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "JONSWAP: " << std::chrono::duration<double, std::nano>(end - begin).count() / (num_runs * 1000.0)
+              << " ns per frequency" << std::endl;
+    begin = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < num_runs; run++) {
+        sum += pierson_moskowitz.Evaluate(grid_1000);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "Pierson-Moskowitz: "
+              << std::chrono::duration<double, std::nano>(end - begin).count() / (num_runs * 1000.0)
+              << " ns per frequency" << std::endl;
+    failures += Check(std::isfinite(sum.sum()), "spectra finite", sum.sum(), 0.0);
+
+    if (failures != 0) {
+        return 1;
+    }
+    std::cout << "End" << std::endl;
+    return 0;
+}